@@ -0,0 +1,98 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+struct ArenaBlock {
+  ArenaBlock *next;
+};
+
+Arena *arena_create(size_t capacity)
+{
+  Arena *arena = malloc(sizeof(Arena));
+  if (arena == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  arena->memory = malloc(capacity);
+  if (arena->memory == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    free(arena);
+    return NULL;
+  }
+  arena->capacity = capacity;
+  arena->overflow = NULL;
+  memset(&arena->stats, 0, sizeof(ArenaStats));
+
+  return arena;
+}
+
+void arena_destroy(Arena *arena)
+{
+  if (arena == NULL) return;
+
+  arena_reset(arena);
+  free(arena->memory);
+  free(arena);
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+  size_t aligned = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+  arena->stats.allocations++;
+
+  if (arena->stats.used + aligned <= arena->capacity) {
+    void *memory = arena->memory + arena->stats.used;
+    arena->stats.used += aligned;
+    if (arena->stats.used > arena->stats.peak) arena->stats.peak = arena->stats.used;
+    return memory;
+  }
+
+  // full, the block lives until the next reset like the rest
+  ArenaBlock *block = malloc(ARENA_ALIGNMENT + size);
+  if (block == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  block->next = arena->overflow;
+  arena->overflow = block;
+  arena->stats.overflows++;
+  return (unsigned char *) block + ARENA_ALIGNMENT;
+}
+
+char *arena_strdup(Arena *arena, const char *text)
+{
+  size_t length = strlen(text) + 1;
+  char *copy = arena_alloc(arena, length);
+  if (copy != NULL) memcpy(copy, text, length);
+  return copy;
+}
+
+char *arena_printf(Arena *arena, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(NULL, 0, format, args);
+  va_end(args);
+  if (length < 0) return NULL;
+
+  char *text = arena_alloc(arena, length + 1);
+  if (text == NULL) return NULL;
+  va_start(args, format);
+  vsnprintf(text, length + 1, format, args);
+  va_end(args);
+  return text;
+}
+
+void arena_reset(Arena *arena)
+{
+  while (arena->overflow != NULL) {
+    ArenaBlock *next = arena->overflow->next;
+    free(arena->overflow);
+    arena->overflow = next;
+  }
+  arena->stats.used = 0;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+# ifndef ARENA_H
+# define ARENA_H
+
+#include <stddef.h>
+
+// every allocation is aligned for any type
+#define ARENA_ALIGNMENT 16
+
+typedef struct {
+  // allocations since the arena was created
+  int allocations;
+  // allocations the arena had no room for, served by malloc
+  int overflows;
+  // bytes used since the last reset, and the most ever used
+  size_t used, peak;
+} ArenaStats;
+
+typedef struct ArenaBlock ArenaBlock;
+
+/**
+ * Bump allocator, everything allocated is freed at once by arena_reset
+ */
+typedef struct {
+  unsigned char *memory;
+  size_t capacity;
+  // overflow blocks from malloc, freed on reset
+  ArenaBlock *overflow;
+  ArenaStats stats;
+} Arena;
+
+/**
+ * @brief Create an Arena object
+ * @param capacity Size of the arena in bytes
+ * @return Arena*, NULL on error
+ */
+Arena *arena_create(size_t capacity);
+
+/**
+ * @brief Destroy the Arena object
+ * @param arena Arena
+ */
+void arena_destroy(Arena *arena);
+
+/**
+ * @brief Allocate memory valid until the next reset
+ *
+ * When the arena is full the memory comes from malloc and is counted in
+ * stats.overflows, so a steady state without heap allocation shows as an
+ * overflow count that stops moving.
+ *
+ * @param arena Arena
+ * @param size Size in bytes
+ * @return Memory, NULL on error
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * @brief Copy a string into the arena
+ * @param arena Arena
+ * @param text Text
+ * @return Copy, NULL on error
+ */
+char *arena_strdup(Arena *arena, const char *text);
+
+/**
+ * @brief Format a string into the arena, as sprintf
+ * @param arena Arena
+ * @param format Format
+ * @return Text, NULL on error
+ */
+char *arena_printf(Arena *arena, const char *format, ...);
+
+/**
+ * @brief Free everything allocated since the last reset
+ * @param arena Arena
+ */
+void arena_reset(Arena *arena);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_loader.h"
+#include "bundle.h"
+
+// one worker per CPU unless set otherwise
+static int asset_loader_threads = -1;
+// timings of the last loader finished
+static AssetLoaderStats asset_loader_last;
+
+void asset_loader_set_threads(int threads)
+{
+  asset_loader_threads = threads;
+}
+
+AssetLoaderStats asset_loader_last_stats(void)
+{
+  return asset_loader_last;
+}
+
+static int asset_loader_worker(void *data)
+{
+  AssetLoader *loader = data;
+
+  // every worker takes the next image until there is none left
+  int index;
+  while ((index = SDL_AtomicAdd(&loader->next, 1)) < loader->count) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    loader->surfaces[index] = bundle_load_image(loader->paths[index]);
+    loader->decode_ticks[index] = SDL_GetPerformanceCounter() - start;
+    if (loader->surfaces[index] == NULL) {
+      fprintf(stderr, "[asset_loader_worker] Erreur lors du chargement de l'image %s : %s\n", loader->paths[index], IMG_GetError());
+    }
+  }
+
+  return 0;
+}
+
+AssetLoader *asset_loader_start(const char **paths, int count)
+{
+  if (count > SPRITE_ATLAS_CAPACITY) {
+    fprintf(stderr, "[asset_loader_start] Trop d'images : %d\n", count);
+    return NULL;
+  }
+
+  AssetLoader *loader = malloc(sizeof(AssetLoader));
+  if (loader == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(loader, 0, sizeof(AssetLoader));
+  loader->count = count;
+  loader->start = SDL_GetPerformanceCounter();
+
+  for (int i = 0; i < count; i++) {
+    if (strlen(paths[i]) >= SPRITE_ATLAS_PATH_MAX) {
+      fprintf(stderr, "[asset_loader_start] Chemin trop long : %s\n", paths[i]);
+      free(loader);
+      return NULL;
+    }
+    strcpy(loader->paths[i], paths[i]);
+  }
+
+  int threads = asset_loader_threads;
+  if (threads < 0) threads = SDL_GetCPUCount();
+  if (threads > ASSET_LOADER_MAX_THREADS) threads = ASSET_LOADER_MAX_THREADS;
+  if (threads > count) threads = count;
+
+  for (int i = 0; i < threads; i++) {
+    SDL_Thread *thread = SDL_CreateThread(asset_loader_worker, "asset_loader", loader);
+    if (thread == NULL) {
+      // the images left are decoded by the threads already running, or on finish
+      fprintf(stderr, "[asset_loader_start] Erreur lors de la création du thread : %s\n", SDL_GetError());
+      break;
+    }
+    loader->threads[loader->thread_count++] = thread;
+  }
+
+  return loader;
+}
+
+bool asset_loader_finish(AssetLoader *loader)
+{
+  if (!loader->is_finished) {
+    // without workers, or if some failed to start, the caller lends a hand
+    asset_loader_worker(loader);
+    for (int i = 0; i < loader->thread_count; i++) SDL_WaitThread(loader->threads[i], NULL);
+    loader->is_finished = true;
+    loader->ready_time = (double) (SDL_GetPerformanceCounter() - loader->start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    Uint64 ticks = 0;
+    for (int i = 0; i < loader->count; i++) ticks += loader->decode_ticks[i];
+    loader->decode_time = (double) ticks * 1000.0 / SDL_GetPerformanceFrequency();
+
+    asset_loader_last.count = loader->count;
+    asset_loader_last.thread_count = loader->thread_count;
+    asset_loader_last.decode_time = loader->decode_time;
+    asset_loader_last.ready_time = loader->ready_time;
+  }
+
+  for (int i = 0; i < loader->count; i++) {
+    if (loader->surfaces[i] == NULL) return false;
+  }
+  return true;
+}
+
+SDL_Surface *asset_loader_take(AssetLoader *loader, int index)
+{
+  SDL_Surface *surface = loader->surfaces[index];
+  loader->surfaces[index] = NULL;
+  return surface;
+}
+
+void asset_loader_destroy(AssetLoader *loader)
+{
+  if (loader == NULL) return;
+
+  asset_loader_finish(loader);
+  for (int i = 0; i < loader->count; i++) SDL_FreeSurface(loader->surfaces[i]);
+  free(loader);
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+# ifndef ASSET_LOADER_H
+# define ASSET_LOADER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "sprite_atlas.h"
+
+#define ASSET_LOADER_MAX_THREADS 8
+
+/**
+ * Images decoded into surfaces by worker threads. Decoding needs neither
+ * the renderer nor the main thread, only the texture upload does.
+ */
+typedef struct {
+  char paths[SPRITE_ATLAS_CAPACITY][SPRITE_ATLAS_PATH_MAX];
+  SDL_Surface *surfaces[SPRITE_ATLAS_CAPACITY];
+  int count;
+  // next image to decode, shared by the workers
+  SDL_atomic_t next;
+  SDL_Thread *threads[ASSET_LOADER_MAX_THREADS];
+  int thread_count;
+  // time spent decoding each image, written by the worker that decoded it
+  Uint64 decode_ticks[SPRITE_ATLAS_CAPACITY];
+  // time spent decoding every image, summed over the threads, in ms
+  double decode_time;
+  // from start to the last image decoded, in ms
+  double ready_time;
+  Uint64 start;
+  bool is_finished;
+} AssetLoader;
+
+/**
+ * Timings of a loader, kept once it is destroyed for --bench-startup
+ */
+typedef struct {
+  int count, thread_count;
+  double decode_time, ready_time;
+} AssetLoaderStats;
+
+/**
+ * @brief Choose the number of worker threads of the loaders to come
+ * @param threads Number of threads, 0 to decode on the calling thread,
+ * a negative value for one per CPU
+ */
+void asset_loader_set_threads(int threads);
+
+/**
+ * @brief Get the timings of the last loader finished
+ * @return AssetLoaderStats, zero before any loader finished
+ */
+AssetLoaderStats asset_loader_last_stats(void);
+
+/**
+ * @brief Start decoding images in the background
+ * @param paths Image paths
+ * @param count Number of images, at most SPRITE_ATLAS_CAPACITY
+ * @return AssetLoader*, NULL on error
+ */
+AssetLoader *asset_loader_start(const char **paths, int count);
+
+/**
+ * @brief Wait until every image is decoded
+ * @param loader AssetLoader
+ * @return true if every image was decoded
+ */
+bool asset_loader_finish(AssetLoader *loader);
+
+/**
+ * @brief Take a decoded image, the caller frees it
+ * @param loader AssetLoader, finished
+ * @param index Index of the image in the paths given to start
+ * @return SDL_Surface*, NULL if it was already taken
+ */
+SDL_Surface *asset_loader_take(AssetLoader *loader, int index);
+
+/**
+ * @brief Destroy the AssetLoader object, waiting for the workers and
+ * freeing the images nobody took
+ * @param loader AssetLoader
+ */
+void asset_loader_destroy(AssetLoader *loader);
+
+# endif
\ No newline at end of file
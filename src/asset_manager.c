@@ -0,0 +1,177 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_manager.h"
+#include "bundle.h"
+#include "counters.h"
+#include "sprite_atlas.h"
+
+AssetManager *asset_manager_create(SDL_Renderer *renderer)
+{
+  AssetManager *manager = malloc(sizeof(AssetManager));
+  if (manager == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  memset(manager, 0, sizeof(AssetManager));
+  manager->renderer = renderer;
+
+  return manager;
+}
+
+void asset_manager_destroy(AssetManager *manager)
+{
+  if (manager == NULL) return;
+
+  for (int i = 0; i < ASSET_MANAGER_CAPACITY; i++) {
+    Asset *asset = &manager->assets[i];
+    if (!asset->is_used || !asset->owns_texture) continue;
+    if (asset->sprite.texture != NULL) {
+      SDL_DestroyTexture(asset->sprite.texture);
+      COUNTER_INC(COUNTER_TEXTURES_DESTROYED);
+    }
+    SDL_FreeSurface(asset->sprite.surface);
+  }
+  sprite_atlas_destroy(manager->atlas);
+  free(manager);
+}
+
+static Asset *asset_manager_find(AssetManager *manager, const char *path)
+{
+  for (int i = 0; i < ASSET_MANAGER_CAPACITY; i++) {
+    Asset *asset = &manager->assets[i];
+    if (asset->is_used && strcmp(asset->path, path) == 0) return asset;
+  }
+  return NULL;
+}
+
+static Asset *asset_manager_add(AssetManager *manager, const char *path, Sprite sprite, bool owns_texture)
+{
+  for (int i = 0; i < ASSET_MANAGER_CAPACITY; i++) {
+    Asset *asset = &manager->assets[i];
+    if (asset->is_used) continue;
+
+    asset->sprite = sprite;
+    asset->manager = manager;
+    strcpy(asset->path, path);
+    asset->references = 0;
+    asset->owns_texture = owns_texture;
+    asset->is_used = true;
+    return asset;
+  }
+
+  fprintf(stderr, "[asset_manager_add] Trop d'images chargées\n");
+  return NULL;
+}
+
+bool asset_manager_pack(AssetManager *manager, AssetLoader *loader)
+{
+  if (manager->atlas != NULL) {
+    fprintf(stderr, "[asset_manager_pack] Atlas déjà chargé\n");
+    return false;
+  }
+  if (!asset_loader_finish(loader)) return false;
+
+  // decoded on the workers, the upload happens here on the render thread
+  int count = loader->count;
+  const char *paths[SPRITE_ATLAS_CAPACITY];
+  SDL_Surface *surfaces[SPRITE_ATLAS_CAPACITY];
+  for (int i = 0; i < count; i++) {
+    paths[i] = loader->paths[i];
+    surfaces[i] = asset_loader_take(loader, i);
+  }
+
+  manager->atlas = sprite_atlas_create(manager->renderer, paths, surfaces, count);
+  if (manager->atlas == NULL) return false;
+
+  manager->stats.decodes += count;
+  manager->stats.texture_bytes += (size_t) manager->atlas->width * manager->atlas->height * 4;
+
+  // atlas regions stay registered, even with no reference left
+  for (int i = 0; i < count; i++) {
+    Sprite sprite = { manager->atlas->texture, manager->atlas->surface, manager->atlas->rects[i] };
+    if (asset_manager_add(manager, paths[i], sprite, false) == NULL) return false;
+  }
+
+  return true;
+}
+
+Sprite *asset_manager_acquire(AssetManager *manager, const char *path)
+{
+  if (manager == NULL || path == NULL) return NULL;
+
+  Asset *asset = asset_manager_find(manager, path);
+  if (asset != NULL) {
+    manager->stats.hits++;
+    asset->references++;
+    return &asset->sprite;
+  }
+
+  if (strlen(path) >= ASSET_MANAGER_PATH_MAX) {
+    fprintf(stderr, "[asset_manager_acquire] Chemin trop long : %s\n", path);
+    return NULL;
+  }
+
+  // not packed in the atlas, decode it into its own texture
+  SDL_Surface *surface = bundle_load_image(path);
+  if (surface == NULL) {
+    fprintf(stderr, "[asset_manager_acquire] Erreur lors du chargement de l'image : %s\n", IMG_GetError());
+    return NULL;
+  }
+  manager->stats.decodes++;
+
+  Sprite sprite = { NULL, NULL, { 0, 0, surface->w, surface->h } };
+  if (manager->renderer == NULL) {
+    // software rendering, keep the pixels in the layout the rasterizer reads
+    sprite.surface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+    if (sprite.surface == NULL) {
+      fprintf(stderr, "[asset_manager_acquire] Erreur lors de la conversion de l'image : %s\n", SDL_GetError());
+      return NULL;
+    }
+  } else {
+    sprite.texture = SDL_CreateTextureFromSurface(manager->renderer, surface);
+    COUNTER_INC(COUNTER_TEXTURES_CREATED);
+    SDL_FreeSurface(surface);
+    if (sprite.texture == NULL) {
+      fprintf(stderr, "[asset_manager_acquire] Erreur lors de la création de la texture : %s\n", SDL_GetError());
+      return NULL;
+    }
+  }
+
+  asset = asset_manager_add(manager, path, sprite, true);
+  if (asset == NULL) {
+    if (sprite.texture != NULL) {
+      SDL_DestroyTexture(sprite.texture);
+      COUNTER_INC(COUNTER_TEXTURES_DESTROYED);
+    }
+    SDL_FreeSurface(sprite.surface);
+    return NULL;
+  }
+  manager->stats.texture_bytes += (size_t) sprite.rect.w * sprite.rect.h * 4;
+  asset->references++;
+
+  return &asset->sprite;
+}
+
+void asset_manager_release(Sprite *sprite)
+{
+  if (sprite == NULL) return;
+
+  Asset *asset = (Asset *) sprite;
+  if (asset->references > 0) asset->references--;
+  if (asset->references > 0 || !asset->owns_texture) return;
+
+  // last reference to a texture of its own, free the GPU memory
+  AssetManager *manager = asset->manager;
+  manager->stats.texture_bytes -= (size_t) asset->sprite.rect.w * asset->sprite.rect.h * 4;
+  if (asset->sprite.texture != NULL) {
+    SDL_DestroyTexture(asset->sprite.texture);
+    COUNTER_INC(COUNTER_TEXTURES_DESTROYED);
+  }
+  SDL_FreeSurface(asset->sprite.surface);
+  asset->is_used = false;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+# ifndef ASSET_MANAGER_H
+# define ASSET_MANAGER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "asset_loader.h"
+#include "sprite_atlas.h"
+
+#define ASSET_MANAGER_CAPACITY 32
+#define ASSET_MANAGER_PATH_MAX SPRITE_ATLAS_PATH_MAX
+
+typedef struct AssetManager AssetManager;
+
+typedef struct {
+  // first member, the handle handed out is a pointer to it
+  Sprite sprite;
+  AssetManager *manager;
+  char path[ASSET_MANAGER_PATH_MAX];
+  int references;
+  bool owns_texture;
+  bool is_used;
+} Asset;
+
+typedef struct {
+  int decodes;
+  int hits;
+  size_t texture_bytes;
+} AssetStats;
+
+struct AssetManager {
+  SDL_Renderer *renderer;
+  SpriteAtlas *atlas;
+  Asset assets[ASSET_MANAGER_CAPACITY];
+  AssetStats stats;
+};
+
+/**
+ * @brief Create an AssetManager object
+ * @param renderer SDL_Renderer textures are uploaded to, NULL to keep
+ * RGBA32 surfaces for software rendering
+ * @return AssetManager*
+ */
+AssetManager *asset_manager_create(SDL_Renderer *renderer);
+
+/**
+ * @brief Destroy the AssetManager object and every texture it owns
+ * @param manager AssetManager
+ */
+void asset_manager_destroy(AssetManager *manager);
+
+/**
+ * @brief Pack the images of a loader into the sprite atlas, waiting for
+ * the ones still decoding
+ * @param manager AssetManager
+ * @param loader AssetLoader, its images are taken
+ * @return true on success
+ */
+bool asset_manager_pack(AssetManager *manager, AssetLoader *loader);
+
+/**
+ * @brief Get a shared sprite for an image, adding a reference to it
+ *
+ * Images packed in the atlas are never decoded again, other images are
+ * decoded on first use and kept as long as they are referenced.
+ *
+ * @param manager AssetManager
+ * @param path Image path
+ * @return Sprite*, NULL on error
+ */
+Sprite *asset_manager_acquire(AssetManager *manager, const char *path);
+
+/**
+ * @brief Drop a reference to a sprite given by asset_manager_acquire
+ * @param sprite Sprite, may be NULL
+ */
+void asset_manager_release(Sprite *sprite);
+
+# endif
\ No newline at end of file
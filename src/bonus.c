@@ -4,88 +4,91 @@
 #include "map.h"
 #include "window.h"
 #include "player.h"
+#include "simulation.h"
 
-Bonus *bonus_create(Window *window, Map *map)
+void bonus_init(Bonus *bonus, Sprite *sprite, Map *map)
 {
-  Bonus *bonus = malloc(sizeof(Bonus));
-  if (bonus == NULL) return NULL;
-
-  // Load texture
-  window_load_texture(window, BONUS_TEXTURE_FILE, &bonus->texture);
+  // the sprite is shared, nothing is loaded here
+  bonus->sprite = sprite;
 
   bonus->is_activate = false;
   bonus->frame_count = 0;
-  bonus->start_time = SDL_GetTicks() / 1000.0f;
+  bonus->start_time = simulation_time();
   bonus->animation_start_time = 0;
   bonus->render_start_time = 0;
 
   // Generate x and y position
   bonus_generate_position(map, bonus);
-  if (&bonus->x == NULL || &bonus->y == NULL) return NULL;
 
   // Generate sprite
   bonus_generate_texture(bonus);
-  if (&bonus->src == NULL) return NULL;
 
   // Generate interval
   bonus_generate_interval(bonus);
-  if (&bonus->interval == NULL) return NULL;
+}
 
+Bonus *bonus_spawn(Pool *pool, Sprite *sprite, Map *map)
+{
+  Bonus *bonus = pool_acquire(pool);
+  if (bonus == NULL) return NULL;
+
+  bonus_init(bonus, sprite, map);
   return bonus;
 }
 
-void bonus_destroy(Bonus *bonus)
+void bonus_despawn(Pool *pool, Bonus *bonus)
 {
-  if (bonus == NULL) return;
-
-  SDL_DestroyTexture(bonus->texture);
-  free(bonus); 
+  pool_release(pool, bonus);
 }
 
-void bonus_render(Bonus *bonus, Window *window, Map *map)
+void bonus_render(Bonus *bonus, Window *window)
 {
   if (!bonus->is_activate) return;
 
+  // frame_count only moves while blinking, hidden for most of each blink
+  if (bonus->frame_count >= BONUS_FRAME_CAP) return;
+
   SDL_Rect dest = {bonus->x, bonus->y, BONUS_SPRITE_SIZE, BONUS_SPRITE_SIZE};
-  float current_time = SDL_GetTicks() / 1000.0f;
+  window_set_layer(window, RENDER_LAYER_ITEMS);
+  window_draw_sprite(window, bonus->sprite, &bonus->src, &dest, 0.0, SDL_FLIP_NONE);
+}
+
+void bonus_update(Bonus *bonus, Map *map, Player *player)
+{
+  float current_time = simulation_time();
 
+  if (!bonus->is_activate) {
+    if (current_time - bonus->start_time >= bonus->interval) {
+      bonus_activate(bonus);
+      bonus->start_time = current_time;
+    }
+    return;
+  }
+
+  // gone once its time is over, until the next interval
   if (current_time - bonus->render_start_time >= BONUS_RENDER_TIME) {
     bonus_deactivate(bonus);
     bonus_reset(bonus, map);
     return;
   }
 
-  if (current_time - bonus->render_start_time >= BONUS_BLINK_TIME) {
-    if (current_time - bonus->animation_start_time >= BONUS_ANIMATION_CAP) {
-      bonus->frame_count++;
-      bonus->animation_start_time = current_time;
-    }
-    if (bonus->frame_count < BONUS_FRAME_CAP) {
-      window_draw_texture(window, bonus->texture, &bonus->src, &dest);
-    }
+  // blink during the last seconds
+  if (
+    current_time - bonus->render_start_time >= BONUS_BLINK_TIME
+    && current_time - bonus->animation_start_time >= BONUS_ANIMATION_CAP
+  ) {
+    bonus->frame_count++;
+    bonus->animation_start_time = current_time;
     if (bonus->frame_count >= BONUS_FRAME_MAX) {
       bonus->frame_count = 0;
     }
-  } else {
-    window_draw_texture(window, bonus->texture, &bonus->src, &dest);
-  }
-}
-
-void bonus_update(Bonus *bonus, Map *map, Player *player)
-{
-  if (bonus->is_activate) return;
-
-  float current_time = SDL_GetTicks() / 1000.0f;
-  if (current_time - bonus->start_time >= bonus->interval) {
-    bonus_activate(bonus);
-    bonus->start_time = current_time;
   }
 }
 
 void bonus_activate(Bonus *bonus)
 {
   bonus->is_activate = true;
-  bonus->render_start_time = SDL_GetTicks() / 1000.0f;
+  bonus->render_start_time = simulation_time();
 }
 
 void bonus_deactivate(Bonus *bonus)
@@ -123,7 +126,7 @@ void bonus_generate_position(Map *map, Bonus *bonus)
 void bonus_generate_texture(Bonus *bonus)
 {
   // Generate random sprite
-  int x_offset = rand() % BONUS_SPRITES_NUMBER;
+  int x_offset = simulation_random() % BONUS_SPRITES_NUMBER;
   // Set sprite
   bonus->src = (SDL_Rect) {
     x_offset * BONUS_SPRITE_SIZE,
@@ -135,19 +138,23 @@ void bonus_generate_texture(Bonus *bonus)
 
 void bonus_generate_interval(Bonus *bonus)
 {
-  bonus->interval = rand() % BONUS_MAX_INTERVAL + BONUS_MIN_INTERVAL;
+  bonus->interval = simulation_random() % BONUS_MAX_INTERVAL + BONUS_MIN_INTERVAL;
 }
 
 bool bonus_check_collision(Bonus *bonus, Player *player)
 {
-  return player->x == bonus->x && player->y == bonus->y && bonus->is_activate;
+  // the player may cross the tile center between two ticks, compare tiles
+  int x = (player->x + PLAYER_SIZE/2) / BONUS_SPRITE_SIZE;
+  int y = (player->y + PLAYER_SIZE/2) / BONUS_SPRITE_SIZE;
+
+  return x == bonus->x / BONUS_SPRITE_SIZE && y == bonus->y / BONUS_SPRITE_SIZE && bonus->is_activate;
 }
 
 void bonus_reset(Bonus *bonus, Map *map)
 {
   bonus->is_activate = false;
   bonus->frame_count = 0;
-  bonus->start_time = SDL_GetTicks() / 1000.0f;
+  bonus->start_time = simulation_time();
   bonus->animation_start_time = 0;
   bonus->render_start_time = 0;
 
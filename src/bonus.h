@@ -6,6 +6,7 @@
 #include <stdbool.h>
 
 #include "map.h"
+#include "pool.h"
 #include "window.h"
 #include "player.h"
 
@@ -27,11 +28,14 @@
 #define BONUS_MAX_INTERVAL 30
 #define BONUS_MIN_INTERVAL 20
 
+// bonuses on the map at the same time, at most
+#define BONUS_POOL_CAPACITY 8
+
 typedef struct {
   int x, y;
   float start_time;
   float interval;
-  SDL_Texture *texture;
+  Sprite *sprite;
   float animation_start_time;
   float render_start_time;
   int frame_count;
@@ -39,11 +43,31 @@ typedef struct {
   SDL_Rect src;
 } Bonus;
 
-Bonus *bonus_create(Window *window, Map *map);
-
-void bonus_destroy(Bonus *bonus);
-
-void bonus_render(Bonus *bonus, Window *window, Map *map);
+/**
+ * @brief Set up a bonus in place, waiting for its first interval
+ * @param bonus Bonus
+ * @param sprite Sprite of the bonuses, owned by the caller
+ * @param map Map
+ */
+void bonus_init(Bonus *bonus, Sprite *sprite, Map *map);
+
+/**
+ * @brief Take a bonus from a pool and set it up, no allocation nor loading
+ * @param pool Pool of Bonus
+ * @param sprite Sprite of the bonuses, owned by the caller
+ * @param map Map
+ * @return Bonus*, NULL when the pool is full
+ */
+Bonus *bonus_spawn(Pool *pool, Sprite *sprite, Map *map);
+
+/**
+ * @brief Give a bonus back to its pool
+ * @param pool Pool of Bonus
+ * @param bonus Bonus
+ */
+void bonus_despawn(Pool *pool, Bonus *bonus);
+
+void bonus_render(Bonus *bonus, Window *window);
 
 void bonus_activate(Bonus *bonus);
 
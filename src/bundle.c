@@ -0,0 +1,145 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bundle.h"
+
+static Bundle *bundle = NULL;
+
+static bool bundle_check(const Uint8 *data, size_t size)
+{
+  if (size < sizeof(BundleHeader)) return false;
+
+  const BundleHeader *header = (const BundleHeader *) data;
+  if (memcmp(header->magic, BUNDLE_MAGIC, sizeof(header->magic)) != 0) return false;
+  if (header->count > (size - sizeof(BundleHeader)) / sizeof(BundleEntry)) return false;
+
+  const BundleEntry *entries = (const BundleEntry *) (data + sizeof(BundleHeader));
+  for (Uint32 i = 0; i < header->count; i++) {
+    const BundleEntry *entry = &entries[i];
+    if (entry->offset > size || entry->size > size - entry->offset) return false;
+    if (entry->type == BUNDLE_RGBA && (Uint64) entry->width * entry->height * 4 != entry->size) return false;
+    if (memchr(entry->name, '\0', BUNDLE_NAME_MAX) == NULL) return false;
+  }
+  return true;
+}
+
+bool bundle_mount(const char *path)
+{
+  if (bundle != NULL) return true;
+
+  char *base = NULL;
+  char default_path[1024];
+  if (path == NULL) {
+    base = SDL_GetBasePath();
+    snprintf(default_path, sizeof(default_path), "%s%s", base != NULL ? base : "", BUNDLE_FILE);
+    SDL_free(base);
+    path = default_path;
+  }
+
+  // without a bundle, the files are read from the disk
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  // the pages are only read from the disk when touched, and shared with the page cache
+  void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "[bundle_mount] Erreur lors du mappage de %s\n", path);
+    return false;
+  }
+
+  if (!bundle_check(data, st.st_size)) {
+    fprintf(stderr, "[bundle_mount] Bundle invalide : %s\n", path);
+    munmap(data, st.st_size);
+    return false;
+  }
+
+  bundle = malloc(sizeof(Bundle));
+  if (bundle == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    munmap(data, st.st_size);
+    return false;
+  }
+
+  bundle->data = data;
+  bundle->size = st.st_size;
+  bundle->entries = (const BundleEntry *) (bundle->data + sizeof(BundleHeader));
+  bundle->count = ((const BundleHeader *) data)->count;
+
+  return true;
+}
+
+void bundle_unmount(void)
+{
+  if (bundle == NULL) return;
+
+  munmap((void *) bundle->data, bundle->size);
+  free(bundle);
+  bundle = NULL;
+}
+
+const Bundle *bundle_get(void)
+{
+  return bundle;
+}
+
+const BundleEntry *bundle_find(const char *path)
+{
+  if (bundle == NULL || path == NULL) return NULL;
+
+  // the game refers to its files from bin/, the bundle from the root
+  while (strncmp(path, "../", 3) == 0) path += 3;
+  while (strncmp(path, "./", 2) == 0) path += 2;
+
+  for (int i = 0; i < bundle->count; i++) {
+    if (strcmp(bundle->entries[i].name, path) == 0) return &bundle->entries[i];
+  }
+  return NULL;
+}
+
+SDL_Surface *bundle_load_image(const char *path)
+{
+  const BundleEntry *entry = bundle_find(path);
+  if (entry == NULL || entry->type != BUNDLE_RGBA) return IMG_Load(path);
+
+  // no copy, the surface reads the mapped pixels until it is freed
+  return SDL_CreateRGBSurfaceWithFormatFrom(
+    (void *) (bundle->data + entry->offset),
+    entry->width,
+    entry->height,
+    32,
+    entry->width * 4,
+    SDL_PIXELFORMAT_RGBA32
+  );
+}
+
+TTF_Font *bundle_open_font(const char *path, int size)
+{
+  const BundleEntry *entry = bundle_find(path);
+  if (entry == NULL || entry->type != BUNDLE_RAW) return TTF_OpenFont(path, size);
+
+  SDL_RWops *rw = SDL_RWFromConstMem(bundle->data + entry->offset, entry->size);
+  if (rw == NULL) return NULL;
+  return TTF_OpenFontRW(rw, 1, size);
+}
+
+FILE *bundle_open_file(const char *path)
+{
+  const BundleEntry *entry = bundle_find(path);
+  if (entry == NULL || entry->type != BUNDLE_RAW) return fopen(path, "r");
+
+  return fmemopen((void *) (bundle->data + entry->offset), entry->size, "r");
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+# ifndef BUNDLE_H
+# define BUNDLE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// looked up next to the executable, see make bundle
+#define BUNDLE_FILE "pacman.bundle"
+#define BUNDLE_MAGIC "PACBNDL1"
+#define BUNDLE_NAME_MAX 64
+// entries start on this boundary, so that rows can be read as Uint32
+#define BUNDLE_ALIGN 16
+
+typedef enum {
+  // bytes of the file as is: font, level
+  BUNDLE_RAW,
+  // image decoded ahead of time, SDL_PIXELFORMAT_RGBA32 rows of width * 4 bytes
+  BUNDLE_RGBA
+} BundleType;
+
+/**
+ * Entry of the table at the start of the bundle, names are the paths of
+ * the files relative to the root of the repository
+ */
+typedef struct {
+  char name[BUNDLE_NAME_MAX];
+  Uint32 type;
+  Uint32 width, height;
+  Uint32 size;
+  // from the start of the bundle
+  Uint64 offset;
+} BundleEntry;
+
+typedef struct {
+  char magic[8];
+  Uint32 count;
+  Uint32 reserved;
+} BundleHeader;
+
+typedef struct {
+  // whole file, mapped read only
+  const Uint8 *data;
+  size_t size;
+  const BundleEntry *entries;
+  int count;
+} Bundle;
+
+/**
+ * @brief Mount the bundle that the loading functions below read from,
+ * nothing is done if one is already mounted
+ * @param path Path of the bundle, NULL for BUNDLE_FILE next to the executable
+ * @return true if a bundle is mounted
+ */
+bool bundle_mount(const char *path);
+
+/**
+ * @brief Unmount the bundle, the files are read from the disk again. Nothing
+ * loaded from the bundle must be in use anymore.
+ */
+void bundle_unmount(void);
+
+/**
+ * @brief Get the mounted bundle
+ * @return Bundle*, NULL if none is mounted
+ */
+const Bundle *bundle_get(void);
+
+/**
+ * @brief Find a file in the mounted bundle
+ * @param path Path of the file, leading "../" and "./" are ignored
+ * @return BundleEntry*, NULL if not bundled
+ */
+const BundleEntry *bundle_find(const char *path);
+
+/**
+ * @brief Load an image, from the bundle without decoding it if it is there,
+ * otherwise from the disk. Safe to call from several threads.
+ * @param path Path of the image
+ * @return SDL_Surface*, NULL on error
+ */
+SDL_Surface *bundle_load_image(const char *path);
+
+/**
+ * @brief Open a font, from the bundle if it is there, otherwise from the disk
+ * @param path Path of the font
+ * @param size Size of the font
+ * @return TTF_Font*, NULL on error
+ */
+TTF_Font *bundle_open_font(const char *path, int size);
+
+/**
+ * @brief Open a text file for reading, from the bundle if it is there,
+ * otherwise from the disk
+ * @param path Path of the file
+ * @return FILE*, NULL on error
+ */
+FILE *bundle_open_file(const char *path);
+
+# endif
\ No newline at end of file
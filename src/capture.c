@@ -0,0 +1,285 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "capture.h"
+#include "window.h"
+
+// the pattern is given to snprintf, it must hold one integer conversion and nothing else to format
+static bool capture_is_pattern(const char *path)
+{
+  int conversions = 0;
+  for (const char *c = path; *c != '\0'; c++) {
+    if (*c != '%') continue;
+    c++;
+    if (*c == '%') continue;
+
+    while (*c == '0' || *c == '-' || *c == '+' || *c == ' ') c++;
+    while (*c >= '0' && *c <= '9') c++;
+    if (*c != 'd' && *c != 'i' && *c != 'u') return false;
+    conversions++;
+  }
+
+  return conversions == 1;
+}
+
+static bool capture_open(Capture *capture, const char *path)
+{
+  size_t length = strlen(path);
+  if (length >= CAPTURE_PATH_MAX) {
+    fprintf(stderr, "[capture_open] Chemin trop long : %s\n", path);
+    return false;
+  }
+  strcpy(capture->path, path);
+
+  if (path[0] == '|') {
+    capture->format = CAPTURE_Y4M;
+    capture->is_pipe = true;
+    capture->output = popen(path + 1, "w");
+  } else if (length > 4 && strcmp(path + length - 4, ".y4m") == 0) {
+    capture->format = CAPTURE_Y4M;
+    capture->output = fopen(path, "wb");
+  } else if (
+    (length > 5 && strcmp(path + length - 5, ".rgba") == 0) ||
+    (length > 4 && strcmp(path + length - 4, ".raw") == 0)
+  ) {
+    capture->format = CAPTURE_RAW;
+    capture->output = fopen(path, "wb");
+  } else {
+    // one file per frame, opened by the encoder
+    if (!capture_is_pattern(path)) {
+      fprintf(stderr, "[capture_open] Le chemin doit contenir un seul %%d, comme frame_%%05d.png : %s\n", path);
+      return false;
+    }
+    capture->format = CAPTURE_PNG;
+    return true;
+  }
+
+  if (capture->output == NULL) {
+    fprintf(stderr, "[capture_open] Erreur d'ouverture de %s\n", path);
+    return false;
+  }
+
+  if (capture->format == CAPTURE_Y4M) {
+    fprintf(
+      capture->output,
+      "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+      capture->width,
+      capture->height,
+      (int) FPS
+    );
+  }
+  return true;
+}
+
+// BT.601 full range, the chroma of each 2x2 block is averaged
+static void capture_rgba_to_yuv(Capture *capture, const Uint8 *pixels)
+{
+  int width = capture->width, height = capture->height;
+  int chroma_width = (width + 1) / 2, chroma_height = (height + 1) / 2;
+  Uint8 *y_plane = capture->yuv;
+  Uint8 *u_plane = y_plane + width * height;
+  Uint8 *v_plane = u_plane + chroma_width * chroma_height;
+
+  for (int y = 0; y < height; y++) {
+    const Uint8 *row = pixels + y * capture->pitch;
+    for (int x = 0; x < width; x++) {
+      const Uint8 *p = row + x * 4;
+      y_plane[y * width + x] = (77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8;
+    }
+  }
+
+  for (int cy = 0; cy < chroma_height; cy++) {
+    for (int cx = 0; cx < chroma_width; cx++) {
+      int r = 0, g = 0, b = 0, n = 0;
+      for (int dy = 0; dy < 2 && cy * 2 + dy < height; dy++) {
+        for (int dx = 0; dx < 2 && cx * 2 + dx < width; dx++) {
+          const Uint8 *p = pixels + (cy * 2 + dy) * capture->pitch + (cx * 2 + dx) * 4;
+          r += p[0];
+          g += p[1];
+          b += p[2];
+          n++;
+        }
+      }
+      r /= n;
+      g /= n;
+      b /= n;
+      u_plane[cy * chroma_width + cx] = (-43 * r - 85 * g + 128 * b + 128 * 256) >> 8;
+      v_plane[cy * chroma_width + cx] = (128 * r - 107 * g - 21 * b + 128 * 256) >> 8;
+    }
+  }
+}
+
+static bool capture_write(Capture *capture, CaptureFrame *frame)
+{
+  int width = capture->width, height = capture->height;
+
+  switch (capture->format)
+  {
+    case CAPTURE_PNG: {
+      char path[CAPTURE_PATH_MAX + 16];
+      snprintf(path, sizeof(path), capture->path, frame->number);
+      SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        frame->pixels, width, height, 32, capture->pitch, SDL_PIXELFORMAT_RGBA32
+      );
+      if (surface == NULL) return false;
+      int result = IMG_SavePNG(surface, path);
+      SDL_FreeSurface(surface);
+      return result == 0;
+    }
+    case CAPTURE_Y4M: {
+      size_t size = width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+      capture_rgba_to_yuv(capture, frame->pixels);
+      fputs("FRAME\n", capture->output);
+      return fwrite(capture->yuv, 1, size, capture->output) == size;
+    }
+    case CAPTURE_RAW:
+      return fwrite(frame->pixels, capture->pitch, height, capture->output) == (size_t) height;
+  }
+
+  return false;
+}
+
+static int capture_encoder(void *data)
+{
+  Capture *capture = data;
+
+  SDL_LockMutex(capture->lock);
+  while (true) {
+    while (capture->queue_count == 0 && capture->is_running) {
+      SDL_CondWait(capture->ready, capture->lock);
+    }
+    // queued frames are still written once stopped
+    if (capture->queue_count == 0) break;
+
+    int index = capture->queue[capture->queue_head];
+    capture->queue_head = (capture->queue_head + 1) % CAPTURE_BUFFERS;
+    capture->queue_count--;
+    SDL_UnlockMutex(capture->lock);
+
+    bool written = capture_write(capture, &capture->frames[index]);
+
+    SDL_LockMutex(capture->lock);
+    if (written) {
+      capture->written++;
+    } else {
+      fprintf(stderr, "[capture_encoder] Erreur d'écriture de l'image %d\n", capture->frames[index].number);
+    }
+    capture->free_list[capture->free_count++] = index;
+  }
+  SDL_UnlockMutex(capture->lock);
+
+  return 0;
+}
+
+Capture *capture_create(const char *path, int width, int height)
+{
+  Capture *capture = malloc(sizeof(Capture));
+  if (capture == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(capture, 0, sizeof(Capture));
+
+  capture->width = width;
+  capture->height = height;
+  capture->pitch = width * 4;
+
+  for (int i = 0; i < CAPTURE_BUFFERS; i++) {
+    capture->frames[i].pixels = malloc((size_t) capture->pitch * height);
+    capture->free_list[capture->free_count++] = i;
+  }
+  capture->yuv = malloc(width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2));
+  capture->lock = SDL_CreateMutex();
+  capture->ready = SDL_CreateCond();
+
+  bool allocated = capture->yuv != NULL && capture->lock != NULL && capture->ready != NULL;
+  for (int i = 0; i < CAPTURE_BUFFERS; i++) {
+    if (capture->frames[i].pixels == NULL) allocated = false;
+  }
+  if (!allocated) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    capture_destroy(capture);
+    return NULL;
+  }
+
+  if (!capture_open(capture, path)) {
+    capture_destroy(capture);
+    return NULL;
+  }
+
+  capture->is_running = true;
+  capture->thread = SDL_CreateThread(capture_encoder, "capture", capture);
+  if (capture->thread == NULL) {
+    fprintf(stderr, "[capture_create] Erreur lors de la création du thread : %s\n", SDL_GetError());
+    capture->is_running = false;
+    capture_destroy(capture);
+    return NULL;
+  }
+
+  return capture;
+}
+
+void capture_destroy(Capture *capture)
+{
+  if (capture == NULL) return;
+
+  if (capture->thread != NULL) {
+    SDL_LockMutex(capture->lock);
+    capture->is_running = false;
+    SDL_CondSignal(capture->ready);
+    SDL_UnlockMutex(capture->lock);
+    SDL_WaitThread(capture->thread, NULL);
+
+    printf(
+      "Capture: %d frames, %d written, %d dropped\n",
+      capture->captured + capture->dropped,
+      capture->written,
+      capture->dropped
+    );
+  }
+
+  if (capture->output != NULL) {
+    if (capture->is_pipe) pclose(capture->output);
+    else fclose(capture->output);
+  }
+  for (int i = 0; i < CAPTURE_BUFFERS; i++) free(capture->frames[i].pixels);
+  free(capture->yuv);
+  if (capture->ready != NULL) SDL_DestroyCond(capture->ready);
+  if (capture->lock != NULL) SDL_DestroyMutex(capture->lock);
+  free(capture);
+}
+
+void capture_frame(Capture *capture, Window *window)
+{
+  if (capture == NULL) return;
+
+  // never wait for the encoder, a frame without a free buffer is dropped
+  SDL_LockMutex(capture->lock);
+  int number = capture->captured + capture->dropped;
+  if (capture->free_count == 0) {
+    capture->dropped++;
+    SDL_UnlockMutex(capture->lock);
+    return;
+  }
+  int index = capture->free_list[--capture->free_count];
+  SDL_UnlockMutex(capture->lock);
+
+  CaptureFrame *frame = &capture->frames[index];
+  frame->number = number;
+  bool copied = window_read_pixels(window, frame->pixels, capture->pitch) == 0;
+
+  SDL_LockMutex(capture->lock);
+  if (copied) {
+    capture->captured++;
+    capture->queue[(capture->queue_head + capture->queue_count) % CAPTURE_BUFFERS] = index;
+    capture->queue_count++;
+    SDL_CondSignal(capture->ready);
+  } else {
+    fprintf(stderr, "[capture_frame] Erreur lors de la lecture de l'image : %s\n", SDL_GetError());
+    capture->dropped++;
+    capture->free_list[capture->free_count++] = index;
+  }
+  SDL_UnlockMutex(capture->lock);
+}
\ No newline at end of file
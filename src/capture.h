@@ -0,0 +1,83 @@
+# ifndef CAPTURE_H
+# define CAPTURE_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "window.h"
+
+#define CAPTURE_BUFFERS 8
+#define CAPTURE_PATH_MAX 256
+
+typedef enum {
+  // one PNG per frame, the path is a pattern like "frame_%05d.png"
+  CAPTURE_PNG,
+  // YUV4MPEG2 4:2:0 stream, read by ffmpeg and most players
+  CAPTURE_Y4M,
+  // RGBA32 frames back to back, no header
+  CAPTURE_RAW
+} CaptureFormat;
+
+typedef struct {
+  Uint8 *pixels;
+  int number;
+} CaptureFrame;
+
+typedef struct {
+  int width, height, pitch;
+  CaptureFormat format;
+  char path[CAPTURE_PATH_MAX];
+  FILE *output;
+  bool is_pipe;
+
+  // buffers are allocated once, then move between the free list and the queue
+  CaptureFrame frames[CAPTURE_BUFFERS];
+  int free_list[CAPTURE_BUFFERS];
+  int free_count;
+  int queue[CAPTURE_BUFFERS];
+  int queue_head, queue_count;
+
+  SDL_Thread *thread;
+  SDL_mutex *lock;
+  SDL_cond *ready;
+  bool is_running;
+  // planes of the frame being encoded to Y4M, only used by the encoder thread
+  Uint8 *yuv;
+
+  int captured;
+  int dropped;
+  int written;
+} Capture;
+
+/**
+ * @brief Create a Capture object and start its encoder thread
+ *
+ * The format follows the path: ".y4m" for a Y4M stream, ".rgba" or ".raw"
+ * for raw frames, a PNG sequence otherwise, whose path holds the frame
+ * number as a single %d with an optional width ("frame_%05d.png"). A path
+ * starting with '|' is a command the Y4M stream is piped to.
+ *
+ * @param path Output path, pattern or command
+ * @param width Frame width
+ * @param height Frame height
+ * @return Capture*, NULL on error
+ */
+Capture *capture_create(const char *path, int width, int height);
+
+/**
+ * @brief Write the frames still queued, stop the encoder thread and
+ * destroy the Capture object
+ * @param capture Capture
+ */
+void capture_destroy(Capture *capture);
+
+/**
+ * @brief Copy the frame drawn so far into a free buffer and queue it for
+ * the encoder thread, the frame is dropped if no buffer is free
+ * @param capture Capture
+ * @param window Window, before window_update
+ */
+void capture_frame(Capture *capture, Window *window);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "counters.h"
+
+Counters counters;
+
+static const char *counter_names[COUNTER_COUNT] = {
+  "draw_calls",
+  "texture_binds",
+  "textures_created",
+  "textures_destroyed",
+  "heap_allocations",
+  "ticks",
+  "catch_up",
+  "input_events"
+};
+
+const char *counter_name(Counter counter)
+{
+  return counter_names[counter];
+}
+
+#ifdef COUNT_HEAP
+/**
+ * Linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, every
+ * allocation of the game goes through these. The libraries keep their own.
+ * Worker threads allocate too, hence the atomic add.
+ */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+  __atomic_fetch_add(&counters.current[COUNTER_HEAP_ALLOCATIONS], 1, __ATOMIC_RELAXED);
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+  __atomic_fetch_add(&counters.current[COUNTER_HEAP_ALLOCATIONS], 1, __ATOMIC_RELAXED);
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+  __atomic_fetch_add(&counters.current[COUNTER_HEAP_ALLOCATIONS], 1, __ATOMIC_RELAXED);
+  return __real_realloc(pointer, size);
+}
+#endif
+
+static void counters_dump_header(void)
+{
+  if (counters.is_json) return;
+
+  fprintf(counters.dump, "frame,ticks_ms");
+  for (int i = 0; i < COUNTER_COUNT; i++) fprintf(counters.dump, ",%s", counter_names[i]);
+  fprintf(counters.dump, "\n");
+}
+
+bool counters_dump_open(const char *path)
+{
+  counters_dump_close();
+
+  size_t length = strlen(path);
+  if (length >= COUNTERS_PATH_MAX) {
+    fprintf(stderr, "[counters_dump_open] Chemin trop long : %s\n", path);
+    return false;
+  }
+
+  counters.dump = fopen(path, "w");
+  if (counters.dump == NULL) {
+    fprintf(stderr, "Erreur d'ouverture du fichier %s\n", path);
+    return false;
+  }
+  strcpy(counters.dump_path, path);
+  counters.is_json = length > 6 && strcmp(path + length - 6, ".jsonl") == 0;
+  counters.dump_lines = 0;
+  counters_dump_header();
+
+  return true;
+}
+
+void counters_dump_close(void)
+{
+  if (counters.dump == NULL) return;
+
+  fclose(counters.dump);
+  counters.dump = NULL;
+}
+
+// the file keeps the last COUNTERS_DUMP_MAX_LINES frames at most, the ones before are in PATH.1
+static void counters_dump_roll(void)
+{
+  char previous[COUNTERS_PATH_MAX + 2];
+  snprintf(previous, sizeof(previous), "%s.1", counters.dump_path);
+
+  fclose(counters.dump);
+  rename(counters.dump_path, previous);
+  counters.dump = fopen(counters.dump_path, "w");
+  counters.dump_lines = 0;
+  if (counters.dump == NULL) {
+    fprintf(stderr, "Erreur d'ouverture du fichier %s\n", counters.dump_path);
+    return;
+  }
+  counters_dump_header();
+}
+
+static void counters_dump_frame(void)
+{
+  if (counters.dump_lines == COUNTERS_DUMP_MAX_LINES) {
+    counters_dump_roll();
+    if (counters.dump == NULL) return;
+  }
+
+  // stdio buffers the lines, the disk is hit every few KB
+  if (counters.is_json) {
+    fprintf(counters.dump, "{\"frame\":%u,\"ticks_ms\":%u", counters.frames, SDL_GetTicks());
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+      fprintf(counters.dump, ",\"%s\":%u", counter_names[i], counters.last[i]);
+    }
+    fprintf(counters.dump, "}\n");
+  } else {
+    fprintf(counters.dump, "%u,%u", counters.frames, SDL_GetTicks());
+    for (int i = 0; i < COUNTER_COUNT; i++) fprintf(counters.dump, ",%u", counters.last[i]);
+    fprintf(counters.dump, "\n");
+  }
+  counters.dump_lines++;
+}
+
+void counters_end_frame(void)
+{
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    Uint32 count = counters.current[i];
+    counters.last[i] = count;
+    counters.totals[i] += count;
+  }
+  // heap allocations from other threads between the copy and the reset are lost, it is a gauge
+  memset(counters.current, 0, sizeof(counters.current));
+  counters.frames++;
+
+  if (counters.dump != NULL) counters_dump_frame();
+}
\ No newline at end of file
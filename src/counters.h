@@ -0,0 +1,77 @@
+# ifndef COUNTERS_H
+# define COUNTERS_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// lines of a dump file before it is moved to PATH.1 and started again
+#define COUNTERS_DUMP_MAX_LINES 36000
+#define COUNTERS_PATH_MAX 256
+
+typedef enum {
+  COUNTER_DRAW_CALLS,
+  COUNTER_TEXTURE_BINDS,
+  COUNTER_TEXTURES_CREATED,
+  COUNTER_TEXTURES_DESTROYED,
+  // only counted with make COUNT_HEAP=1, see counters.c
+  COUNTER_HEAP_ALLOCATIONS,
+  COUNTER_TICKS,
+  // ticks run beyond the first of a frame, to catch up on a late frame
+  COUNTER_CATCH_UP,
+  COUNTER_INPUT_EVENTS,
+  COUNTER_COUNT
+} Counter;
+
+/**
+ * Counts of the frame in progress, moved to last by counters_end_frame.
+ * Counting is an add to this array and nothing else, whether the counts
+ * are read or not.
+ */
+typedef struct {
+  Uint32 current[COUNTER_COUNT];
+  Uint32 last[COUNTER_COUNT];
+  Uint64 totals[COUNTER_COUNT];
+  Uint32 frames;
+
+  // one line per frame, CSV or JSON lines
+  FILE *dump;
+  char dump_path[COUNTERS_PATH_MAX];
+  bool is_json;
+  int dump_lines;
+} Counters;
+
+extern Counters counters;
+
+#ifdef COUNTERS_DISABLED
+#define COUNTER_ADD(counter, n) ((void) 0)
+#else
+#define COUNTER_ADD(counter, n) (counters.current[counter] += (n))
+#endif
+#define COUNTER_INC(counter) COUNTER_ADD(counter, 1)
+
+/**
+ * @brief Get the name of a counter, as in the dump files
+ * @param counter Counter
+ * @return const char*
+ */
+const char *counter_name(Counter counter);
+
+/**
+ * @brief Write the counts of every frame to a file from now on
+ * @param path Path, JSON lines if it ends with ".jsonl", CSV otherwise
+ * @return true on success
+ */
+bool counters_dump_open(const char *path);
+
+/**
+ * @brief Stop writing the counts, the file is flushed and closed
+ */
+void counters_dump_close(void);
+
+/**
+ * @brief End the frame: its counts move to counters.last and to the dump
+ */
+void counters_end_frame(void);
+
+# endif
\ No newline at end of file
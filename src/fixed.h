@@ -0,0 +1,52 @@
+# ifndef FIXED_H
+# define FIXED_H
+
+#include <stdint.h>
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT)
+
+#define FIXED_FROM_INT(v) ((fixed_t) (v) * FIXED_ONE)
+#define FIXED_FROM_FLOAT(v) ((fixed_t) ((v) * FIXED_ONE))
+#define FIXED_TO_INT(v) ((int) ((v) >> FIXED_SHIFT))
+
+/**
+ * 16.16 fixed point number, used for positions and speeds so that the
+ * simulation stays exact and deterministic whatever the speed is
+ */
+typedef int32_t fixed_t;
+
+/**
+ * @brief Minimum of two fixed point numbers, without branching
+ * @param a First value
+ * @param b Second value
+ * @return fixed_t
+ */
+static inline fixed_t fixed_min(fixed_t a, fixed_t b)
+{
+  fixed_t d = a - b;
+  return b + (d & (d >> 31));
+}
+
+/**
+ * @brief Absolute value of a fixed point number, without branching
+ * @param a Value
+ * @return fixed_t
+ */
+static inline fixed_t fixed_abs(fixed_t a)
+{
+  fixed_t m = a >> 31;
+  return (a ^ m) - m;
+}
+
+/**
+ * @brief Sign of a fixed point number
+ * @param a Value
+ * @return -1, 0 or 1
+ */
+static inline int fixed_sign(fixed_t a)
+{
+  return (a > 0) - (a < 0);
+}
+
+# endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "font_cache.h"
+#include "bundle.h"
+#include "glyph_atlas.h"
+
+FontCache *font_cache_create(SDL_Renderer *renderer)
+{
+  FontCache *cache = malloc(sizeof(FontCache));
+  if (cache == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  cache->renderer = renderer;
+  cache->count = 0;
+  cache->clock = 0;
+  cache->retired = NULL;
+  cache->retired_count = 0;
+  cache->retired_capacity = 0;
+
+  return cache;
+}
+
+static void font_cache_entry_close(FontCacheEntry *entry)
+{
+  glyph_atlas_destroy(entry->atlas);
+  TTF_CloseFont(entry->font);
+  entry->atlas = NULL;
+  entry->font = NULL;
+}
+
+void font_cache_destroy(FontCache *cache)
+{
+  if (cache == NULL) return;
+
+  for (int i = 0; i < cache->count; i++) {
+    font_cache_entry_close(&cache->entries[i]);
+  }
+  font_cache_release(cache);
+  free(cache->retired);
+  free(cache);
+}
+
+void font_cache_release(FontCache *cache)
+{
+  if (cache == NULL) return;
+
+  for (int i = 0; i < cache->retired_count; i++) {
+    font_cache_entry_close(&cache->retired[i]);
+  }
+  cache->retired_count = 0;
+}
+
+static bool font_cache_retire(FontCache *cache, FontCacheEntry *entry)
+{
+  if (cache->retired_count == cache->retired_capacity) {
+    int capacity = cache->retired_capacity == 0 ? FONT_CACHE_CAPACITY : cache->retired_capacity * 2;
+    FontCacheEntry *retired = realloc(cache->retired, sizeof(FontCacheEntry) * capacity);
+    if (retired == NULL) {
+      fprintf(stderr, "Erreur d'allocation mémoire\n");
+      return false;
+    }
+    cache->retired = retired;
+    cache->retired_capacity = capacity;
+  }
+
+  cache->retired[cache->retired_count++] = *entry;
+  entry->atlas = NULL;
+  entry->font = NULL;
+  return true;
+}
+
+GlyphAtlas *font_cache_get(FontCache *cache, const char *path, int size)
+{
+  if (cache == NULL || path == NULL) return NULL;
+
+  cache->clock++;
+
+  for (int i = 0; i < cache->count; i++) {
+    FontCacheEntry *entry = &cache->entries[i];
+    if (entry->size == size && strcmp(entry->path, path) == 0) {
+      entry->last_used = cache->clock;
+      return entry->atlas;
+    }
+  }
+
+  if (strlen(path) >= FONT_CACHE_PATH_MAX) {
+    fprintf(stderr, "[font_cache_get] Chemin de police trop long : %s\n", path);
+    return NULL;
+  }
+
+  // reuse a free slot, or retire the least recently used font
+  FontCacheEntry *entry = &cache->entries[cache->count];
+  if (cache->count == FONT_CACHE_CAPACITY) {
+    entry = &cache->entries[0];
+    for (int i = 1; i < cache->count; i++) {
+      if (cache->entries[i].last_used < entry->last_used) entry = &cache->entries[i];
+    }
+    if (!font_cache_retire(cache, entry)) return NULL;
+  } else {
+    cache->count++;
+  }
+
+  entry->font = bundle_open_font(path, size);
+  entry->atlas = glyph_atlas_create(cache->renderer, entry->font, size);
+  if (entry->atlas == NULL) {
+    fprintf(stderr, "Erreur lors du chargement de la police : %s\n", TTF_GetError());
+    if (entry->font != NULL) TTF_CloseFont(entry->font);
+    // drop the slot by moving the last entry in it
+    *entry = cache->entries[--cache->count];
+    return NULL;
+  }
+
+  strcpy(entry->path, path);
+  entry->size = size;
+  entry->last_used = cache->clock;
+
+  return entry->atlas;
+}
+
+int font_cache_measure(FontCache *cache, const char *path, int size, const char *text)
+{
+  GlyphAtlas *atlas = font_cache_get(cache, path, size);
+  if (atlas == NULL) return 0;
+
+  return glyph_atlas_measure(atlas, text);
+}
\ No newline at end of file
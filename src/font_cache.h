@@ -0,0 +1,75 @@
+# ifndef FONT_CACHE_H
+# define FONT_CACHE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "glyph_atlas.h"
+
+#define FONT_CACHE_CAPACITY 8
+#define FONT_CACHE_PATH_MAX 256
+
+typedef struct {
+  char path[FONT_CACHE_PATH_MAX];
+  int size;
+  TTF_Font *font;
+  GlyphAtlas *atlas;
+  Uint32 last_used;
+} FontCacheEntry;
+
+typedef struct {
+  SDL_Renderer *renderer;
+  FontCacheEntry entries[FONT_CACHE_CAPACITY];
+  int count;
+  Uint32 clock;
+  // evicted fonts, their atlas may still be in a queued draw until font_cache_release
+  FontCacheEntry *retired;
+  int retired_count, retired_capacity;
+} FontCache;
+
+/**
+ * @brief Create a FontCache object
+ * @param renderer SDL_Renderer the glyph atlases are uploaded to, NULL
+ * for software rendering
+ * @return FontCache*
+ */
+FontCache *font_cache_create(SDL_Renderer *renderer);
+
+/**
+ * @brief Destroy the FontCache object, closing every font
+ * @param cache FontCache
+ */
+void font_cache_destroy(FontCache *cache);
+
+/**
+ * @brief Get the glyph atlas of a font at a pixel size
+ *
+ * Each (path, size) pair is opened and rasterized once. When the cache is
+ * full the least recently used font makes room, and is only closed by the
+ * next font_cache_release, as draws queued with its atlas still use it.
+ *
+ * @param cache FontCache
+ * @param path Font path
+ * @param size Font size
+ * @return GlyphAtlas*, NULL on error
+ */
+GlyphAtlas *font_cache_get(FontCache *cache, const char *path, int size);
+
+/**
+ * @brief Close the fonts evicted since the last call, once no queued draw
+ * uses their atlas
+ * @param cache FontCache
+ */
+void font_cache_release(FontCache *cache);
+
+/**
+ * @brief Measure the width of a text with a font at a pixel size
+ * @param cache FontCache
+ * @param path Font path
+ * @param size Font size
+ * @param text Text
+ * @return int
+ */
+int font_cache_measure(FontCache *cache, const char *path, int size, const char *text);
+
+# endif
\ No newline at end of file
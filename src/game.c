@@ -1,6 +1,7 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <string.h>
 
 #include "game.h"
 #include "game_state.h"
@@ -12,7 +13,42 @@
 
 #define _XOPEN_SOURCE 500
 
-Game *game_create(int width, int height, int scale)
+// the map and everything moving on it, what a tick of game_update needs
+static bool game_create_world(Game *game)
+{
+  // init map
+  game->map = map_init(
+    game->window, 
+    LEVEL_FILE, 
+    MAP_TEXTURE_FILE
+  );
+  if (game->map == NULL) return false;
+
+  // init player
+  game->player = player_create(game->window);
+  if (game->player == NULL) return false;
+
+  // init ghost
+  for (int i = 0; i < GHOST_AMOUNT; i++) {
+    game->ghosts[i] = ghost_create(game->window, i+1);
+    if (game->ghosts[i] == NULL) return false;
+  }
+
+  // init ghost house
+  game->ghost_house = ghost_house_create();
+  if (game->ghost_house == NULL) return false;
+  ghost_house_reset(game->ghost_house, game->map, game->ghosts, game->level);
+
+  // init Bonus, the pool is allocated once and bonuses are set up in place
+  game->bonus_sprite = window_load_sprite(game->window, BONUS_TEXTURE_FILE);
+  game->bonuses = POOL_CREATE(Bonus, BONUS_POOL_CAPACITY);
+  if (game->bonuses == NULL) return false;
+  bonus_spawn(game->bonuses, game->bonus_sprite, game->map);
+
+  return true;
+}
+
+Game *game_create(int width, int height, int scale, RenderBackend backend)
 {
   Game *game = malloc(sizeof(*game));
   if (game == NULL) {
@@ -22,37 +58,65 @@ Game *game_create(int width, int height, int scale)
 
   game->width = width;
   game->height = height;
+  game->scale = scale;
+
+  // every sprite goes in a single atlas, decoded on worker threads while
+  // the window and the fonts are created here
+  char ghost_paths[GHOST_AMOUNT][64];
+  const char *sprite_paths[SPRITE_ATLAS_CAPACITY];
+  int sprite_count = 0;
+  sprite_paths[sprite_count++] = MAP_TEXTURE_FILE;
+  sprite_paths[sprite_count++] = PLAYER_TEXTURE_FILE;
+  sprite_paths[sprite_count++] = GHOST_SCARED_TEXTURE_FILE;
+  sprite_paths[sprite_count++] = HEART_TEXTURE_FILE;
+  sprite_paths[sprite_count++] = BONUS_TEXTURE_FILE;
+  for (int i = 0; i < GHOST_AMOUNT; i++) {
+    sprintf(ghost_paths[i], GHOST_TEXTURE_FILE, i + 1);
+    sprite_paths[sprite_count++] = ghost_paths[i];
+  }
+  AssetLoader *loader = asset_loader_start(sprite_paths, sprite_count);
+  if (loader == NULL) return NULL;
 
   // init game window for rendering
-  game->window = window_create("Pacman", width, height);
-  if (game->window == NULL) return NULL;
+  game->window = window_create("Pacman", width, height, scale, backend);
+  if (game->window == NULL) {
+    asset_loader_destroy(loader);
+    return NULL;
+  }
+  game->owns_window = true;
 
-  // loading font
-  window_load_font(game->window, FONT_FILE, 16);
+  // loading font, every size of the HUD is opened once up front
+  int font_sizes[] = {
+    DEFAULT_FONT_SIZE,
+    GAME_OVER_FONT_SIZE,
+    INSERT_COIN_FONT_SIZE,
+    FPS_FONT_SIZE
+  };
+  for (int i = 0; i < (int) (sizeof(font_sizes) / sizeof(font_sizes[0])); i++) {
+    window_load_font(game->window, FONT_FILE, font_sizes[i]);
+  }
 
-  // loading textures
-  window_load_texture(
-    game->window, 
-    HEART_TEXTURE_FILE, 
-    &game->heart_texture
-  );
+  // only the upload to the GPU is left to do on this thread
+  window_load_sprite_atlas(game->window, loader);
+  asset_loader_destroy(loader);
 
-  // init map
-  game->map = map_init(
+  game->heart_sprite = window_load_sprite(
     game->window, 
-    LEVEL_FILE, 
-    MAP_TEXTURE_FILE
+    HEART_TEXTURE_FILE
   );
-  if (game->map == NULL) return NULL;
+  if (game->heart_sprite == NULL) return NULL;
 
   // init game score
   game->score = 0;
   game->level = 1;
 
   // init game pseudo
-  game->pseudo = malloc(sizeof(char) * PSEUDO_MAX_LENGTH);
-  game->pseudo = "ANON";
-  game->pseudo_index = 3;
+  string_builder_init(&game->pseudo, game->pseudo_buffer, sizeof(game->pseudo_buffer));
+  string_builder_append(&game->pseudo, PSEUDO_DEFAULT);
+
+  // scratch memory of a frame
+  game->frame_arena = arena_create(FRAME_ARENA_SIZE);
+  if (game->frame_arena == NULL) return NULL;
 
   // init game state
   game->state = STATE_MENU;
@@ -61,25 +125,25 @@ Game *game_create(int width, int height, int scale)
 
   // init game fps
   game->display_fps = false;
+  game->display_counters = false;
   game->fps = 0;
 
-  // init player
-  game->player = player_create(game->window);
-  if (game->player == NULL) return NULL;
+  // draw the entities where the last update left them until game_run says otherwise
+  game->interpolation = 1.0f;
 
-  // init ghost
-  for (int i = 0; i < GHOST_AMOUNT; i++) {
-    game->ghosts[i] = ghost_create(game->window, i+1);
-    if (game->ghosts[i] == NULL) return NULL;
-  }
+  // no capture, metrics nor replay unless asked for
+  game->capture = NULL;
+  game->metrics = NULL;
+  game->replay = NULL;
 
-  // init Bonus
-  game->bonus = bonus_create(game->window, game->map);
-  if (game->bonus == NULL) return NULL;
+  // init map and entities
+  if (!game_create_world(game)) return NULL;
 
-  // init best scores
+  // init best scores, a game without them can still be played
   printf("Loading best scores...\n");
-  game_load_best_scores(game);
+  game->scores = score_store_open(SCORE_FILE, LEGACY_SCORE_FILE, BEST_SCORES_COUNT);
+  game->io = io_worker_create();
+  if (game->scores != NULL) score_store_set_worker(game->scores, game->io);
 
   // init keys
   game->keys = SDL_GetKeyboardState(NULL);
@@ -89,13 +153,39 @@ Game *game_create(int width, int height, int scale)
   return game;
 }
 
+Game *game_create_shared(Window *window)
+{
+  Game *game = malloc(sizeof(*game));
+  if (game == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  // no HUD, scores, capture, metrics nor replay
+  memset(game, 0, sizeof(*game));
+
+  game->width = window->width;
+  game->height = window->height;
+  game->scale = 1;
+  game->window = window;
+  game->owns_window = false;
+  game->level = 1;
+  game->state = STATE_MENU;
+  game->interpolation = 1.0f;
+
+  game->frame_arena = arena_create(FRAME_ARENA_SIZE);
+  if (game->frame_arena == NULL || !game_create_world(game)) {
+    game_destroy(game);
+    return NULL;
+  }
+
+  return game;
+}
+
 void game_destroy(Game *game)
 {
   if (game == NULL) {
     return;
   }
-  // destroy game window
-  window_destroy(game->window);
   // destroy player
   player_destroy(game->player);
   // destroy ghosts
@@ -103,10 +193,27 @@ void game_destroy(Game *game)
   {
     ghost_destroy(game->ghosts[i]);
   }
+  // destroy ghost house
+  ghost_house_destroy(game->ghost_house);
   // destroy map
   map_destroy(game->map);
   // destroy bonus
-  bonus_destroy(game->bonus);
+  pool_destroy(game->bonuses);
+  asset_manager_release(game->bonus_sprite);
+  // stop the capture, frames still queued are written
+  capture_destroy(game->capture);
+  // stop publishing, monitors see the segment go away
+  metrics_destroy(game->metrics);
+  // a recording ends here
+  replay_destroy(game->replay);
+  // sync the scores still queued, then close them and free the scratch memory
+  io_worker_destroy(game->io);
+  score_store_close(game->scores);
+  arena_destroy(game->frame_arena);
+  // release the heart sprite
+  asset_manager_release(game->heart_sprite);
+  // destroy game window, last since entities give their sprites back to it
+  if (game->owns_window) window_destroy(game->window);
   free(game);
 }
 
@@ -127,6 +234,7 @@ void game_run(Game *game)
   while (game->state != STATE_EXIT)
   {
     render = true;
+    int ticks = 0;
 
     first_time = SDL_GetTicks() / 1000.0f;
     passed_time = first_time - last_time;
@@ -142,6 +250,7 @@ void game_run(Game *game)
 
       // update game
       game_update(game, (float) UPDATE_CAP);
+      ticks++;
 
       // game inputs
       game_input(game);
@@ -153,7 +262,13 @@ void game_run(Game *game)
       }
     }
 
+    // more than one tick in a frame, the last frame was late
+    if (ticks > 1) COUNTER_ADD(COUNTER_CATCH_UP, ticks - 1);
+
     if (render) {
+      // entities are drawn between their last two ticks, by the time left over
+      game->interpolation = unprocessed_time / (UPDATE_CAP);
+
       // render game
       game_render(game);
       frames++;
@@ -163,8 +278,34 @@ void game_run(Game *game)
   }
 }
 
+void game_run_frames(Game *game, int frames)
+{
+  if (game == NULL) return;
+
+  game->interpolation = 1.0f;
+  for (int i = 0; i < frames && game->state != STATE_EXIT; i++) {
+    game_update(game, (float) UPDATE_CAP);
+    game_render(game);
+  }
+}
+
 void game_update(Game *game, float delta)
 {
+  COUNTER_INC(COUNTER_TICKS);
+  // the clock of the game logic, see simulation.h
+  simulation.tick++;
+
+  // the keys of this tick are recorded, or come from the replay
+  replay_tick(game->replay, &game->keys);
+
+  // start of a tick, whatever moves from here is interpolated from there
+  game->player->prev_x = game->player->x;
+  game->player->prev_y = game->player->y;
+  for (int i = 0; i < GHOST_AMOUNT; i++) {
+    game->ghosts[i]->prev_x = game->ghosts[i]->x;
+    game->ghosts[i]->prev_y = game->ghosts[i]->y;
+  }
+
   // Check for reset game
   if (game->last_key.keysym.mod & KMOD_LCTRL && game->keys[SDL_SCANCODE_R]) {
     game_reset(game);
@@ -182,6 +323,11 @@ void game_update(Game *game, float delta)
     game->display_fps = !game->display_fps;
   }
 
+  // Check for display counters
+  if (game->last_key.keysym.mod & KMOD_LCTRL && game->keys[SDL_SCANCODE_P]) {
+    game->display_counters = !game->display_counters;
+  }
+
   switch ((int)game->state)
   {
     case STATE_MENU:
@@ -210,9 +356,15 @@ void game_input(Game *game)
   float start_time = SDL_GetTicks() / 1000.0f;
   SDL_Event event;
   while (SDL_PollEvent(&event)) {
+    COUNTER_INC(COUNTER_INPUT_EVENTS);
     // check for exit game
     if (event.type == SDL_QUIT) game->state = STATE_EXIT;
     // check for key pressed
+    // display settings, once per key press
+    if (event.type == SDL_KEYDOWN && !event.key.repeat) {
+      if (event.key.keysym.scancode == SDL_SCANCODE_F11) window_toggle_fullscreen(game->window);
+      if (event.key.keysym.scancode == SDL_SCANCODE_F10) window_toggle_integer_scale(game->window);
+    }
     if (event.type == SDL_KEYDOWN && !game->is_key_pressed) {
       game->is_key_pressed = true;
       game->last_key = event.key;
@@ -224,26 +376,29 @@ void game_input(Game *game)
     }
     // check for text input
     if (event.type == SDL_TEXTINPUT && game->state == STATE_GAME_OVER) {
-      if (game->pseudo_index < PSEUDO_MAX_LENGTH) {
-        char *tmp = malloc(sizeof(char) * (game->pseudo_index + 1));
-        sprintf(tmp, "%s%s", game->pseudo[0] == ' '? "" : game->pseudo, event.text.text);
-        game->pseudo = tmp;
-        game->pseudo_index++;
-      }
+      // cut at PSEUDO_MAX_LENGTH, the buffer is never reallocated
+      string_builder_append(&game->pseudo, event.text.text);
     }
   }
 }
 
 void game_render(Game *game)
 {
+  // whatever the last frame formatted is gone, its text was queued by now
+  arena_reset(game->frame_arena);
+
   // clear window
   window_clear(game->window);
 
   // render map
   map_render(game->map, game->window);
 
+  // everything else is on top, unless it picks its own layer
+  window_set_layer(game->window, RENDER_LAYER_HUD);
+
   // render fps
   if (game->display_fps) display_fps(game);
+  if (game->display_counters) display_counters(game);
 
   switch ((int)game->state)
   {
@@ -263,8 +418,27 @@ void game_render(Game *game)
       break;
   }
 
+  // capture the frame before it is presented
+  capture_frame(game->capture, game->window);
+
   // update window
   window_update(game->window);
+
+  // the stats of the window are complete once presented
+  COUNTER_ADD(COUNTER_DRAW_CALLS, game->window->stats.draw_calls);
+  COUNTER_ADD(COUNTER_TEXTURE_BINDS, game->window->stats.texture_switches);
+  counters_end_frame();
+
+  // publish for the monitors, memory writes only
+  if (game->metrics != NULL) {
+    MetricsSnapshot *snapshot = &game->metrics->snapshot;
+    snapshot->state = game->state;
+    snapshot->score = game->score;
+    snapshot->level = game->level;
+    snapshot->lives = game->player->lives;
+    snapshot->fps = game->fps;
+    metrics_publish(game->metrics);
+  }
 }
 
 void game_check_collision(Game *game)
@@ -275,46 +449,38 @@ void game_check_collision(Game *game)
   Window *window = game->window;
 
   if (player->next_x < 0) {
-    player->next_x = window->width - PLAYER_SIZE;
-    player->x = player->next_x;;
+    player_set_position(player, window->width - PLAYER_SIZE, player->y);
     return;
   }
   if (player->next_x > window->width - PLAYER_SIZE) {
-    player->next_x = 0;
-    player->x = player->next_x;
+    player_set_position(player, 0, player->y);
     return;
   }
   if (player->next_y < 0) {
-    player->next_y = window->height - PLAYER_SIZE;
-    player->y = player->next_y;
+    player_set_position(player, player->x, window->height - PLAYER_SIZE);
     return;
   }
   if (player->next_y > window->height - PLAYER_SIZE) {
-    player->next_y = 0;
-    player->y = player->next_y;
+    player_set_position(player, player->x, 0);
     return;
   }
 
   for (int i = 0; i < GHOST_AMOUNT; i++) {
     Ghost *ghost = game->ghosts[i];
     if (ghost->x < 0) {
-      ghost->next_x = window->width - GHOST_SIZE;
-      ghost->x = ghost->next_x;
+      ghost_set_position(ghost, window->width - GHOST_SIZE, ghost->y);
       return;
     }
     if (ghost->x > window->width - GHOST_SIZE) {
-      ghost->next_x = 0;
-      ghost->x = ghost->next_x;
+      ghost_set_position(ghost, 0, ghost->y);
       return;
     }
     if (ghost->y < 0) {
-      ghost->next_y = window->height - GHOST_SIZE;
-      ghost->y = ghost->next_y;
+      ghost_set_position(ghost, ghost->x, window->height - GHOST_SIZE);
       return;
     }
     if (ghost->y > window->height - GHOST_SIZE) {
-      ghost->next_y = 0;
-      ghost->y = ghost->next_y;
+      ghost_set_position(ghost, ghost->x, 0);
       return;
     }
   }
@@ -330,6 +496,7 @@ void game_check_collision(Game *game)
     map->map[x][y] = TILE_SPACE;
     game->score += 10;
     game->player->number_of_dots_eaten++;
+    ghost_house_dot_eaten(game->ghost_house, game->ghosts);
   }
 
   // check player collision with power up tile
@@ -337,34 +504,39 @@ void game_check_collision(Game *game)
     map->map[x][y] = TILE_SPACE;
     game->score += 50;
     game->player->invincible = true;
-    game->player->invincible_start_time = SDL_GetTicks() / 1000.0f;
+    game->player->invincible_start_time = simulation_time();
     game->player->number_of_ghosts_eaten = 0;
     game->player->number_of_power_pellets_eaten++;
+    ghost_house_dot_eaten(game->ghost_house, game->ghosts);
   }
 
   // check player collision with ghosts
   for (int i = 0; i < GHOST_AMOUNT; i++) {
-    if (ghost_check_collision(game->ghosts[i], player)) {
+    Ghost *ghost = game->ghosts[i];
+    // ghosts in the house and eyes can't be touched
+    if (!ghost->is_active || ghost->is_eaten) continue;
+
+    if (ghost_check_collision(ghost, player)) {
       if (player->invincible) {
-        ghost_reset(game->ghosts[i]);
+        ghost_eat(ghost);
         player->number_of_ghosts_eaten++;
         game->score += 100 * player->number_of_ghosts_eaten;
       } else {
         player_kill(player);
-        for (int i = 0; i < GHOST_AMOUNT; i++) {
-          ghost_reset(game->ghosts[i]);
-        }
+        ghost_house_restart(game->ghost_house, game->ghosts);
+        break;
       }
     }
   }
 
   // check player collision with bonus
-  if (bonus_check_collision(game->bonus, player)) {
-    bonus_destroy(game->bonus);
-    game->bonus = bonus_create(
-      game->window,
-      game->map
-    );
+  for (int i = 0; i < BONUS_POOL_CAPACITY; i++) {
+    Bonus *bonus = pool_get(game->bonuses, i);
+    if (bonus == NULL || !bonus_check_collision(bonus, player)) continue;
+
+    // a new one takes its place, in the same slot
+    bonus_despawn(game->bonuses, bonus);
+    bonus_spawn(game->bonuses, game->bonus_sprite, game->map);
     game->score += 1000;
   }
 }
@@ -382,28 +554,20 @@ void game_reset(Game *game)
   game->is_paused = false;
 
   // reset map
-  map_destroy(game->map);
-  game->map = map_init(
-    game->window, 
-    LEVEL_FILE, 
-    MAP_TEXTURE_FILE
-  );
+  map_reset(game->map);
 
   // reset player
   player_reset(game->player);
   player_reset_lives(game->player);
 
   // reset bonus
-  bonus_destroy(game->bonus);
-  game->bonus = bonus_create(
-    game->window,
-    game->map
-  );
+  pool_clear(game->bonuses);
+  bonus_spawn(game->bonuses, game->bonus_sprite, game->map);
 
   // reset ghosts
+  ghost_house_reset(game->ghost_house, game->map, game->ghosts, game->level);
   for (int i = 0; i < GHOST_AMOUNT; i++) {
-    ghost_reset(game->ghosts[i]);
-    ghost_set_speed(game->ghosts[i], GHOST_SPEED);
+    ghost_set_speed(game->ghosts[i], ghost_speed_for_level(game->level));
   }
 }
 
@@ -414,12 +578,7 @@ void game_next_level(Game *game)
   }
 
   // reset map
-  map_destroy(game->map);
-  game->map = map_init(
-    game->window, 
-    LEVEL_FILE, 
-    MAP_TEXTURE_FILE
-  );
+  map_reset(game->map);
 
   // update game
   game->level++;
@@ -430,33 +589,97 @@ void game_next_level(Game *game)
   player_reset(game->player);
 
   // reset bonus
-  bonus_destroy(game->bonus);
-  game->bonus = bonus_create(
-    game->window,
-    game->map
-  );
+  pool_clear(game->bonuses);
+  bonus_spawn(game->bonuses, game->bonus_sprite, game->map);
   
   // reset ghosts
+  ghost_house_reset(game->ghost_house, game->map, game->ghosts, game->level);
   for (int i = 0; i < GHOST_AMOUNT; i++) {
-    ghost_reset(game->ghosts[i]);
-    ghost_set_speed(game->ghosts[i], game->ghosts[i]->speed++);
+    ghost_set_speed(game->ghosts[i], ghost_speed_for_level(game->level));
   }
 }
 
 void display_fps(Game *game)
 {
-  char str[255];
-  sprintf(str, "FPS: %d", game->fps);
+  const char *str = arena_printf(
+    game->frame_arena,
+    "FPS: %d  Draw calls: %d  Texture switches: %d",
+    game->fps,
+    game->window->stats.draw_calls,
+    game->window->stats.texture_switches
+  );
+  if (str == NULL) return;
 
   window_draw_text(
     game->window, 
     game->width - 5,
-    game->height - 12,
+    game->height - FPS_FONT_SIZE / 2 - 5,
     str,
     FPS_FONT_SIZE,
     WHITE_COLOR,
     ALIGN_RIGHT
   );
+
+  AssetStats assets = game->window->assets->stats;
+  str = arena_printf(
+    game->frame_arena,
+    "Decodes: %d  Cache hits: %d  Textures: %d KB",
+    assets.decodes,
+    assets.hits,
+    (int) (assets.texture_bytes / 1024)
+  );
+  if (str == NULL) return;
+
+  window_draw_text(
+    game->window, 
+    game->width - 5,
+    game->height - FPS_FONT_SIZE * 3 / 2 - 10,
+    str,
+    FPS_FONT_SIZE,
+    WHITE_COLOR,
+    ALIGN_RIGHT
+  );
+
+  // the text of the overlay itself goes through the arena, only the
+  // overflows reach the heap
+  ArenaStats arena = game->frame_arena->stats;
+  str = arena_printf(
+    game->frame_arena,
+    "Arena: %d allocs  Peak: %d B  Heap: %d",
+    arena.allocations,
+    (int) arena.peak,
+    arena.overflows
+  );
+  if (str == NULL) return;
+
+  window_draw_text(
+    game->window, 
+    game->width - 5,
+    game->height - FPS_FONT_SIZE * 5 / 2 - 15,
+    str,
+    FPS_FONT_SIZE,
+    WHITE_COLOR,
+    ALIGN_RIGHT
+  );
+}
+
+void display_counters(Game *game)
+{
+  // counts of the last frame, one per line from the top left
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    const char *str = arena_printf(game->frame_arena, "%s: %u", counter_name(i), counters.last[i]);
+    if (str == NULL) return;
+
+    window_draw_text(
+      game->window,
+      5,
+      40 + i * DEFAULT_FONT_SIZE,
+      str,
+      DEFAULT_FONT_SIZE,
+      WHITE_COLOR,
+      ALIGN_LEFT
+    );
+  }
 }
 
 void display_start_button(Game *game)
@@ -491,21 +714,19 @@ void display_start_button(Game *game)
 
 void display_best_scores(Game *game)
 {
-  for (int i = 0; i < 5; i++) {
-    char *str = malloc(sizeof(char) * 255);
-    sprintf(str, "%s", game->best_scores[i]);
+  if (game->scores == NULL) return;
 
+  // lines formatted by the store when they change, copied by the render queue
+  for (int i = 0; i < BEST_SCORES_COUNT; i++) {
     window_draw_text(
       game->window, 
       game->width / 2, 
       ((game->height / 4) * 3 - DEFAULT_FONT_SIZE) + (i * DEFAULT_FONT_SIZE), 
-      str, 
+      game->scores->top[i], 
       DEFAULT_FONT_SIZE, 
       WHITE_COLOR,
       ALIGN_CENTER
     );
-
-    free(str);
   }
 }
 
@@ -528,8 +749,8 @@ void game_state_menu_update(Game *game, float delta_time)
 
 void display_score(Game *game)
 {
-  char str[255];
-  sprintf(str, "Score: %d", game->score);
+  const char *str = arena_printf(game->frame_arena, "Score: %d", game->score);
+  if (str == NULL) return;
 
   window_draw_text(
     game->window, 
@@ -546,14 +767,14 @@ void display_lives(Game *game)
 {
   for (int i = game->player->lives; i > 0; i--) {
     SDL_Rect rect = { game->width - (MAP_TILE_SIZE * i), 0, 32, 32 };
-    window_draw_texture(game->window, game->heart_texture, NULL, &rect);
+    window_draw_sprite(game->window, game->heart_sprite, NULL, &rect, 0.0, SDL_FLIP_NONE);
   }
 }
 
 void display_level(Game *game)
 {
-  char str[255];
-  sprintf(str, "Level: %d", game->level);
+  const char *str = arena_printf(game->frame_arena, "Level: %d", game->level);
+  if (str == NULL) return;
 
   window_draw_text(
     game->window, 
@@ -586,21 +807,24 @@ void game_state_game_draw(Game *game)
 {
   if (game == NULL) return;
 
-  // display game info
+  // display game info, the HUD is drawn over the entities whatever the order
   display_score(game);
   display_lives(game);
   display_level(game);
   if (game->is_paused) display_pause(game);
 
   // render bonus
-  bonus_render(game->bonus, game->window, game->map);
+  for (int i = 0; i < BONUS_POOL_CAPACITY; i++) {
+    Bonus *bonus = pool_get(game->bonuses, i);
+    if (bonus != NULL) bonus_render(bonus, game->window);
+  }
 
   // render player
-  player_render(game->player, game->window);
+  player_render(game->player, game->window, game->interpolation);
 
   // render ghosts
   for (int i = 0; i < GHOST_AMOUNT; i++) {
-    ghost_render(game->ghosts[i], game->window);
+    ghost_render(game->ghosts[i], game->window, game->interpolation);
   }
 }
 
@@ -630,15 +854,20 @@ void game_state_game_update(Game *game, float delta_time)
   game_check_collision(game);
 
   // update bonus
-  if (!game->is_paused) bonus_update(game->bonus, game->map, game->player);
+  for (int i = 0; i < BONUS_POOL_CAPACITY && !game->is_paused; i++) {
+    Bonus *bonus = pool_get(game->bonuses, i);
+    if (bonus != NULL) bonus_update(bonus, game->map, game->player);
+  }
 
   // update player
   if (!game->is_paused) {
     player_update(game->map, game->player, game->keys);
   }
-  // update ghosts
+  // update ghosts, the ones waiting in the house are left alone
   if (!game->is_paused) {
+    ghost_house_update(game->ghost_house, game->ghosts);
     for (int i = 0; i < GHOST_AMOUNT; i++) {
+      if (!game->ghosts[i]->is_active) continue;
       ghost_update(game->map, game->ghosts[i], game->player);
     }
   }
@@ -695,18 +924,10 @@ void game_state_game_over_draw(Game *game)
     return;
   }
 
-  /*int min_score;
-  char *min_pseudo = malloc(sizeof(char *) * 5);
-  sscanf(game->best_scores[4], "%s %d", min_pseudo, &min_score);
-  if (game->score < min_score) {
-    game_reset(game);
-    return;
-  }*/
-
   display_game_over(game);
   display_insert_name(game);
 
-  display_pseudo(game, game->pseudo);
+  display_pseudo(game, game->pseudo.data);
 }
 
 void game_state_game_over_update(Game *game, float delta)
@@ -715,92 +936,20 @@ void game_state_game_over_update(Game *game, float delta)
     return;
   }
 
-  char *temp = malloc(sizeof(char *) * 20);
-
   if (game->keys[SDL_SCANCODE_BACKSPACE]) {
-    if (game->pseudo_index == 0) {
-      game->pseudo = " ";
-      return;
-    }
-    for (int i = 0; i < game->pseudo_index; i++) {
-      temp[i] = game->pseudo[i];
-    }
-    game->pseudo = temp;
-    game->pseudo_index--;
+    string_builder_pop(&game->pseudo);
   }
   if (game->keys[SDL_SCANCODE_RETURN]) {
-    game_insert_score(game, game->score, game->pseudo);
-    game_save_best_scores(game);
+    if (game->pseudo.length == 0) string_builder_append(&game->pseudo, PSEUDO_DEFAULT);
+    game_insert_score(game, game->score, game->pseudo.data);
     game_reset(game);
   }
 }
 
 void game_insert_score(Game *game, int score, char *pseudo)
 {
-  int index = 0, i = 0;
-  // find the index where to insert the score
-  while (index < 5) {
-    char *temp = malloc(sizeof(char *) * 255);
-    strcpy(temp, game->best_scores[i]);
-    char *current_pseudo = strtok(temp, " : ");
-    int current_score = atoi(strtok(NULL, " : "));
-    if (current_score > score) {
-      index++;
-    } else {
-      break;
-    }
-    i++;
-  }
-
-  // move all scores after the index
-  for (int i = 4; i > index; i--) {
-    strcpy(game->best_scores[i], game->best_scores[i - 1]);
-  }
-
-  // insert the score
-  sprintf(game->best_scores[index], "%s : %d", pseudo, score);
-}
-
-void game_save_best_scores(Game *game)
-{
-  FILE *fp = fopen(SCORE_FILE, "w");
-  if (fp == NULL) {
-    return;
-  }
-
-  for (int i = 0; i < 5; i++) {
-    fprintf(fp, "%s\n", game->best_scores[i]);
-  }
-
-  fclose(fp);
-}
-
-void game_load_best_scores(Game *game)
-{
-  FILE *fp = fopen(SCORE_FILE, "r");
-  if (fp == NULL) {
-    fp = fopen(SCORE_FILE, "w");
-  }
-
-  char str[255];
-  int i = 0;
-
-  game->best_scores = malloc(sizeof(char *) * 5);
-
-  while (fgets(str, 255, fp) != NULL) {
-    game->best_scores[i] = malloc(sizeof(char) * 255);
-    char *pseudo = strtok(str, " : ");
-    int score = atoi(strtok(NULL, " : "));
-
-    sprintf(game->best_scores[i], "%s : %d", pseudo, score);
-    i++;
-  }
-
-  if (i < 5) {
-    for (int j = i; j < 5; j++) {
-      sprintf(game->best_scores[j], "XXX : 0");
-    }
-  }
+  if (game->scores == NULL) return;
 
-  fclose(fp);
+  int rank = score_store_insert(game->scores, pseudo, score);
+  if (rank > 0) printf("Score %d ranked %d of %d\n", score, rank, game->scores->count);
 }
\ No newline at end of file
@@ -3,12 +3,22 @@
 
 #include <stdbool.h>
 
+#include "arena.h"
 #include "bonus.h"
+#include "capture.h"
+#include "counters.h"
 #include "game_state.h"
 #include "window.h"
 #include "player.h"
+#include "replay.h"
 #include "map.h"
+#include "metrics.h"
 #include "ghost.h"
+#include "ghost_house.h"
+#include "io_worker.h"
+#include "score_store.h"
+#include "simulation.h"
+#include "string_builder.h"
 
 #define GHOST_AMOUNT 4
 #define START_BUTTON_ANIMATION_SPEED 20
@@ -16,7 +26,9 @@
 #define NUMBER_OF_DOT 205
 #define NUMBER_OF_POWER_PELLET 4
 
-#define SCORE_FILE "../data/scores.txt"
+#define SCORE_FILE "../data/scores.bin"
+// text file of the older versions, imported once into SCORE_FILE
+#define LEGACY_SCORE_FILE "../data/scores.txt"
 #define LEVEL_FILE "../data/level.txt"
 
 #define FONT_FILE "../assets/fonts/font.ttf"
@@ -38,39 +50,73 @@
 #define PRESS_KEY_DELAY 0.001f
 
 #define PSEUDO_MAX_LENGTH 10
+#define PSEUDO_DEFAULT "ANON"
+
+#define BEST_SCORES_COUNT 5
+
+// scratch memory of a frame, the text of the HUD
+#define FRAME_ARENA_SIZE (64 * 1024)
 
 typedef struct {
     int width, height;
     int scale;
     int score, level;
     Window *window;
+    // false when shared with other games, see game_create_shared
+    bool owns_window;
     GameState state;
     Player *player;
     Map *map;
     Ghost *ghosts[GHOST_AMOUNT];
-    SDL_Texture *heart_texture;
-    Bonus *bonus;
+    GhostHouse *ghost_house;
+    Sprite *heart_sprite;
+    // every bonus on the map, sharing one sprite
+    Pool *bonuses;
+    Sprite *bonus_sprite;
     bool is_paused, is_key_pressed;
     int start_button_animation_frame;
-    char **best_scores;
-    char *pseudo;
-    int pseudo_index;
+    // every score ever made, the best ones ready to draw
+    ScoreStore *scores;
+    // writes the scores, the game never waits for the disk
+    IoWorker *io;
+    char pseudo_buffer[PSEUDO_MAX_LENGTH + 1];
+    StringBuilder pseudo;
     int number_of_dot, number_of_power_pellet;
     SDL_KeyboardEvent last_key;
     const Uint8 *keys;
     float key_press_timer;
     bool display_fps;
+    // counters of the last frame, see counters.h
+    bool display_counters;
     int fps;
+    float interpolation;
+    // reset at the start of every tick, nothing in it outlives the next one
+    Arena *frame_arena;
+    Capture *capture;
+    // live values for the monitors, NULL when not published
+    Metrics *metrics;
+    // keys recorded or played tick by tick, NULL for the keyboard alone
+    Replay *replay;
 } Game;
 
 /**
  * @brief Create a Game object
  * @param width Game width
  * @param height Game height
- * @param scale Game scale
+ * @param scale Initial window size, in multiples of width and height
+ * @param backend Render backend of the window
  * @return Game*
  */
-Game *game_create(int width, int height, int scale);
+Game *game_create(int width, int height, int scale, RenderBackend backend);
+
+/**
+ * @brief Create a Game object for the game logic alone, on a window shared
+ * with other games: no HUD, scores, capture, metrics nor replay
+ * @param window Window the sprites are loaded from, destroyed by the caller
+ * after every game on it
+ * @return Game*, NULL on error
+ */
+Game *game_create_shared(Window *window);
 
 /**
  * @brief Destroy the Game object
@@ -84,6 +130,14 @@ void game_destroy(Game *game);
  */
 void game_run(Game *game);
 
+/**
+ * @brief Run a fixed number of frames, one update each, as fast as possible
+ * and without reading any input
+ * @param game Game
+ * @param frames Number of frames
+ */
+void game_run_frames(Game *game, int frames);
+
 /**
  * @brief Update the game
  * @param game Game
@@ -127,6 +181,12 @@ void game_reset(Game *game);
  */
 void display_fps(Game *game);
 
+/**
+ * @brief Display the counters of the last frame
+ * @param game Game
+ */
+void display_counters(Game *game);
+
 /**
  * @brief Display the menu screen
  * @param game Game
@@ -215,25 +275,13 @@ void display_game_over(Game *game);
 void display_insert_name(Game *game);
 
 /**
- * @brief Insert a score in the best scores
+ * @brief Insert a score in the best scores, saved in the background
  * @param game Game
  * @param score Score
  * @param pseudo Pseudo
  */
 void game_insert_score(Game *game, int score, char *pseudo);
 
-/**
- * @brief Save the best scores
- * @param game Game
- */
-void game_save_best_scores(Game *game);
-
-/**
- * @brief Load the best scores
- * @param game Game
- */
-void game_load_best_scores(Game *game);
-
 /**
  * @brief Global input
  * @param game Game
@@ -1,5 +1,6 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <unistd.h>
 
@@ -10,28 +11,43 @@
 #include "map.h"
 #include "map_tile.h"
 #include "player.h"
+#include "movement.h"
+#include "simulation.h"
+
+static const int ghost_dx[] = { 0, 0, -1, 1, 0 };
+static const int ghost_dy[] = { -1, 1, 0, 0, 0 };
+static const GhostDirection ghost_reverse[] = {
+  GHOST_DOWN, GHOST_UP, GHOST_RIGHT, GHOST_LEFT, GHOST_NULL
+};
 
 Ghost *ghost_create(Window *window, int ghost_number)
 {
   Ghost *ghost = malloc(sizeof(Ghost));
   if (ghost == NULL) return NULL;
 
+  // each ghost waits in its own slot of the ghost house
+  ghost->spawn_x = GHOST_SPAWN_X * MAP_TILE_SIZE;
+  ghost->spawn_y = (GHOST_HOUSE_SLOT_Y + ghost_number - 1) * MAP_TILE_SIZE;
+
   ghost_move_to_spawn(ghost);
   ghost->speed = GHOST_SPEED;
   ghost->direction = GHOST_UP;
   ghost->next_direction = GHOST_UP;
   ghost->animation_frame = 0;
-  ghost->start_time = SDL_GetTicks() / 1000.0f;
+  ghost->start_time = simulation_time();
   ghost->is_active = false;
   ghost->moving = false;
   ghost->is_scared = false;
+  ghost->is_eaten = false;
+  ghost->is_controlled = false;
+  ghost->wanted_direction = GHOST_NULL;
 
-  char *sprite_path = malloc(sizeof(char) * 100);
-  sprintf(sprite_path, GHOST_TEXTURE_FILE, ghost_number);
+  char sprite_path[ASSET_MANAGER_PATH_MAX];
+  snprintf(sprite_path, sizeof(sprite_path), GHOST_TEXTURE_FILE, ghost_number);
 
-  // Load ghost sprite
-  window_load_texture(window, sprite_path, &ghost->sprite);
-  window_load_texture(window, GHOST_SCARED_TEXTURE_FILE, &ghost->scared_sprite);
+  // Load ghost sprites, the scared one is shared by every ghost
+  ghost->sprite = window_load_sprite(window, sprite_path);
+  ghost->scared_sprite = window_load_sprite(window, GHOST_SCARED_TEXTURE_FILE);
 
   return ghost;
 }
@@ -40,20 +56,32 @@ void ghost_destroy(Ghost *ghost)
 {
   if (ghost == NULL) return;
 
-  // Free ghost sprite
-  SDL_DestroyTexture(ghost->sprite);
-  SDL_DestroyTexture(ghost->scared_sprite);
+  // Release ghost sprites
+  asset_manager_release(ghost->sprite);
+  asset_manager_release(ghost->scared_sprite);
 
   // Free ghost
   free(ghost);
 }
 
-void ghost_render(Ghost *ghost, Window *window)
+void ghost_render(Ghost *ghost, Window *window, float alpha)
 {
-  SDL_Rect rect = {ghost->x, ghost->y, GHOST_SIZE, GHOST_SIZE};
+  window_set_layer(window, RENDER_LAYER_ENTITIES);
+
+  int x = movement_interpolate(ghost->prev_x, ghost->x, alpha);
+  int y = movement_interpolate(ghost->prev_y, ghost->y, alpha);
+  SDL_Rect rect = {x, y, GHOST_SIZE, GHOST_SIZE};
   SDL_Rect src = {GHOST_SIZE * (ghost->animation_frame % GHOST_ANIMATION_COUNT), 0, GHOST_SIZE, GHOST_SIZE};
 
-  if (ghost->is_scared) {
+  if (ghost->is_eaten) {
+    // only the eyes are left, looking where the ghost is heading
+    int look_x = ghost_dx[ghost->direction] * 2;
+    int look_y = ghost_dy[ghost->direction] * 2;
+    window_draw_circle(window, x + 10, y + 12, 5, WHITE_COLOR);
+    window_draw_circle(window, x + 22, y + 12, 5, WHITE_COLOR);
+    window_draw_circle(window, x + 10 + look_x, y + 12 + look_y, 2, BLUE_COLOR);
+    window_draw_circle(window, x + 22 + look_x, y + 12 + look_y, 2, BLUE_COLOR);
+  } else if (ghost->is_scared) {
     window_draw_sprite(window, ghost->scared_sprite, &src, &rect, 0.0, SDL_FLIP_NONE);
   } else {
     window_draw_sprite(window, ghost->sprite, &src, &rect, 0.0, SDL_FLIP_NONE);
@@ -62,11 +90,11 @@ void ghost_render(Ghost *ghost, Window *window)
 
 void ghost_update(Map *map, Ghost *ghost, Player *player)
 {
-  // Check if ghost is scared
-  if (player->invincible) ghost->is_scared = true;
+  // Check if ghost is scared, eyes are never scared
+  if (player->invincible && !ghost->is_eaten) ghost->is_scared = true;
   else ghost->is_scared = false;
 
-  float current_time = SDL_GetTicks() / 1000.0f;
+  float current_time = simulation_time();
 
   // Update ghost animation
   if (!ghost->is_scared && current_time - ghost->start_time > GHOST_ANIMATION_CAP) {
@@ -86,151 +114,81 @@ void ghost_update(Map *map, Ghost *ghost, Player *player)
     }
   }
 
-  // Update ghost position
-  int next_x = ghost->next_x / MAP_TILE_SIZE;
-  int next_y = ghost->next_y / MAP_TILE_SIZE;
-
-  // Get next tiles
-  Tiles next_up = map_get_tile(map, next_x, next_y - 1);
-  Tiles next_down = map_get_tile(map, next_x, next_y + 1);
-  Tiles next_left = map_get_tile(map, next_x - 1, next_y);
-  Tiles next_right = map_get_tile(map, next_x + 1, next_y);
-
-  int table[4] = {0, 0, 0, 0};
-
-  // Check accessible tiles
-  if (tile_is_accessible(next_up)) table[0] = 1;
-  if (tile_is_accessible(next_down)) table[1] = 1;
-  if (tile_is_accessible(next_left)) table[2] = 1;
-  if (tile_is_accessible(next_right)) table[3] = 1;
-
-  // Remove current direction from table
-  table[ghost->direction] = 0;
-
-  // Number of accessible tiles
-  int sum = table[0] + table[1] + table[2] + table[3];
-
-  // Update ghost direction
-  if (!ghost->moving && sum > 1) {
-    ghost->next_direction = ghost_get_direction(map, ghost, player);
-
-    switch (ghost->next_direction)
-    {
-      case GHOST_UP:
-        next_y--;
-        break;
-      case GHOST_DOWN:
-        next_y++;
-        break;
-      case GHOST_LEFT:
-        next_x--;
-        break;
-      case GHOST_RIGHT:
-        next_x++;
-        break;
-      default:
-        break;
-    }
+  // Move ghost
+  ghost_move(map, ghost, player);
+}
 
-    Tiles next_tile = map_get_tile(map, next_x, next_y);
-
-    if (tile_is_accessible(next_tile)) {
-      ghost->direction = ghost->next_direction;
-      ghost->moving = true;
-      ghost->next_x = next_x * MAP_TILE_SIZE;
-      ghost->next_y = next_y * MAP_TILE_SIZE;
-    } else {
-      ghost->next_x = ghost->x;
-      ghost->next_y = ghost->y;
-      ghost->moving = false;
-    }
-  } else if (sum == 1) {
-    switch (ghost->next_direction)
-    {
-      case GHOST_UP:
-        next_y--;
-        break;
-      case GHOST_DOWN:
-        next_y++;
-        break;
-      case GHOST_LEFT:
-        next_x--;
-        break;
-      case GHOST_RIGHT:
-        next_x++;
-        break;
-      default:
-        break;
-    }
+bool ghost_choose_next(Map *map, Ghost *ghost, Player *player)
+{
+  // Eyes are back in the ghost house
+  if (
+    ghost->is_eaten
+    && ghost->next_x == GHOST_SPAWN_X * MAP_TILE_SIZE
+    && ghost->next_y == GHOST_SPAWN_Y * MAP_TILE_SIZE
+  ) {
+    ghost_revive(ghost);
+  }
 
-    // Check if the ghost is in an angle
-    if (table[0] == 0 && table[2] == 1 && ghost->direction == GHOST_UP) {
-      ghost->next_direction = GHOST_LEFT;
-      next_x--;
-    } 
-    if (table[0] == 0 && table[3] == 1 && ghost->direction == GHOST_UP) {
-      ghost->next_direction = GHOST_RIGHT;
-      next_x++;
-    } 
-    if (table[1] == 0 && table[2] == 1 && ghost->direction == GHOST_DOWN) {
-      ghost->next_direction = GHOST_LEFT;
-      next_x--;
-    } 
-    if (table[1] == 0 && table[3] == 1 && ghost->direction == GHOST_DOWN) {
-      ghost->next_direction = GHOST_RIGHT;
-      next_x++;
-    } 
-    if (table[2] == 0 && table[0] == 1 && ghost->direction == GHOST_LEFT) {
-      ghost->next_direction = GHOST_UP;
-      next_y--;
-    } 
-    if (table[2] == 0 && table[1] == 1 && ghost->direction == GHOST_LEFT) {
-      ghost->next_direction = GHOST_DOWN;
-      next_y++;
-    } 
-    if (table[3] == 0 && table[0] == 1 && ghost->direction == GHOST_RIGHT) {
-      ghost->next_direction = GHOST_UP;
-      next_y--;
-    }
-    if (table[3] == 0 && table[1] == 1 && ghost->direction == GHOST_RIGHT) {
-      ghost->next_direction = GHOST_DOWN;
-      next_y++;
-    }
+  GhostDirection direction = ghost_get_direction(map, ghost, player);
 
-    Tiles next_tile = map_get_tile(map, next_x, next_y);
-
-    if (tile_is_accessible(next_tile)) {
-      ghost->direction = ghost->next_direction;
-      ghost->moving = true;
-      ghost->next_x = next_x * MAP_TILE_SIZE;
-      ghost->next_y = next_y * MAP_TILE_SIZE;
-    } else {
-      ghost->next_x = ghost->x;
-      ghost->next_y = ghost->y;
-      ghost->moving = false;
-    }
+  // no way home from here, the eyes would stay there forever, they are sent back straight
+  if (direction == GHOST_NULL && ghost->is_eaten) {
+    ghost_set_position(ghost, GHOST_SPAWN_X * MAP_TILE_SIZE, GHOST_SPAWN_Y * MAP_TILE_SIZE);
+    ghost->moving = false;
+    return false;
   }
 
-  // Move ghost
-  ghost_move(ghost);  
+  ghost->next_direction = direction;
+  if (direction == GHOST_NULL) {
+    ghost->moving = false;
+    return false;
+  }
+
+  ghost->direction = direction;
+  ghost->next_x += ghost_dx[direction] * MAP_TILE_SIZE;
+  ghost->next_y += ghost_dy[direction] * MAP_TILE_SIZE;
+  ghost->moving = true;
+  return true;
 }
 
 void ghost_reset(Ghost *ghost)
 {
   ghost_move_to_spawn(ghost);
-  ghost->speed = GHOST_SPEED;
   ghost->animation_frame = 0;
-  ghost->start_time = SDL_GetTicks() / 1000.0f;
+  ghost->start_time = simulation_time();
   ghost->is_active = false;
   ghost->moving = false;
   ghost->is_scared = false;
+  ghost->is_eaten = false;
 }
 
-void ghost_set_speed(Ghost *ghost, int speed)
+void ghost_set_position(Ghost *ghost, int x, int y)
+{
+  ghost->x = x;
+  ghost->y = y;
+  ghost->prev_x = x;
+  ghost->prev_y = y;
+  ghost->next_x = x;
+  ghost->next_y = y;
+  ghost->pos_x = FIXED_FROM_INT(x);
+  ghost->pos_y = FIXED_FROM_INT(y);
+}
+
+void ghost_set_speed(Ghost *ghost, fixed_t speed)
 {
   ghost->speed = speed;
 }
 
+fixed_t ghost_speed_for_level(int level)
+{
+  return movement_speed_for_level(
+    GHOST_SPEED,
+    GHOST_SPEED_LEVEL_STEP,
+    GHOST_SPEED_MAX,
+    level
+  );
+}
+
 void ghost_set_direction(Ghost *ghost, GhostDirection direction)
 {
   ghost->direction = direction;
@@ -246,14 +204,23 @@ void ghost_deactivate(Ghost *ghost)
   ghost->is_active = false;
 }
 
+void ghost_eat(Ghost *ghost)
+{
+  ghost->is_eaten = true;
+  ghost->is_scared = false;
+}
+
+void ghost_revive(Ghost *ghost)
+{
+  ghost->is_eaten = false;
+  ghost->animation_frame = 0;
+}
+
 void ghost_move_to_spawn(Ghost *ghost)
 {
-  ghost->x = GHOST_SPAWN_X * MAP_TILE_SIZE;
-  ghost->y = GHOST_SPAWN_Y * MAP_TILE_SIZE;
+  ghost_set_position(ghost, ghost->spawn_x, ghost->spawn_y);
   ghost->direction = GHOST_UP;
   ghost->next_direction = GHOST_UP;
-  ghost->next_x = ghost->x;
-  ghost->next_y = ghost->y;
 }
 
 bool ghost_check_collision(Ghost *ghost, Player *player)
@@ -266,65 +233,86 @@ bool ghost_check_collision(Ghost *ghost, Player *player)
   return distance < MAP_TILE_SIZE/2;
 }
 
-void ghost_move(Ghost *ghost)
+void ghost_move(Map *map, Ghost *ghost, Player *player)
 {
-  if (ghost->x == ghost->next_x && ghost->y == ghost->next_y) {
-    ghost->moving = false;
-  } else {
-    switch (ghost->direction)
-    {
-      case GHOST_UP:
-        ghost->y -= ghost->speed;
-        break;
-      case GHOST_DOWN:
-        ghost->y += ghost->speed;
-        break;
-      case GHOST_LEFT:
-        ghost->x -= ghost->speed;
-        break;
-      case GHOST_RIGHT:
-        ghost->x += ghost->speed;
-        break;
-      default:
-        break;
+  fixed_t budget = ghost->is_eaten ? GHOST_EYES_SPEED : ghost->speed;
+
+  // leftover distance is carried past tile centers, whatever the speed is
+  while (budget > 0) {
+    fixed_t target_x = FIXED_FROM_INT(ghost->next_x);
+    fixed_t target_y = FIXED_FROM_INT(ghost->next_y);
+
+    if (ghost->pos_x == target_x && ghost->pos_y == target_y) {
+      if (!ghost_choose_next(map, ghost, player)) break;
+      target_x = FIXED_FROM_INT(ghost->next_x);
+      target_y = FIXED_FROM_INT(ghost->next_y);
     }
+
+    budget = movement_advance(&ghost->pos_x, &ghost->pos_y, target_x, target_y, budget);
   }
+
+  ghost->x = FIXED_TO_INT(ghost->pos_x);
+  ghost->y = FIXED_TO_INT(ghost->pos_y);
+}
+
+GhostDirection ghost_get_home_direction(Map *map, Ghost *ghost)
+{
+  GhostDirection best = GHOST_NULL;
+  int x = ghost->next_x / MAP_TILE_SIZE;
+  int y = ghost->next_y / MAP_TILE_SIZE;
+  int best_distance = map_get_distance(map, x, y);
+  // off the paths to the house, any neighbour on one of them is closer
+  if (best_distance == MAP_DISTANCE_UNREACHABLE) best_distance = INT_MAX;
+
+  for (GhostDirection direction = GHOST_UP; direction < GHOST_NULL; direction++) {
+    int distance = map_get_distance(map, x + ghost_dx[direction], y + ghost_dy[direction]);
+    if (distance != MAP_DISTANCE_UNREACHABLE && distance < best_distance) {
+      best_distance = distance;
+      best = direction;
+    }
+  }
+
+  return best;
 }
 
 GhostDirection ghost_get_direction(Map *map, Ghost *ghost, Player *player) 
 {
-  GhostDirection directions[3];
+  GhostDirection directions[4];
   int num_directions = 0;
 
-  // Add directions to array based on ghost direction
-  switch (ghost->direction)
-  {
-    case GHOST_UP:
-      directions[num_directions++] = GHOST_LEFT;
-      directions[num_directions++] = GHOST_RIGHT;
-      directions[num_directions++] = GHOST_DOWN;
-      break;
-    case GHOST_DOWN:
-      directions[num_directions++] = GHOST_LEFT;
-      directions[num_directions++] = GHOST_UP;
-      directions[num_directions++] = GHOST_RIGHT;
-      break;
-    case GHOST_LEFT:
-      directions[num_directions++] = GHOST_DOWN;
-      directions[num_directions++] = GHOST_UP;
-      directions[num_directions++] = GHOST_RIGHT;
-      break;
-    case GHOST_RIGHT:
-      directions[num_directions++] = GHOST_UP;
-      directions[num_directions++] = GHOST_DOWN;
-      directions[num_directions++] = GHOST_LEFT;
-      break;
-    default:
-      break;
+  int x = ghost->next_x / MAP_TILE_SIZE;
+  int y = ghost->next_y / MAP_TILE_SIZE;
+  GhostDirection reverse = ghost_reverse[ghost->direction];
+
+  // Eyes follow the precomputed path back to the ghost house
+  if (ghost->is_eaten) return ghost_get_home_direction(map, ghost);
+
+  // A player picks the way, the ghost goes on while the way is free
+  if (ghost->is_controlled) {
+    GhostDirection wanted = ghost->wanted_direction;
+    if (wanted != GHOST_NULL && tile_is_accessible(map_get_tile(map, x + ghost_dx[wanted], y + ghost_dy[wanted]))) {
+      return wanted;
+    }
+    Tiles tile = map_get_tile(map, x + ghost_dx[ghost->direction], y + ghost_dy[ghost->direction]);
+    return tile_is_accessible(tile) ? ghost->direction : GHOST_NULL;
+  }
+
+  // Add accessible directions, ghosts can't turn back
+  for (GhostDirection direction = GHOST_UP; direction < GHOST_NULL; direction++) {
+    Tiles tile = map_get_tile(map, x + ghost_dx[direction], y + ghost_dy[direction]);
+    if (direction != reverse && tile_is_accessible(tile)) {
+      directions[num_directions++] = direction;
+    }
+  }
+
+  // Dead end, the only way out is back
+  if (num_directions == 0) {
+    Tiles tile = map_get_tile(map, x + ghost_dx[reverse], y + ghost_dy[reverse]);
+    return reverse != GHOST_NULL && tile_is_accessible(tile) ? reverse : GHOST_NULL;
   }
 
   // Get random direction
-  int rand_direction = rand() % num_directions;
+  int rand_direction = simulation_random() % num_directions;
 
   return directions[rand_direction];
 }
\ No newline at end of file
@@ -7,13 +7,20 @@
 #include "window.h"
 #include "map.h"
 #include "player.h"
+#include "fixed.h"
 
-#define GHOST_SPEED 4
+#define GHOST_SPEED FIXED_FROM_INT(4)
+#define GHOST_SPEED_LEVEL_STEP FIXED_FROM_FLOAT(0.35f)
+#define GHOST_SPEED_MAX FIXED_FROM_FLOAT(6.5f)
 #define GHOST_SIZE 32
 
+#define GHOST_EYES_SPEED FIXED_FROM_INT(8)
+
 #define GHOST_SPAWN_X 17
 #define GHOST_SPAWN_Y 13
 
+#define GHOST_HOUSE_SLOT_Y 12
+
 #define GHOST_ANIMATION_COUNT 6
 #define GHOST_ANIMATION_CAP UPDATE_CAP / GHOST_ANIMATION_COUNT
 
@@ -31,15 +38,23 @@ typedef enum {
 typedef struct {
   int x, y;
   int next_x, next_y;
-  int speed;
+  // position at the previous tick, rendering interpolates from it
+  int prev_x, prev_y;
+  int spawn_x, spawn_y;
+  fixed_t pos_x, pos_y;
+  fixed_t speed;
   float start_time;
   int animation_frame;
   GhostDirection direction, next_direction;
-  SDL_Texture *sprite;
-  SDL_Texture *scared_sprite;
+  Sprite *sprite;
+  Sprite *scared_sprite;
   bool moving;
   bool is_active;
   bool is_scared;
+  bool is_eaten;
+  // moved by a player over the network, toward wanted_direction
+  bool is_controlled;
+  GhostDirection wanted_direction;
 } Ghost;
 
 /**
@@ -65,17 +80,29 @@ void ghost_destroy(Ghost *ghost);
 void ghost_update(Map *map, Ghost *ghost, Player *player);
 
 /**
- * @brief Render the ghost
+ * @brief Render the ghost between its last two positions
  * @param ghost The ghost to render
  * @param window The window to render the ghost in
+ * @param alpha Fraction of a tick elapsed since the last update, from 0 to 1
  */
-void ghost_render(Ghost *ghost, Window *window);
+void ghost_render(Ghost *ghost, Window *window, float alpha);
 
 /**
- * @brief Move the ghost
+ * @brief Move the ghost by its speed, turning at tile centers
+ * @param map The map to move the ghost in
  * @param ghost The ghost to move
+ * @param player The player the ghost is chasing
+ */
+void ghost_move(Map *map, Ghost *ghost, Player *player);
+
+/**
+ * @brief Choose the next tile once the ghost reached its target
+ * @param map The map to choose the tile in
+ * @param ghost The ghost to choose the tile for
+ * @param player The player the ghost is chasing
+ * @return True if the ghost keeps moving, false if it is blocked
  */
-void ghost_move(Ghost *ghost);
+bool ghost_choose_next(Map *map, Ghost *ghost, Player *player);
 
 /**
  * @brief Reset the ghost
@@ -92,14 +119,23 @@ void ghost_reset(Ghost *ghost);
 bool ghost_check_collision(Ghost *ghost, Player *player);
 
 /**
- * @brief Get the direction of the ghost
+ * @brief Get the direction of the ghost at the center of its target tile
  * @param map The map to get the direction in
  * @param ghost The ghost to get the direction of
  * @param player The player to get the direction towards
- * @return The direction of the ghost
+ * @return The direction of the ghost, GHOST_NULL if it is stuck
  */
 GhostDirection ghost_get_direction(Map *map, Ghost *ghost, Player *player);
 
+/**
+ * @brief Get the direction leading the eyes back to the ghost house
+ * @param map The map, with its distances built towards the ghost house
+ * @param ghost The eaten ghost
+ * @return The direction of the ghost, GHOST_NULL if it is already home or
+ * no neighbour is closer to it
+ */
+GhostDirection ghost_get_home_direction(Map *map, Ghost *ghost);
+
 /**
  * @brief Activate the ghost
  * @param ghost The ghost to activate
@@ -113,17 +149,45 @@ void ghost_activate(Ghost *ghost);
 void ghost_deactivate(Ghost *ghost);
 
 /**
- * @brief Move the ghost to the spawn
+ * @brief Turn the ghost into eyes going back to the ghost house
+ * @param ghost The ghost eaten by the player
+ */
+void ghost_eat(Ghost *ghost);
+
+/**
+ * @brief Turn the eyes back into a ghost once they reached the ghost house
+ * @param ghost The ghost to revive
+ */
+void ghost_revive(Ghost *ghost);
+
+/**
+ * @brief Move the ghost to its slot in the ghost house
  * @param ghost The ghost to move
  */
 void ghost_move_to_spawn(Ghost *ghost);
 
+/**
+ * @brief Place the ghost on a pixel position, without interpolating from
+ * the previous one
+ * @param ghost The ghost to place
+ * @param x X position
+ * @param y Y position
+ */
+void ghost_set_position(Ghost *ghost, int x, int y);
+
 /**
  * @brief Set the speed of the ghost
  * @param ghost The ghost to set the speed of
- * @param speed The speed to set the ghost to
+ * @param speed The speed to set the ghost to (fixed point)
+ */
+void ghost_set_speed(Ghost *ghost, fixed_t speed);
+
+/**
+ * @brief Get the speed of the ghosts for a level
+ * @param level The level, starting at 1
+ * @return The speed (fixed point)
  */
-void ghost_set_speed(Ghost *ghost, int speed);
+fixed_t ghost_speed_for_level(int level);
 
 /**
  * @brief Set the direction of the ghost
@@ -0,0 +1,97 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "ghost_house.h"
+#include "ghost.h"
+#include "map.h"
+
+GhostHouse *ghost_house_create(void)
+{
+  GhostHouse *house = malloc(sizeof(GhostHouse));
+  if (house == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  memset(house, 0, sizeof(GhostHouse));
+  house->timeout = GHOST_HOUSE_TIMEOUT;
+
+  return house;
+}
+
+void ghost_house_destroy(GhostHouse *house)
+{
+  free(house);
+}
+
+void ghost_house_reset(GhostHouse *house, Map *map, Ghost **ghosts, int level)
+{
+  static const int level_1_limits[] = GHOST_HOUSE_LEVEL_1_LIMITS;
+  static const int level_2_limits[] = GHOST_HOUSE_LEVEL_2_LIMITS;
+  static const int level_3_limits[] = GHOST_HOUSE_LEVEL_3_LIMITS;
+
+  const int *limits = level_3_limits;
+  if (level == 1) limits = level_1_limits;
+  if (level == 2) limits = level_2_limits;
+
+  memcpy(house->dot_limits, limits, sizeof(house->dot_limits));
+  memset(house->dot_counters, 0, sizeof(house->dot_counters));
+  house->idle_ticks = 0;
+  house->timeout = level < GHOST_HOUSE_FAST_TIMEOUT_LEVEL
+    ? GHOST_HOUSE_TIMEOUT
+    : GHOST_HOUSE_FAST_TIMEOUT;
+
+  // eyes find their way back with the distances to the house
+  map_build_distances(map, GHOST_SPAWN_X, GHOST_SPAWN_Y);
+
+  for (int i = 0; i < GHOST_HOUSE_CAPACITY; i++) {
+    ghost_reset(ghosts[i]);
+  }
+}
+
+void ghost_house_restart(GhostHouse *house, Ghost **ghosts)
+{
+  static const int restart_limits[] = GHOST_HOUSE_RESTART_LIMITS;
+
+  memcpy(house->dot_limits, restart_limits, sizeof(house->dot_limits));
+  memset(house->dot_counters, 0, sizeof(house->dot_counters));
+  house->idle_ticks = 0;
+
+  for (int i = 0; i < GHOST_HOUSE_CAPACITY; i++) {
+    ghost_reset(ghosts[i]);
+  }
+}
+
+int ghost_house_next(GhostHouse *house, Ghost **ghosts)
+{
+  for (int i = 0; i < GHOST_HOUSE_CAPACITY; i++) {
+    if (!ghosts[i]->is_active) return i;
+  }
+  return -1;
+}
+
+void ghost_house_dot_eaten(GhostHouse *house, Ghost **ghosts)
+{
+  house->idle_ticks = 0;
+
+  // only the next ghost to leave counts the dots
+  int next = ghost_house_next(house, ghosts);
+  if (next >= 0) house->dot_counters[next]++;
+}
+
+void ghost_house_update(GhostHouse *house, Ghost **ghosts)
+{
+  int next = ghost_house_next(house, ghosts);
+  if (next < 0) return;
+
+  house->idle_ticks++;
+
+  // release when the dots are eaten, or when the player stopped eating dots
+  if (
+    house->dot_counters[next] >= house->dot_limits[next]
+    || house->idle_ticks >= house->timeout
+  ) {
+    ghost_activate(ghosts[next]);
+    house->idle_ticks = 0;
+  }
+}
\ No newline at end of file
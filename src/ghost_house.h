@@ -0,0 +1,80 @@
+# ifndef GHOST_HOUSE_H
+# define GHOST_HOUSE_H
+
+#include <stdbool.h>
+
+#include "window.h"
+#include "map.h"
+#include "ghost.h"
+
+#define GHOST_HOUSE_CAPACITY 4
+
+#define GHOST_HOUSE_TIMEOUT (int) (4 * FPS)
+#define GHOST_HOUSE_FAST_TIMEOUT (int) (3 * FPS)
+#define GHOST_HOUSE_FAST_TIMEOUT_LEVEL 5
+
+// dots to eat before each ghost leaves, counted once it is the next to leave
+#define GHOST_HOUSE_LEVEL_1_LIMITS { 0, 0, 30, 60 }
+#define GHOST_HOUSE_LEVEL_2_LIMITS { 0, 0, 0, 50 }
+#define GHOST_HOUSE_LEVEL_3_LIMITS { 0, 0, 0, 0 }
+// after a death the ghosts leave at 7, 17 and 32 dots
+#define GHOST_HOUSE_RESTART_LIMITS { 0, 7, 10, 15 }
+
+typedef struct {
+  int dot_limits[GHOST_HOUSE_CAPACITY];
+  int dot_counters[GHOST_HOUSE_CAPACITY];
+  int idle_ticks;
+  int timeout;
+} GhostHouse;
+
+/**
+ * @brief Create a GhostHouse object
+ * @return GhostHouse*
+ */
+GhostHouse *ghost_house_create(void);
+
+/**
+ * @brief Destroy the GhostHouse object
+ * @param house GhostHouse
+ */
+void ghost_house_destroy(GhostHouse *house);
+
+/**
+ * @brief Put every ghost back in the house for a new level
+ * @param house GhostHouse
+ * @param map Map, its distances are built towards the house for the eyes
+ * @param ghosts Ghosts
+ * @param level Level
+ */
+void ghost_house_reset(GhostHouse *house, Map *map, Ghost **ghosts, int level);
+
+/**
+ * @brief Put every ghost back in the house after the player died
+ * @param house GhostHouse
+ * @param ghosts Ghosts
+ */
+void ghost_house_restart(GhostHouse *house, Ghost **ghosts);
+
+/**
+ * @brief Count a dot eaten by the player
+ * @param house GhostHouse
+ * @param ghosts Ghosts
+ */
+void ghost_house_dot_eaten(GhostHouse *house, Ghost **ghosts);
+
+/**
+ * @brief Release the next ghost once it reached its dot limit or timed out
+ * @param house GhostHouse
+ * @param ghosts Ghosts
+ */
+void ghost_house_update(GhostHouse *house, Ghost **ghosts);
+
+/**
+ * @brief Get the next ghost to leave the house
+ * @param house GhostHouse
+ * @param ghosts Ghosts
+ * @return int, -1 if the house is empty
+ */
+int ghost_house_next(GhostHouse *house, Ghost **ghosts);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdlib.h>
+
+#include "glyph_atlas.h"
+#include "counters.h"
+#include "sprite_batch.h"
+
+static int glyph_atlas_index(char c)
+{
+  int index = (unsigned char) c - GLYPH_ATLAS_FIRST_CHAR;
+  if (index < 0 || index >= GLYPH_ATLAS_CHAR_COUNT) index = '?' - GLYPH_ATLAS_FIRST_CHAR;
+  return index;
+}
+
+GlyphAtlas *glyph_atlas_create(SDL_Renderer *renderer, TTF_Font *font, int size)
+{
+  if (font == NULL) return NULL;
+
+  GlyphAtlas *atlas = malloc(sizeof(GlyphAtlas));
+  if (atlas == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  atlas->font = font;
+  atlas->size = size;
+  atlas->height = TTF_FontHeight(font);
+  atlas->sheet = (Sprite) { NULL, NULL, { 0, 0, 0, 0 } };
+
+  SDL_Surface *surfaces[GLYPH_ATLAS_CHAR_COUNT];
+  SDL_Color white = { 255, 255, 255, 255 };
+  int x = 0, y = 0, row_height = 0;
+
+  // rasterize every glyph once and place them on rows
+  for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; i++) {
+    Uint16 c = GLYPH_ATLAS_FIRST_CHAR + i;
+    Glyph *glyph = &atlas->glyphs[i];
+
+    glyph->advance = 0;
+    glyph->src = (SDL_Rect) { 0, 0, 0, 0 };
+    TTF_GlyphMetrics(font, c, NULL, NULL, NULL, NULL, &glyph->advance);
+
+    surfaces[i] = TTF_RenderGlyph_Blended(font, c, white);
+    if (surfaces[i] == NULL) continue;
+
+    if (x + surfaces[i]->w > GLYPH_ATLAS_WIDTH) {
+      x = 0;
+      y += row_height + GLYPH_ATLAS_PADDING;
+      row_height = 0;
+    }
+    glyph->src = (SDL_Rect) { x, y, surfaces[i]->w, surfaces[i]->h };
+    x += surfaces[i]->w + GLYPH_ATLAS_PADDING;
+    if (surfaces[i]->h > row_height) row_height = surfaces[i]->h;
+  }
+
+  atlas->sheet.rect.w = GLYPH_ATLAS_WIDTH;
+  atlas->sheet.rect.h = y + row_height;
+
+  SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(
+    0,
+    atlas->sheet.rect.w,
+    atlas->sheet.rect.h,
+    32,
+    SDL_PIXELFORMAT_RGBA32
+  );
+
+  for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; i++) {
+    if (surfaces[i] == NULL) continue;
+    if (sheet != NULL) {
+      // copy the coverage as is instead of blending it on the empty sheet
+      SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(surfaces[i], NULL, sheet, &atlas->glyphs[i].src);
+    }
+    SDL_FreeSurface(surfaces[i]);
+  }
+
+  if (sheet == NULL) {
+    fprintf(stderr, "[glyph_atlas_create] Erreur lors de la création de la surface : %s\n", SDL_GetError());
+    free(atlas);
+    return NULL;
+  }
+
+  if (renderer == NULL) {
+    // software rendering samples the sheet itself
+    atlas->sheet.surface = sheet;
+  } else {
+    atlas->sheet.texture = SDL_CreateTextureFromSurface(renderer, sheet);
+    COUNTER_INC(COUNTER_TEXTURES_CREATED);
+    SDL_FreeSurface(sheet);
+  }
+  if (atlas->sheet.texture == NULL && atlas->sheet.surface == NULL) {
+    fprintf(stderr, "[glyph_atlas_create] Erreur lors de la création de la texture : %s\n", SDL_GetError());
+    free(atlas);
+    return NULL;
+  }
+  if (atlas->sheet.texture != NULL) SDL_SetTextureBlendMode(atlas->sheet.texture, SDL_BLENDMODE_BLEND);
+
+  // kerning of every pair, looked up while drawing
+  for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; i++) {
+    for (int j = 0; j < GLYPH_ATLAS_CHAR_COUNT; j++) {
+      atlas->kerning[i][j] = TTF_GetFontKerningSizeGlyphs(
+        font,
+        GLYPH_ATLAS_FIRST_CHAR + i,
+        GLYPH_ATLAS_FIRST_CHAR + j
+      );
+    }
+  }
+
+  return atlas;
+}
+
+void glyph_atlas_destroy(GlyphAtlas *atlas)
+{
+  if (atlas == NULL) return;
+
+  if (atlas->sheet.texture != NULL) {
+    SDL_DestroyTexture(atlas->sheet.texture);
+    COUNTER_INC(COUNTER_TEXTURES_DESTROYED);
+  }
+  SDL_FreeSurface(atlas->sheet.surface);
+  free(atlas);
+}
+
+int glyph_atlas_measure(GlyphAtlas *atlas, const char *text)
+{
+  int width = 0, previous = -1;
+
+  for (const char *c = text; *c != '\0'; c++) {
+    int index = glyph_atlas_index(*c);
+    if (previous >= 0) width += atlas->kerning[previous][index];
+    width += atlas->glyphs[index].advance;
+    previous = index;
+  }
+
+  return width;
+}
+
+int glyph_atlas_draw(
+  GlyphAtlas *atlas,
+  SpriteBatch *batch,
+  int x, int y,
+  const char *text,
+  SDL_Color color
+) {
+  int pen = x, previous = -1;
+
+  for (const char *c = text; *c != '\0'; c++) {
+    int index = glyph_atlas_index(*c);
+    Glyph *glyph = &atlas->glyphs[index];
+
+    if (previous >= 0) pen += atlas->kerning[previous][index];
+    previous = index;
+
+    if (glyph->src.w > 0) {
+      SDL_FRect dst = { pen, y, glyph->src.w, glyph->src.h };
+      if (sprite_batch_draw(batch, &atlas->sheet, &glyph->src, &dst, 0.0, SDL_FLIP_NONE, color) != 0) {
+        return -1;
+      }
+    }
+    pen += glyph->advance;
+  }
+
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+# ifndef GLYPH_ATLAS_H
+# define GLYPH_ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
+
+#include "sprite_atlas.h"
+#include "sprite_batch.h"
+
+#define GLYPH_ATLAS_FIRST_CHAR 32
+#define GLYPH_ATLAS_LAST_CHAR 126
+#define GLYPH_ATLAS_CHAR_COUNT (GLYPH_ATLAS_LAST_CHAR - GLYPH_ATLAS_FIRST_CHAR + 1)
+
+#define GLYPH_ATLAS_WIDTH 512
+#define GLYPH_ATLAS_PADDING 1
+
+typedef struct {
+  SDL_Rect src;
+  int advance;
+} Glyph;
+
+typedef struct {
+  TTF_Font *font;
+  int size;
+  int height;
+  // every glyph of the font, in a texture or in memory for software rendering
+  Sprite sheet;
+  Glyph glyphs[GLYPH_ATLAS_CHAR_COUNT];
+  Sint16 kerning[GLYPH_ATLAS_CHAR_COUNT][GLYPH_ATLAS_CHAR_COUNT];
+} GlyphAtlas;
+
+/**
+ * @brief Rasterize every printable glyph of a font into a single texture
+ * @param renderer SDL_Renderer, NULL to keep the glyphs in memory
+ * @param font Font
+ * @param size Font size the font was opened with
+ * @return GlyphAtlas*, NULL on error
+ */
+GlyphAtlas *glyph_atlas_create(SDL_Renderer *renderer, TTF_Font *font, int size);
+
+/**
+ * @brief Destroy the GlyphAtlas object
+ * @param atlas GlyphAtlas
+ */
+void glyph_atlas_destroy(GlyphAtlas *atlas);
+
+/**
+ * @brief Measure the width of a text, kerning included
+ * @param atlas GlyphAtlas
+ * @param text Text
+ * @return int
+ */
+int glyph_atlas_measure(GlyphAtlas *atlas, const char *text);
+
+/**
+ * @brief Queue a text as textured quads in a sprite batch
+ * @param atlas GlyphAtlas
+ * @param batch SpriteBatch
+ * @param x X of the left of the text
+ * @param y Y of the top of the text
+ * @param text Text
+ * @param color SDL_Color
+ * @return 0 on success, a negative value on error
+ */
+int glyph_atlas_draw(
+  GlyphAtlas *atlas,
+  SpriteBatch *batch,
+  int x, int y,
+  const char *text,
+  SDL_Color color
+);
+
+# endif
\ No newline at end of file
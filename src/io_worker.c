@@ -0,0 +1,183 @@
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "io_worker.h"
+
+static bool io_worker_write(IoJob *job)
+{
+  off_t end = lseek(job->fd, 0, SEEK_END);
+  if (write(job->fd, job->data, job->size) == (ssize_t) job->size) return true;
+
+  // drop what was written of it, the next job starts where it should
+  if (end >= 0 && ftruncate(job->fd, end) < 0) {
+    fprintf(stderr, "[io_worker_write] Erreur lors de la troncature du fichier %d\n", job->fd);
+  }
+  return false;
+}
+
+static void io_worker_write_batch(IoWorker *worker)
+{
+  int failed = 0;
+  for (int i = 0; i < worker->batch_count; i++) {
+    if (!io_worker_write(&worker->batch[i])) {
+      fprintf(stderr, "[io_worker_write_batch] Erreur lors de l'écriture dans le fichier %d\n", worker->batch[i].fd);
+      failed++;
+    }
+  }
+
+  // one sync per file, however many jobs went to it
+  for (int i = 0; i < worker->batch_count; i++) {
+    bool is_first = true;
+    for (int j = 0; j < i && is_first; j++) {
+      if (worker->batch[j].fd == worker->batch[i].fd) is_first = false;
+    }
+    if (is_first && fsync(worker->batch[i].fd) < 0) {
+      fprintf(stderr, "[io_worker_write_batch] Erreur lors de la synchronisation du fichier %d\n", worker->batch[i].fd);
+      failed++;
+    }
+  }
+
+  SDL_LockMutex(worker->lock);
+  worker->written += worker->batch_count;
+  worker->failed += failed;
+  worker->batches++;
+  worker->batch_count = 0;
+  SDL_CondBroadcast(worker->done);
+  SDL_UnlockMutex(worker->lock);
+}
+
+static int io_worker_run(void *data)
+{
+  IoWorker *worker = data;
+
+  SDL_LockMutex(worker->lock);
+  while (true) {
+    while (worker->queue_count == 0 && worker->is_running) {
+      SDL_CondWait(worker->ready, worker->lock);
+    }
+    // queued jobs are still written once stopped
+    if (worker->queue_count == 0) break;
+
+    // take the whole queue, the game can fill it again meanwhile
+    while (worker->queue_count > 0) {
+      worker->batch[worker->batch_count++] = worker->queue[worker->queue_head];
+      worker->queue_head = (worker->queue_head + 1) % IO_WORKER_CAPACITY;
+      worker->queue_count--;
+    }
+    SDL_CondBroadcast(worker->done);
+    SDL_UnlockMutex(worker->lock);
+
+    io_worker_write_batch(worker);
+
+    SDL_LockMutex(worker->lock);
+  }
+  SDL_UnlockMutex(worker->lock);
+
+  return 0;
+}
+
+IoWorker *io_worker_create(void)
+{
+  IoWorker *worker = malloc(sizeof(IoWorker));
+  if (worker == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(worker, 0, sizeof(IoWorker));
+
+  worker->lock = SDL_CreateMutex();
+  worker->ready = SDL_CreateCond();
+  worker->done = SDL_CreateCond();
+  if (worker->lock == NULL || worker->ready == NULL || worker->done == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    io_worker_destroy(worker);
+    return NULL;
+  }
+
+  worker->is_running = true;
+  worker->thread = SDL_CreateThread(io_worker_run, "io_worker", worker);
+  if (worker->thread == NULL) {
+    fprintf(stderr, "[io_worker_create] Erreur lors de la création du thread : %s\n", SDL_GetError());
+    worker->is_running = false;
+    io_worker_destroy(worker);
+    return NULL;
+  }
+
+  return worker;
+}
+
+void io_worker_destroy(IoWorker *worker)
+{
+  if (worker == NULL) return;
+
+  if (worker->thread != NULL) {
+    SDL_LockMutex(worker->lock);
+    worker->is_running = false;
+    SDL_CondSignal(worker->ready);
+    SDL_UnlockMutex(worker->lock);
+    SDL_WaitThread(worker->thread, NULL);
+  }
+
+  if (worker->written > 0) {
+    printf(
+      "I/O: %d writes in %d batches, %d errors, game thread stalled %.3f ms (max %.3f ms)\n",
+      worker->written,
+      worker->batches,
+      worker->failed,
+      worker->stall_time,
+      worker->max_stall
+    );
+  }
+
+  if (worker->done != NULL) SDL_DestroyCond(worker->done);
+  if (worker->ready != NULL) SDL_DestroyCond(worker->ready);
+  if (worker->lock != NULL) SDL_DestroyMutex(worker->lock);
+  free(worker);
+}
+
+static void io_worker_count_stall(IoWorker *worker, Uint64 start)
+{
+  double ms = (double) (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+  worker->stall_time += ms;
+  if (ms > worker->max_stall) worker->max_stall = ms;
+}
+
+bool io_worker_append(IoWorker *worker, int fd, const void *data, size_t size)
+{
+  if (worker == NULL || size > IO_WORKER_JOB_SIZE) return false;
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  SDL_LockMutex(worker->lock);
+  // unlike capture frames, nothing is dropped: a full queue makes the caller wait
+  while (worker->queue_count == IO_WORKER_CAPACITY) {
+    SDL_CondWait(worker->done, worker->lock);
+  }
+
+  IoJob *job = &worker->queue[(worker->queue_head + worker->queue_count) % IO_WORKER_CAPACITY];
+  job->fd = fd;
+  job->size = size;
+  memcpy(job->data, data, size);
+  worker->queue_count++;
+  SDL_CondSignal(worker->ready);
+
+  io_worker_count_stall(worker, start);
+  SDL_UnlockMutex(worker->lock);
+  return true;
+}
+
+void io_worker_flush(IoWorker *worker)
+{
+  if (worker == NULL) return;
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  SDL_LockMutex(worker->lock);
+  // the batches taken after this point only hold jobs queued later
+  int target = worker->written + worker->batch_count + worker->queue_count;
+  while (worker->written < target) {
+    SDL_CondWait(worker->done, worker->lock);
+  }
+  io_worker_count_stall(worker, start);
+  SDL_UnlockMutex(worker->lock);
+}
\ No newline at end of file
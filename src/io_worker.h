@@ -0,0 +1,76 @@
+# ifndef IO_WORKER_H
+# define IO_WORKER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define IO_WORKER_CAPACITY 64
+// bytes of a job, enough for a score record
+#define IO_WORKER_JOB_SIZE 64
+
+/**
+ * Bytes to append to a file, copied when queued so that the caller can
+ * change its own data right away
+ */
+typedef struct {
+  int fd;
+  size_t size;
+  Uint8 data[IO_WORKER_JOB_SIZE];
+} IoJob;
+
+/**
+ * Thread that appends to files and syncs them, off the game thread. Every
+ * job queued when it wakes up is written as one batch, with one fsync per
+ * file for the whole batch.
+ */
+typedef struct {
+  IoJob queue[IO_WORKER_CAPACITY];
+  int queue_head, queue_count;
+  // jobs taken by the thread and not synced yet
+  IoJob batch[IO_WORKER_CAPACITY];
+  int batch_count;
+
+  SDL_Thread *thread;
+  SDL_mutex *lock;
+  // jobs were queued, or the worker is stopping
+  SDL_cond *ready;
+  // a batch was synced, room was made in the queue
+  SDL_cond *done;
+  bool is_running;
+
+  int written, batches, failed;
+  // time the caller waited in io_worker_append and io_worker_flush, in ms
+  double stall_time, max_stall;
+} IoWorker;
+
+/**
+ * @brief Create an IoWorker object and start its thread
+ * @return IoWorker*, NULL on error
+ */
+IoWorker *io_worker_create(void);
+
+/**
+ * @brief Write and sync the jobs still queued, stop the thread and destroy
+ * the IoWorker object
+ * @param worker IoWorker
+ */
+void io_worker_destroy(IoWorker *worker);
+
+/**
+ * @brief Queue bytes to append to a file, only waits if the queue is full
+ * @param worker IoWorker
+ * @param fd File, opened for writing
+ * @param data Bytes, copied
+ * @param size Number of bytes, at most IO_WORKER_JOB_SIZE
+ * @return true if queued
+ */
+bool io_worker_append(IoWorker *worker, int fd, const void *data, size_t size);
+
+/**
+ * @brief Wait until every job queued so far is written and synced
+ * @param worker IoWorker
+ */
+void io_worker_flush(IoWorker *worker);
+
+# endif
\ No newline at end of file
@@ -1,55 +1,684 @@
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
+#include "bundle.h"
+#include "counters.h"
 #include "window.h"
 #include "game.h"
 #include "game_state.h"
+#include "net_client.h"
+#include "net_server.h"
+#include "rollback.h"
 
+// logical size, the window itself can be resized
 #define WINDOW_WIDTH 1120
 #define WINDOW_HEIGHT 800
 #define WINDOW_SCALE 1
 
-int main(int argc, char *argv[])
-{
-  srand(time(NULL));
-  Game *game;
+#define HEADLESS_FRAMES 300
+#define BENCH_FRAMES 500
+#define BENCH_STARTUP_RUNS 5
+#define BENCH_ROLLBACK_LATENCY 100
+#define BENCH_ROLLBACK_LOSS 10
+#define BENCH_ROLLBACK_TICKS 900
+// the two sides keep answering that long once done, for the last acks
+#define BENCH_ROLLBACK_LINGER_MS 1000
+#define BENCH_REWIND_RUNS 200
+// a rewind of the whole window, well within a frame, the bench fails past it
+#define BENCH_REWIND_TARGET_US 1000
 
+static bool init(Uint32 flags)
+{
   // Init SDL
-  if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+  if (SDL_Init(flags) < 0) {
     fprintf(stderr, "Erreur d'initialisation de SDL : %s\n", SDL_GetError());
     cleanup(NULL, NULL, NULL);
-    return EXIT_FAILURE;
+    return false;
   }
 
   // Init SDL_image
   if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
     fprintf(stderr, "Erreur d'initialisation de SDL_image : %s\n", IMG_GetError());
     cleanup(NULL, NULL, NULL);
-    return EXIT_FAILURE;
+    return false;
   }
 
   // Init SDL_ttf
   if (TTF_Init() < 0) {
     fprintf(stderr, "Erreur d'initialisation de SDL_ttf : %s\n", TTF_GetError());
     cleanup(NULL, NULL, NULL);
+    return false;
+  }
+
+  return true;
+}
+
+static Uint32 frame_checksum(Window *window)
+{
+  int pitch;
+  const Uint8 *pixels = window_get_pixels(window, &pitch);
+
+  // FNV-1a of the visible pixels, compared against golden values
+  Uint32 hash = 2166136261u;
+  for (int y = 0; y < window->height; y++) {
+    for (int x = 0; x < window->width * 4; x++) {
+      hash = (hash ^ pixels[y * pitch + x]) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+/**
+ * Render the game into memory, without a GPU nor a display, and print
+ * the checksum of the last frame
+ */
+static int run_headless(int frames, const char *capture_path)
+{
+  simulation_seed(0);
+  if (!init(SDL_INIT_TIMER)) return EXIT_FAILURE;
+
+  Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_SOFTWARE);
+  if (game == NULL) return EXIT_FAILURE;
+  if (capture_path != NULL) {
+    game->capture = capture_create(capture_path, WINDOW_WIDTH, WINDOW_HEIGHT);
+  }
+
+  game->state = STATE_GAME;
+  game_run_frames(game, frames);
+  printf("Frame %d checksum: %08x\n", frames, frame_checksum(game->window));
+
+  ArenaStats arena = game->frame_arena->stats;
+  printf(
+    "Frame arena: %d allocations, peak %d bytes, %d heap fallbacks\n",
+    arena.allocations,
+    (int) arena.peak,
+    arena.overflows
+  );
+
+  game_destroy(game);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Render the same scene with the software rasterizer then with the SDL
+ * software renderer, and print the time per frame of both
+ */
+static int run_bench_render(int frames)
+{
+  RenderBackend backends[] = { RENDER_SOFTWARE, RENDER_SDL_SOFTWARE };
+  const char *names[] = { "raster", "SDL software" };
+
+  for (int i = 0; i < 2; i++) {
+    simulation_seed(0);
+    if (!init(SDL_INIT_TIMER)) return EXIT_FAILURE;
+
+    Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, backends[i]);
+    // an SDL built without its software renderer, the raster is still timed
+    if (game == NULL && backends[i] == RENDER_SDL_SOFTWARE) {
+      printf("%-12s unavailable\n", names[i]);
+      continue;
+    }
+    if (game == NULL) return EXIT_FAILURE;
+
+    game->state = STATE_GAME;
+    game->display_fps = true;
+    game_run_frames(game, 1);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    game_run_frames(game, frames);
+    double seconds = (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+    printf("%-12s %d frames, %.3f ms/frame\n", names[i], frames, seconds * 1000.0 / frames);
+    game_destroy(game);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Time the creation of the game up to its first frame, with the images
+ * decoded on the main thread, then on worker threads, then read already
+ * decoded from the bundle
+ */
+static int run_bench_startup(int runs)
+{
+  int threads[] = { 0, -1, 0 };
+  bool bundled[] = { false, false, true };
+  const char *names[] = { "main thread", "workers", "bundle" };
+  double best[3] = { 0, 0, 0 };
+  // the images of the best run
+  AssetLoaderStats images[3];
+
+  int configs = bundle_get() != NULL ? 3 : 2;
+  if (configs == 2) printf("No %s next to the executable, see make bundle\n", BUNDLE_FILE);
+  bundle_unmount();
+
+  for (int i = 0; i < configs; i++) {
+    asset_loader_set_threads(threads[i]);
+    if (bundled[i]) bundle_mount(NULL);
+    for (int run = 0; run < runs; run++) {
+      if (!init(SDL_INIT_TIMER)) return EXIT_FAILURE;
+
+      Uint64 start = SDL_GetPerformanceCounter();
+      Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_SOFTWARE);
+      if (game == NULL) return EXIT_FAILURE;
+      game_run_frames(game, 1);
+      double ms = (double) (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+      // the best run, the others are disturbed by the disk cache and the system
+      if (run == 0 || ms < best[i]) {
+        best[i] = ms;
+        images[i] = asset_loader_last_stats();
+      }
+      game_destroy(game);
+    }
+  }
+
+  for (int i = 0; i < configs; i++) {
+    printf("%-12s %.1f ms to first frame (best of %d)", names[i], best[i], runs);
+    if (i > 0) printf(", gain %.1f ms", best[0] - best[i]);
+    printf(
+      "\n%-12s %d images decoded in %.1f ms on %d threads, ready %.1f ms after the start\n",
+      "",
+      images[i].count,
+      images[i].decode_time,
+      images[i].thread_count,
+      images[i].ready_time
+    );
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Play recorded games without a display, and print the time spent in the
+ * updates and in the rendering. This is the training workload of make pgo.
+ */
+static int run_bench_replay(int count, char *paths[])
+{
+  Uint64 frequency = SDL_GetPerformanceFrequency();
+  Uint64 update_total = 0, render_total = 0;
+  Uint32 tick_total = 0;
+
+  for (int i = 0; i < count; i++) {
+    Replay *replay = replay_load(paths[i]);
+    if (replay == NULL) return EXIT_FAILURE;
+
+    // the same random numbers as when it was recorded
+    simulation_seed(replay->seed);
+    if (!init(SDL_INIT_TIMER)) {
+      replay_destroy(replay);
+      return EXIT_FAILURE;
+    }
+
+    Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_SOFTWARE);
+    if (game == NULL) {
+      replay_destroy(replay);
+      return EXIT_FAILURE;
+    }
+    game->replay = replay;
+
+    Uint64 update_time = 0, render_time = 0;
+    while (!replay_is_finished(replay) && game->state != STATE_EXIT) {
+      Uint64 start = SDL_GetPerformanceCounter();
+      game_update(game, (float) UPDATE_CAP);
+      Uint64 middle = SDL_GetPerformanceCounter();
+      game_render(game);
+      update_time += middle - start;
+      render_time += SDL_GetPerformanceCounter() - middle;
+    }
+
+    Uint32 ticks = replay->tick;
+    printf(
+      "%s: %u ticks, update %.2f us/tick, render %.1f us/frame, score %d, checksum %08x\n",
+      paths[i],
+      ticks,
+      (double) update_time * 1e6 / frequency / ticks,
+      (double) render_time * 1e6 / frequency / ticks,
+      game->score,
+      frame_checksum(game->window)
+    );
+    update_total += update_time;
+    render_total += render_time;
+    tick_total += ticks;
+
+    game_destroy(game);
+  }
+
+  if (tick_total == 0) return EXIT_SUCCESS;
+  double update_us = (double) update_total * 1e6 / frequency / tick_total;
+  double render_us = (double) render_total * 1e6 / frequency / tick_total;
+  printf(
+    "Total: %u ticks, update %.2f us/tick (%.0f ticks/s), render %.1f us/frame (%.0f frames/s)\n",
+    tick_total,
+    update_us,
+    1e6 / update_us,
+    render_us,
+    1e6 / render_us
+  );
+
+  return EXIT_SUCCESS;
+}
+
+static volatile sig_atomic_t is_stopping = 0;
+
+static void stop(int signal)
+{
+  is_stopping = 1;
+}
+
+/**
+ * Run the authoritative game for the clients, without a display, until
+ * interrupted
+ */
+static int run_server(const char *address)
+{
+  simulation_seed(time(NULL));
+  if (!init(SDL_INIT_TIMER)) return EXIT_FAILURE;
+
+  Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_SOFTWARE);
+  if (game == NULL) return EXIT_FAILURE;
+  NetServer *server = net_server_create(game, address);
+  if (server == NULL) {
+    game_destroy(game);
     return EXIT_FAILURE;
   }
 
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  // one tick every UPDATE_CAP, late ones are run back to back
+  Uint64 period = (Uint64) (SDL_GetPerformanceFrequency() * UPDATE_CAP);
+  Uint64 next_tick = SDL_GetPerformanceCounter();
+  while (!is_stopping && game->state != STATE_EXIT) {
+    net_server_receive(server);
+    if (SDL_GetPerformanceCounter() < next_tick) {
+      SDL_Delay(1);
+      continue;
+    }
+    next_tick += period;
+    net_server_tick(server);
+  }
+
+  net_server_destroy(server);
+  game_destroy(game);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Play on a server: send the keys held every tick, draw the snapshots
+ */
+static int run_client(const char *address)
+{
+  if (!init(SDL_INIT_VIDEO)) return EXIT_FAILURE;
+
+  Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_GPU);
+  if (game == NULL) return EXIT_FAILURE;
+  NetClient *client = net_client_create(game, address);
+  if (client == NULL) {
+    game_destroy(game);
+    return EXIT_FAILURE;
+  }
+
+  Uint64 frequency = SDL_GetPerformanceFrequency();
+  Uint64 period = (Uint64) (frequency * UPDATE_CAP);
+  Uint64 next_input = SDL_GetPerformanceCounter();
+  Uint64 last_snapshot = next_input;
+
+  while (true) {
+    game_input(game);
+    // the snapshots set the state, only the window can end the game here
+    if (game->state == STATE_EXIT) break;
+    if (net_client_is_lost(client)) {
+      fprintf(stderr, "Le serveur %s ne répond plus\n", address);
+      break;
+    }
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (net_client_receive(client)) last_snapshot = now;
+    // a frame per input sent, as game_run draws one per tick
+    if (now < next_input) {
+      SDL_Delay(1);
+      continue;
+    }
+    net_client_send_input(client);
+    next_input = now - next_input > period ? now + period : next_input + period;
+
+    // entities are drawn between the last two snapshots, as between two ticks
+    game->interpolation = SDL_min(1.0f, (float) (now - last_snapshot) / period);
+    game_render(game);
+  }
+
+  net_client_destroy(client);
+  game_destroy(game);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Play versus over the network, Pac-Man on the host, the ghost on the
+ * other side
+ */
+static int run_versus(const char *address, bool is_host)
+{
+  if (!init(SDL_INIT_VIDEO)) return EXIT_FAILURE;
+
+  Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_GPU);
+  if (game == NULL) return EXIT_FAILURE;
+  Rollback *rollback = rollback_create(game, address, is_host);
+  if (rollback == NULL) {
+    game_destroy(game);
+    return EXIT_FAILURE;
+  }
+
+  Uint64 period = (Uint64) (SDL_GetPerformanceFrequency() * UPDATE_CAP);
+  Uint64 next_tick = SDL_GetPerformanceCounter();
+
+  while (true) {
+    game_input(game);
+    // a rewind sets the state back, only the window can end the game here
+    if (game->state == STATE_EXIT) break;
+    if (rollback_is_lost(rollback)) {
+      fprintf(stderr, "L'autre joueur ne répond plus\n");
+      break;
+    }
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    // nothing new to draw before the next tick
+    if (now < next_tick) {
+      SDL_Delay(1);
+      continue;
+    }
+    // the keyboard itself, the keys of the game are the ones of the last tick run
+    Uint8 keys = net_keys_from_keyboard(SDL_GetKeyboardState(NULL));
+    rollback_update(rollback, keys);
+    next_tick = now - next_tick > period ? now + period : next_tick + period;
+
+    game->interpolation = 1.0f - SDL_min(1.0f, (float) (next_tick - now) / period);
+    game_render(game);
+  }
+
+  rollback_destroy(rollback);
+  game_destroy(game);
+  return EXIT_SUCCESS;
+}
+
+// scripted keys, the same whoever computes them: Pac-Man starts the game,
+// then both turn every 8 ticks to a direction drawn from the tick
+static Uint8 bench_rollback_keys(NetRole role, Uint32 tick)
+{
+  if (role == NET_ROLE_PACMAN && tick < 10) return tick < 5 ? NET_KEY_SPACE : 0;
+
+  Uint32 hash = (tick / 8 + 1) * 2654435761u + role * 40503u;
+  return NET_KEY_UP << ((hash >> 16) & 3);
+}
+
+typedef struct {
+  NetRole role;
+  Uint32 checksum;
+} BenchRollbackResult;
+
+/**
+ * One side of run_bench_rollback, in its own process
+ */
+static int run_bench_rollback_side(const char *address, bool is_host, int latency, int loss, Uint32 ticks, int output)
+{
+  if (!init(SDL_INIT_TIMER)) return EXIT_FAILURE;
+
+  Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_SOFTWARE);
+  if (game == NULL) return EXIT_FAILURE;
+  Rollback *rollback = rollback_create(game, address, is_host);
+  if (rollback == NULL || !net_socket_set_conditions(rollback->socket, latency, loss)) {
+    rollback_destroy(rollback);
+    game_destroy(game);
+    return EXIT_FAILURE;
+  }
+  rollback->end_tick = ticks;
+  // not the same datagrams lost both ways
+  srand(is_host ? 1 : 2);
+
+  Uint64 period = (Uint64) (SDL_GetPerformanceFrequency() * UPDATE_CAP);
+  Uint64 next_tick = SDL_GetPerformanceCounter();
+  Uint32 started_at = SDL_GetTicks(), done_at = 0;
+  int status = EXIT_SUCCESS;
+
+  while (done_at == 0 || SDL_GetTicks() - done_at < BENCH_ROLLBACK_LINGER_MS) {
+    // the host would wait for the other side forever otherwise
+    bool never_joined = !rollback->has_peer && SDL_GetTicks() - started_at > ROLLBACK_TIMEOUT_MS;
+    if (rollback_is_lost(rollback) || never_joined) {
+      fprintf(stderr, "L'autre joueur ne répond plus\n");
+      status = EXIT_FAILURE;
+      break;
+    }
+    if (SDL_GetPerformanceCounter() < next_tick) {
+      SDL_Delay(1);
+      continue;
+    }
+    next_tick += period;
+
+    rollback_update(rollback, bench_rollback_keys(rollback->role, rollback->tick));
+    bool is_done = rollback->tick == ticks && rollback->confirmed >= ticks && rollback->remote_ack >= ticks;
+    if (is_done && done_at == 0) done_at = SDL_GetTicks();
+  }
+
+  BenchRollbackResult result = { rollback->role, rollback_checksum(game) };
+  if (write(output, &result, sizeof(result)) != sizeof(result)) status = EXIT_FAILURE;
+
+  rollback_destroy(rollback);
+  game_destroy(game);
+  return status;
+}
+
+/**
+ * Play a scripted versus between two processes over loopback, with the
+ * latency and the loss of a bad network on both sides, and check that
+ * both end on the state of the same game played without a network. Then
+ * time the rewinds alone.
+ */
+static int run_bench_rollback(int latency, int loss, Uint32 ticks)
+{
+  char address[64];
+  snprintf(address, sizeof(address), "%s/tmp/pacman-rollback-%d.sock", NET_UNIX_PREFIX, (int) getpid());
+  printf("%u ticks over %s, %d ms latency, %d%% loss\n", ticks, address, latency, loss);
+
+  int pipes[2];
+  if (pipe(pipes) < 0) {
+    fprintf(stderr, "[run_bench_rollback] Erreur lors de la création du tube\n");
+    return EXIT_FAILURE;
+  }
+
+  // the host binds first, the datagrams of the other side would be refused
+  pid_t children[2];
+  for (int i = 0; i < 2; i++) {
+    fflush(stdout);
+    children[i] = fork();
+    if (children[i] == 0) {
+      close(pipes[0]);
+      exit(run_bench_rollback_side(address, i == 0, latency, loss, ticks, pipes[1]));
+    }
+    if (i == 0) SDL_Delay(500);
+  }
+  close(pipes[1]);
+
+  bool is_ok = true;
+  for (int i = 0; i < 2; i++) {
+    int status;
+    if (children[i] < 0 || waitpid(children[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      is_ok = false;
+    }
+  }
+
+  Uint32 checksums[2] = { 0, 0 };
+  BenchRollbackResult result;
+  while (read(pipes[0], &result, sizeof(result)) == sizeof(result)) {
+    if (result.role <= NET_ROLE_GHOST) checksums[result.role] = result.checksum;
+  }
+  close(pipes[0]);
+  if (!is_ok) {
+    fprintf(stderr, "[run_bench_rollback] Erreur dans une des parties\n");
+    return EXIT_FAILURE;
+  }
+
+  // the same game without a network, then the rewinds in the middle of it
+  if (!init(SDL_INIT_TIMER)) return EXIT_FAILURE;
+  Game *game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_SOFTWARE);
+  if (game == NULL) return EXIT_FAILURE;
+  // the states of a window, as a rewind saves them again
+  RollbackState states[ROLLBACK_WINDOW];
+  int state_count = 0;
+  while (state_count < ROLLBACK_WINDOW && rollback_state_init(&states[state_count])) state_count++;
+  if (state_count < ROLLBACK_WINDOW) {
+    for (int i = 0; i < state_count; i++) rollback_state_free(&states[i]);
+    game_destroy(game);
+    return EXIT_FAILURE;
+  }
+
+  Uint64 frequency = SDL_GetPerformanceFrequency();
+  double best = 0, worst = 0, total = 0;
+  rollback_start(game);
+  for (Uint32 tick = 0; tick < ticks; tick++) {
+    rollback_simulate(game, bench_rollback_keys(NET_ROLE_PACMAN, tick), bench_rollback_keys(NET_ROLE_GHOST, tick));
+    if (tick != ticks / 2) continue;
+
+    // a full window, as rollback_resimulate does it: back to the oldest state, every tick run and saved again
+    for (int run = 0; run < BENCH_REWIND_RUNS; run++) {
+      for (int i = 0; i < ROLLBACK_WINDOW; i++) {
+        rollback_save(game, &states[i]);
+        rollback_simulate(game, NET_KEY_LEFT, NET_KEY_RIGHT);
+      }
+
+      Uint64 start = SDL_GetPerformanceCounter();
+      rollback_load(game, &states[0]);
+      for (int i = 0; i < ROLLBACK_WINDOW; i++) {
+        if (i > 0) rollback_save(game, &states[i]);
+        rollback_simulate(game, NET_KEY_RIGHT, NET_KEY_LEFT);
+      }
+      double us = (double) (SDL_GetPerformanceCounter() - start) * 1e6 / frequency;
+      rollback_load(game, &states[0]);
+
+      if (run == 0 || us < best) best = us;
+      if (us > worst) worst = us;
+      total += us;
+    }
+  }
+  Uint32 reference = rollback_checksum(game);
+
+  bool is_synced = checksums[NET_ROLE_PACMAN] == reference && checksums[NET_ROLE_GHOST] == reference;
+  printf(
+    "Checksums: Pac-Man %08x, ghost %08x, without network %08x, %s\n",
+    checksums[NET_ROLE_PACMAN],
+    checksums[NET_ROLE_GHOST],
+    reference,
+    is_synced ? "in sync" : "OUT OF SYNC"
+  );
+  printf(
+    "Rewind of %d ticks: %.1f us best, %.1f us average, %.1f us worst, target %d us\n",
+    ROLLBACK_WINDOW,
+    best,
+    total / BENCH_REWIND_RUNS,
+    worst,
+    BENCH_REWIND_TARGET_US
+  );
+  bool is_fast = worst <= BENCH_REWIND_TARGET_US;
+  if (!is_fast) fprintf(stderr, "Un retour en arrière a pris %.1f us, plus que %d us\n", worst, BENCH_REWIND_TARGET_US);
+
+  for (int i = 0; i < ROLLBACK_WINDOW; i++) rollback_state_free(&states[i]);
+  game_destroy(game);
+  return is_synced && is_fast ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int run(int argc, char *argv[])
+{
+  // --capture PATH records every frame, see capture_create for the formats
+  const char *capture_path = NULL;
+  // --metrics NAME publishes under another name, to run several games
+  const char *metrics_name = METRICS_NAME;
+  // --record PATH writes the keys of the game to a replay
+  const char *record_path = NULL;
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "--capture") == 0) capture_path = argv[i + 1];
+    if (strcmp(argv[i], "--metrics") == 0) metrics_name = argv[i + 1];
+    if (strcmp(argv[i], "--record") == 0) record_path = argv[i + 1];
+    // --counters PATH writes the counters of every frame, CSV or .jsonl
+    if (strcmp(argv[i], "--counters") == 0 && !counters_dump_open(argv[i + 1])) return EXIT_FAILURE;
+  }
+
+  if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+    int frames = argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : HEADLESS_FRAMES;
+    return run_headless(frames, capture_path);
+  }
+  if (argc > 1 && strcmp(argv[1], "--bench-render") == 0) {
+    return run_bench_render(argc > 2 ? atoi(argv[2]) : BENCH_FRAMES);
+  }
+  if (argc > 1 && strcmp(argv[1], "--bench-startup") == 0) {
+    return run_bench_startup(argc > 2 ? atoi(argv[2]) : BENCH_STARTUP_RUNS);
+  }
+  if (argc > 1 && strcmp(argv[1], "--bench-replay") == 0) {
+    return run_bench_replay(argc - 2, argv + 2);
+  }
+  if (argc > 2 && strcmp(argv[1], "--server") == 0) {
+    return run_server(argv[2]);
+  }
+  if (argc > 2 && strcmp(argv[1], "--connect") == 0) {
+    return run_client(argv[2]);
+  }
+  if (argc > 2 && strcmp(argv[1], "--host") == 0) {
+    return run_versus(argv[2], true);
+  }
+  if (argc > 2 && strcmp(argv[1], "--join") == 0) {
+    return run_versus(argv[2], false);
+  }
+  if (argc > 1 && strcmp(argv[1], "--bench-rollback") == 0) {
+    return run_bench_rollback(
+      argc > 2 ? atoi(argv[2]) : BENCH_ROLLBACK_LATENCY,
+      argc > 3 ? atoi(argv[3]) : BENCH_ROLLBACK_LOSS,
+      argc > 4 ? atoi(argv[4]) : BENCH_ROLLBACK_TICKS
+    );
+  }
+
+  // kept in the replay, to play the same game again
+  unsigned int seed = time(NULL);
+  simulation_seed(seed);
+  Game *game;
+
+  if (!init(SDL_INIT_VIDEO)) return EXIT_FAILURE;
+
   // Create game instance
-  game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE);
+  game = game_create(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_SCALE, RENDER_GPU);
   if (game == NULL) {
     return EXIT_FAILURE;
   }
+  if (capture_path != NULL) {
+    game->capture = capture_create(capture_path, WINDOW_WIDTH, WINDOW_HEIGHT);
+  }
+  // the game runs the same without them
+  game->metrics = metrics_create(metrics_name);
+  if (record_path != NULL) game->replay = replay_record(record_path, seed);
 
   // Run game
   game_run(game);
 
   // Destroy game instance
   game_destroy(game);
-  
+
   return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+  // the assets packed by make bundle, the files on the disk otherwise
+  bundle_mount(NULL);
+
+  int status = run(argc, argv);
+
+  counters_dump_close();
+  bundle_unmount();
+  return status;
 }
\ No newline at end of file
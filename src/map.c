@@ -1,6 +1,8 @@
 #include <stdbool.h>
+#include <string.h>
 
 #include "map.h"
+#include "bundle.h"
 #include "window.h"
 #include "map_tile.h"
 
@@ -13,17 +15,12 @@ Map *map_init(Window *window, const char *map_path, const char *tiles_textures_p
   }
 
   map->window = window;
-  window_load_texture(map->window, tiles_textures_path, &map->tile_map);
+  map->distances = NULL;
+  map->tile_map = window_load_sprite(map->window, tiles_textures_path);
   if (map->tile_map == NULL) {
     return NULL;
   }
 
-  map->map_file = fopen(map_path, "r");
-  if (map->map_file == NULL) {
-    fprintf(stderr, "Erreur d'ouverture du fichier %s\n", map_path);
-    return NULL;
-  }
-
   map->cols = window->width / MAP_TILE_SIZE;
   map->rows = window->height / MAP_TILE_SIZE;
   
@@ -31,12 +28,14 @@ Map *map_init(Window *window, const char *map_path, const char *tiles_textures_p
   for (int i = 0; i < map->cols; i++) {
     map->map[i] = malloc(sizeof(int) * map->rows);
   }
-  if (map->map == NULL) {
+  map->level = malloc(sizeof(int) * map->cols * map->rows);
+  if (map->map == NULL || map->level == NULL) {
     fprintf(stderr, "Erreur d'allocation mémoire\n");
     return NULL;
   }
 
-  map_load(map);
+  if (!map_load(map, map_path)) return NULL;
+  map_reset(map);
 
   return map;
 }
@@ -47,26 +46,49 @@ void map_destroy(Map *map)
     return;
   }
 
-  fclose(map->map_file);
+  asset_manager_release(map->tile_map);
+  free(map->distances);
+  free(map->level);
+  for (int i = 0; i < map->cols; i++) {
+    free(map->map[i]);
+  }
+  free(map->map);
   free(map);
 }
 
-void map_load(Map *map)
+bool map_load(Map *map, const char *map_path)
 {
-  char tile;
-  int row = 0, col = 0;
+  FILE *file = bundle_open_file(map_path);
+  if (file == NULL) {
+    fprintf(stderr, "Erreur d'ouverture du fichier %s\n", map_path);
+    return false;
+  }
 
-  while (tile != EOF) {
-    tile = fgetc(map->map_file);
+  // a short level is padded with spaces, the rest of a long one is ignored
+  for (int i = 0; i < map->cols * map->rows; i++) map->level[i] = TILE_SPACE;
 
-    map->map[col][row] = get_tile_from_char(tile);
+  int tile;
+  int row = 0, col = 0;
+  while ((tile = fgetc(file)) != EOF && row < map->rows) {
+    if (tile == '\n' || tile == ' ' || tile == '\r') continue;
 
-    if (tile != '\n' && tile != ' ' && tile != '\r') col++;
+    map->level[col * map->rows + row] = get_tile_from_char(tile);
+    col++;
     if (col == map->cols) {
       col = 0;
       row++;
     }
   }
+
+  fclose(file);
+  return true;
+}
+
+void map_reset(Map *map)
+{
+  for (int i = 0; i < map->cols; i++) {
+    memcpy(map->map[i], &map->level[i * map->rows], sizeof(int) * map->rows);
+  }
 }
 
 Tiles get_tile_from_char(char c)
@@ -105,6 +127,8 @@ void map_render(Map *map, Window *window)
 {
   if (map == NULL) return;
 
+  window_set_layer(window, RENDER_LAYER_MAP);
+
   SDL_Rect src;
   SDL_Rect dst;
  
@@ -198,7 +222,7 @@ void map_render(Map *map, Window *window)
           break;
       }
       dst = (SDL_Rect) { x * MAP_TILE_SIZE, y * MAP_TILE_SIZE, MAP_TILE_SIZE, MAP_TILE_SIZE };
-      window_draw_texture(window, map->tile_map, &src, &dst);
+      window_draw_sprite(window, map->tile_map, &src, &dst, 0.0, SDL_FLIP_NONE);
     }
   }
 }
@@ -257,6 +281,62 @@ bool tile_is_accessible(Tiles tile)
   }
 }
 
+void map_build_distances(Map *map, int x, int y)
+{
+  if (map == NULL) return;
+
+  int size = map->cols * map->rows;
+  int *queue = malloc(sizeof(int) * size);
+
+  free(map->distances);
+  map->distances = malloc(sizeof(int) * size);
+  if (map->distances == NULL || queue == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    free(queue);
+    return;
+  }
+
+  for (int i = 0; i < size; i++) {
+    map->distances[i] = MAP_DISTANCE_UNREACHABLE;
+  }
+
+  // breadth first search from the target, tunnels wrap around the map
+  int head = 0, tail = 0;
+  map->distances[y * map->cols + x] = 0;
+  queue[tail++] = y * map->cols + x;
+
+  while (head < tail) {
+    int current = queue[head++];
+    int cx = current % map->cols;
+    int cy = current / map->cols;
+    int neighbours[4][2] = { {cx, cy - 1}, {cx, cy + 1}, {cx - 1, cy}, {cx + 1, cy} };
+
+    for (int i = 0; i < 4; i++) {
+      int nx = (neighbours[i][0] + map->cols) % map->cols;
+      int ny = (neighbours[i][1] + map->rows) % map->rows;
+      int next = ny * map->cols + nx;
+
+      if (map->distances[next] != MAP_DISTANCE_UNREACHABLE) continue;
+      if (!tile_is_accessible(map->map[nx][ny])) continue;
+
+      map->distances[next] = map->distances[current] + 1;
+      queue[tail++] = next;
+    }
+  }
+
+  free(queue);
+}
+
+int map_get_distance(Map *map, int x, int y)
+{
+  if (map == NULL || map->distances == NULL) return MAP_DISTANCE_UNREACHABLE;
+
+  x = (x % map->cols + map->cols) % map->cols;
+  y = (y % map->rows + map->rows) % map->rows;
+
+  return map->distances[y * map->cols + x];
+}
+
 int map_count_dots(Map *map)
 {
   int count = 0;
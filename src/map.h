@@ -10,11 +10,15 @@
 
 #define MAP_TILE_SIZE 32
 
+#define MAP_DISTANCE_UNREACHABLE -1
+
 typedef struct {
-  SDL_Texture *tile_map;
-  FILE *map_file;
+  Sprite *tile_map;
   Window *window;
   int **map;
+  // the tiles as read from the level file, column after column, map_reset copies them back
+  int *level;
+  int *distances;
   int cols, rows;
 } Map;
 
@@ -41,10 +45,18 @@ void map_render(Map *map, Window *window);
 void map_destroy(Map *map);
 
 /**
- * @brief Load the Map object
+ * @brief Read the level file, once, into the tiles map_reset starts from
  * @param map Map
+ * @param map_path Map path
+ * @return false if the file can't be opened
  */
-void map_load(Map *map);
+bool map_load(Map *map, const char *map_path);
+
+/**
+ * @brief Put back the tiles of the level, with all its dots
+ * @param map Map
+ */
+void map_reset(Map *map);
 
 /**
  * @brief Get the Tile object
@@ -81,6 +93,23 @@ void map_set_tile(Map *map, int x, int y, Tiles tile);
  */
 bool map_check_collision(Map *map, int x, int y);
 
+/**
+ * @brief Precompute the walking distance from every tile to a target tile
+ * @param map Map
+ * @param x Target tile x position
+ * @param y Target tile y position
+ */
+void map_build_distances(Map *map, int x, int y);
+
+/**
+ * @brief Get the walking distance from a tile to the target tile
+ * @param map Map
+ * @param x Tile x position, wrapped around the map
+ * @param y Tile y position, wrapped around the map
+ * @return int, MAP_DISTANCE_UNREACHABLE if there is no path
+ */
+int map_get_distance(Map *map, int x, int y);
+
 /**
  * @brief Count the number of dot in the map
  * @param map Map
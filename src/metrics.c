@@ -0,0 +1,173 @@
+#include <SDL2/SDL.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "counters.h"
+#include "game_state.h"
+
+// a reader that keeps losing the race gives up, it tries again next poll
+#define METRICS_READ_TRIES 64
+
+static Metrics *metrics_new(const char *name)
+{
+  if (strlen(name) >= sizeof(((Metrics *) NULL)->name)) {
+    fprintf(stderr, "[metrics_new] Nom trop long : %s\n", name);
+    return NULL;
+  }
+
+  Metrics *metrics = malloc(sizeof(Metrics));
+  if (metrics == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(metrics, 0, sizeof(Metrics));
+  strcpy(metrics->name, name);
+
+  return metrics;
+}
+
+Metrics *metrics_create(const char *name)
+{
+  Metrics *metrics = metrics_new(name);
+  if (metrics == NULL) return NULL;
+
+  int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+  if (fd < 0 || ftruncate(fd, sizeof(MetricsSegment)) < 0) {
+    fprintf(stderr, "[metrics_create] Erreur lors de la création de %s\n", name);
+    if (fd >= 0) close(fd);
+    free(metrics);
+    return NULL;
+  }
+
+  void *segment = mmap(NULL, sizeof(MetricsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    fprintf(stderr, "[metrics_create] Erreur lors du mappage de %s\n", name);
+    shm_unlink(name);
+    free(metrics);
+    return NULL;
+  }
+
+  metrics->segment = segment;
+  metrics->is_owner = true;
+  memset(metrics->segment, 0, sizeof(MetricsSegment));
+  metrics->segment->version = METRICS_VERSION;
+  metrics->segment->size = sizeof(MetricsSegment);
+  metrics->segment->pid = getpid();
+  // last, a reader that sees the magic sees the rest
+  __atomic_store_n(&metrics->segment->magic, METRICS_MAGIC, __ATOMIC_RELEASE);
+
+  metrics->last_frame_counter = SDL_GetPerformanceCounter();
+  metrics->second_start = metrics->last_frame_counter;
+
+  return metrics;
+}
+
+Metrics *metrics_attach(const char *name)
+{
+  Metrics *metrics = metrics_new(name);
+  if (metrics == NULL) return NULL;
+
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    free(metrics);
+    return NULL;
+  }
+
+  void *segment = mmap(NULL, sizeof(MetricsSegment), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    free(metrics);
+    return NULL;
+  }
+  metrics->segment = segment;
+
+  if (
+    __atomic_load_n(&metrics->segment->magic, __ATOMIC_ACQUIRE) != METRICS_MAGIC ||
+    metrics->segment->version != METRICS_VERSION ||
+    metrics->segment->size != sizeof(MetricsSegment)
+  ) {
+    fprintf(stderr, "[metrics_attach] Version de %s différente de %d\n", name, METRICS_VERSION);
+    metrics_destroy(metrics);
+    return NULL;
+  }
+
+  return metrics;
+}
+
+void metrics_destroy(Metrics *metrics)
+{
+  if (metrics == NULL) return;
+
+  if (metrics->segment != NULL) munmap(metrics->segment, sizeof(MetricsSegment));
+  if (metrics->is_owner) shm_unlink(metrics->name);
+  free(metrics);
+}
+
+void metrics_publish(Metrics *metrics)
+{
+  if (metrics == NULL) return;
+
+  MetricsSnapshot *snapshot = &metrics->snapshot;
+  Uint64 now = SDL_GetPerformanceCounter();
+  Uint64 frequency = SDL_GetPerformanceFrequency();
+
+  snapshot->frame++;
+  snapshot->time_ms = SDL_GetTicks();
+  snapshot->frame_time_ms = (float) ((double) (now - metrics->last_frame_counter) * 1000.0 / frequency);
+  metrics->last_frame_counter = now;
+
+  int bucket = 0;
+  while (bucket < METRICS_HISTOGRAM_BUCKETS - 1 && snapshot->frame_time_ms >= (float) (1 << bucket)) bucket++;
+  snapshot->frame_times[bucket]++;
+
+  memcpy(snapshot->counters, counters.last, sizeof(snapshot->counters));
+  memcpy(snapshot->counter_totals, counters.totals, sizeof(snapshot->counter_totals));
+
+  if (now - metrics->second_start >= frequency) {
+    Uint64 ticks = counters.totals[COUNTER_TICKS];
+    snapshot->tick_rate = (float) ((double) (ticks - metrics->second_ticks) * frequency / (now - metrics->second_start));
+    metrics->second_start = now;
+    metrics->second_ticks = ticks;
+  }
+
+  // seqlock write: odd, copy, even again
+  MetricsSegment *segment = metrics->segment;
+  Uint32 sequence = segment->sequence;
+  __atomic_store_n(&segment->sequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(&segment->snapshot, snapshot, sizeof(MetricsSnapshot));
+  __atomic_store_n(&segment->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+bool metrics_read(Metrics *metrics, MetricsSnapshot *snapshot)
+{
+  MetricsSegment *segment = metrics->segment;
+
+  for (int i = 0; i < METRICS_READ_TRIES; i++) {
+    Uint32 before = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+    if (before & 1) continue;
+
+    memcpy(snapshot, &segment->snapshot, sizeof(MetricsSnapshot));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&segment->sequence, __ATOMIC_RELAXED) == before) return true;
+  }
+
+  return false;
+}
+
+const char *metrics_state_name(int state)
+{
+  switch (state)
+  {
+    case STATE_MENU: return "menu";
+    case STATE_GAME: return "game";
+    case STATE_GAME_OVER: return "game over";
+    case STATE_EXIT: return "exit";
+    default: return "none";
+  }
+}
\ No newline at end of file
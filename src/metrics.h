@@ -0,0 +1,103 @@
+# ifndef METRICS_H
+# define METRICS_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "counters.h"
+
+#define METRICS_NAME "/pacman-metrics"
+#define METRICS_MAGIC 0x4d434150
+// bumped on any change of MetricsSnapshot, monitors refuse other versions
+#define METRICS_VERSION 1
+// frame times below 1 ms, below 2 ms, below 4 ms... up to 1024 ms and more
+#define METRICS_HISTOGRAM_BUCKETS 12
+
+/**
+ * Values published once per frame
+ */
+typedef struct {
+  Uint64 frame;
+  Uint32 time_ms;
+  // from the game
+  Sint32 state;
+  Sint32 score, level, lives;
+  Sint32 fps;
+  // ticks run over the last second
+  float tick_rate;
+  float frame_time_ms;
+  // frames per frame time bucket since the start
+  Uint32 frame_times[METRICS_HISTOGRAM_BUCKETS];
+  Uint32 counters[COUNTER_COUNT];
+  Uint64 counter_totals[COUNTER_COUNT];
+} MetricsSnapshot;
+
+/**
+ * Layout of the shared memory segment. The sequence is odd while the game
+ * writes the snapshot, a reader copies it and retries if the sequence
+ * changed meanwhile, so the game never waits for a reader.
+ */
+typedef struct {
+  Uint32 magic;
+  Uint32 version;
+  Uint32 size;
+  Uint32 pid;
+  Uint32 sequence;
+  MetricsSnapshot snapshot;
+} MetricsSegment;
+
+typedef struct {
+  char name[64];
+  MetricsSegment *segment;
+  bool is_owner;
+  // filled by the game, completed and copied by metrics_publish
+  MetricsSnapshot snapshot;
+  Uint64 last_frame_counter;
+  Uint64 second_start;
+  Uint64 second_ticks;
+} Metrics;
+
+/**
+ * @brief Create the shared memory segment and a Metrics object to publish
+ * into it. Every syscall is made here, not when publishing.
+ * @param name Name of the segment, like "/pacman-metrics"
+ * @return Metrics*, NULL on error
+ */
+Metrics *metrics_create(const char *name);
+
+/**
+ * @brief Attach to the segment of a running game, read only
+ * @param name Name of the segment
+ * @return Metrics*, NULL if there is no game or if its version differs
+ */
+Metrics *metrics_attach(const char *name);
+
+/**
+ * @brief Destroy the Metrics object, the segment is removed by its creator
+ * @param metrics Metrics
+ */
+void metrics_destroy(Metrics *metrics);
+
+/**
+ * @brief End of a frame: add the frame time and the counters to the
+ * snapshot and copy it into the segment. Memory writes only.
+ * @param metrics Metrics, from metrics_create
+ */
+void metrics_publish(Metrics *metrics);
+
+/**
+ * @brief Copy the last snapshot published, never waits for the game
+ * @param metrics Metrics, from metrics_attach
+ * @param snapshot Copy
+ * @return true if a whole snapshot was copied
+ */
+bool metrics_read(Metrics *metrics, MetricsSnapshot *snapshot);
+
+/**
+ * @brief Get the name of a state
+ * @param state GameState
+ * @return const char*
+ */
+const char *metrics_state_name(int state);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include <stdlib.h>
+#include <math.h>
+
+#include "movement.h"
+#include "fixed.h"
+
+fixed_t movement_advance(
+  fixed_t *x, fixed_t *y,
+  fixed_t target_x, fixed_t target_y,
+  fixed_t budget
+) {
+  fixed_t dx = target_x - *x;
+  fixed_t dy = target_y - *y;
+
+  // only one of dx / dy is non zero, the sum is the distance to the target
+  fixed_t distance = fixed_abs(dx) + fixed_abs(dy);
+  fixed_t step = fixed_min(budget, distance);
+
+  *x += fixed_sign(dx) * step;
+  *y += fixed_sign(dy) * step;
+
+  return budget - step;
+}
+
+fixed_t movement_speed_for_level(fixed_t base, fixed_t step, fixed_t max, int level)
+{
+  return fixed_min(base + step * (level - 1), max);
+}
+
+int movement_interpolate(int previous, int current, float alpha)
+{
+  if (abs(current - previous) > MOVEMENT_TELEPORT_DISTANCE) return current;
+  if (alpha <= 0.0f) return previous;
+  if (alpha >= 1.0f) return current;
+  return previous + (int) lroundf((current - previous) * alpha);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+# ifndef MOVEMENT_H
+# define MOVEMENT_H
+
+#include "fixed.h"
+
+// farther than this in one tick is a teleport, the size of a tile
+#define MOVEMENT_TELEPORT_DISTANCE 32
+
+/**
+ * @brief Advance a position towards a tile aligned target
+ *
+ * Entities only move along one axis at a time, so the position is moved by
+ * the smallest of the budget and the distance left to the target. What is
+ * left of the budget is returned so the caller can pick the next target and
+ * keep moving within the same tick instead of overshooting the tile center.
+ *
+ * @param x X position (fixed point)
+ * @param y Y position (fixed point)
+ * @param target_x Target x position (fixed point)
+ * @param target_y Target y position (fixed point)
+ * @param budget Distance to travel (fixed point)
+ * @return Distance left once the target is reached, 0 if it is not reached
+ */
+fixed_t movement_advance(
+  fixed_t *x, fixed_t *y,
+  fixed_t target_x, fixed_t target_y,
+  fixed_t budget
+);
+
+/**
+ * @brief Compute a speed for a level
+ * @param base Speed at level 1 (fixed point)
+ * @param step Speed added on each level (fixed point)
+ * @param max Maximum speed (fixed point)
+ * @param level Level, starting at 1
+ * @return fixed_t
+ */
+fixed_t movement_speed_for_level(fixed_t base, fixed_t step, fixed_t max, int level);
+
+/**
+ * @brief Interpolate a pixel position between the last two ticks
+ *
+ * Moves farther than MOVEMENT_TELEPORT_DISTANCE in one tick are teleports
+ * (tunnels, spawns) and are never interpolated, so an entity wrapping
+ * around the map does not slide across the whole screen.
+ *
+ * @param previous Position at the previous tick
+ * @param current Position at the current tick
+ * @param alpha Fraction of a tick elapsed, from 0 (previous) to 1 (current)
+ * @return Position to draw
+ */
+int movement_interpolate(int previous, int current, float alpha);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include <SDL2/SDL.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "net.h"
+
+static NetSocket *net_socket_new(int fd, bool is_server)
+{
+  NetSocket *net = malloc(sizeof(NetSocket));
+  if (net == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    close(fd);
+    return NULL;
+  }
+  memset(net, 0, sizeof(NetSocket));
+  net->fd = fd;
+  net->is_server = is_server;
+
+  // the game loop polls, it never waits for the network
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  return net;
+}
+
+static NetSocket *net_socket_open_unix(const char *path, bool is_server)
+{
+  struct sockaddr_un address;
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "[net_socket_open_unix] Chemin trop long : %s\n", path);
+    return NULL;
+  }
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path);
+
+  int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    fprintf(stderr, "[net_socket_open_unix] Erreur lors de la création du socket\n");
+    return NULL;
+  }
+
+  if (is_server) {
+    // left behind by a server that did not stop cleanly
+    unlink(path);
+    if (bind(fd, (struct sockaddr *) &address, sizeof(address)) < 0) {
+      fprintf(stderr, "[net_socket_open_unix] Erreur lors de l'attache à %s\n", path);
+      close(fd);
+      return NULL;
+    }
+  } else {
+    // an address of its own picked by the kernel, for the server to answer to
+    sa_family_t family = AF_UNIX;
+    if (bind(fd, (struct sockaddr *) &family, sizeof(family)) < 0) {
+      fprintf(stderr, "[net_socket_open_unix] Erreur lors de l'attache du client\n");
+      close(fd);
+      return NULL;
+    }
+  }
+
+  NetSocket *net = net_socket_new(fd, is_server);
+  if (net == NULL) return NULL;
+
+  if (is_server) {
+    strcpy(net->path, path);
+  } else {
+    memcpy(&net->peer.storage, &address, sizeof(address));
+    net->peer.length = sizeof(address);
+  }
+
+  return net;
+}
+
+static NetSocket *net_socket_open_udp(const char *address, bool is_server)
+{
+  // HOST:PORT, the last colon splits them
+  char host[256];
+  const char *port = NET_DEFAULT_PORT;
+  snprintf(host, sizeof(host), "%s", address);
+  char *colon = strrchr(host, ':');
+  if (colon != NULL) {
+    *colon = '\0';
+    port = address + (colon - host) + 1;
+  }
+
+  struct addrinfo hints, *result;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = is_server ? AI_PASSIVE : 0;
+  if (getaddrinfo(host[0] != '\0' ? host : NULL, port, &hints, &result) != 0) {
+    fprintf(stderr, "[net_socket_open_udp] Adresse inconnue : %s\n", address);
+    return NULL;
+  }
+
+  int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+  if (fd < 0) {
+    fprintf(stderr, "[net_socket_open_udp] Erreur lors de la création du socket\n");
+    freeaddrinfo(result);
+    return NULL;
+  }
+  if (is_server && bind(fd, result->ai_addr, result->ai_addrlen) < 0) {
+    fprintf(stderr, "[net_socket_open_udp] Erreur lors de l'attache à %s\n", address);
+    freeaddrinfo(result);
+    close(fd);
+    return NULL;
+  }
+
+  NetSocket *net = net_socket_new(fd, is_server);
+  if (net != NULL && !is_server) {
+    memcpy(&net->peer.storage, result->ai_addr, result->ai_addrlen);
+    net->peer.length = result->ai_addrlen;
+  }
+  freeaddrinfo(result);
+
+  return net;
+}
+
+NetSocket *net_socket_open(const char *address, bool is_server)
+{
+  if (strncmp(address, NET_UNIX_PREFIX, strlen(NET_UNIX_PREFIX)) == 0) {
+    return net_socket_open_unix(address + strlen(NET_UNIX_PREFIX), is_server);
+  }
+  return net_socket_open_udp(address, is_server);
+}
+
+void net_socket_close(NetSocket *socket)
+{
+  if (socket == NULL) return;
+
+  close(socket->fd);
+  if (socket->path[0] != '\0') unlink(socket->path);
+  free(socket->delayed);
+  free(socket);
+}
+
+static bool net_socket_send_now(NetSocket *socket, const Uint8 *data, int size, const NetAddress *to)
+{
+  ssize_t sent = sendto(
+    socket->fd,
+    data,
+    size,
+    0,
+    (const struct sockaddr *) &to->storage,
+    to->length
+  );
+  return sent == size;
+}
+
+// datagrams held back by the emulated latency go out once due, in order
+static void net_socket_flush_delayed(NetSocket *socket)
+{
+  Uint32 now = SDL_GetTicks();
+  int sent = 0;
+  while (sent < socket->delayed_count && (Sint32) (now - socket->delayed[sent].due) >= 0) {
+    NetDelayed *delayed = &socket->delayed[sent++];
+    net_socket_send_now(socket, delayed->data, delayed->size, &delayed->to);
+  }
+  if (sent == 0) return;
+
+  socket->delayed_count -= sent;
+  memmove(socket->delayed, socket->delayed + sent, sizeof(NetDelayed) * socket->delayed_count);
+}
+
+int net_socket_receive(NetSocket *socket, Uint8 *data, NetAddress *from)
+{
+  if (socket->delayed_count > 0) net_socket_flush_delayed(socket);
+
+  while (true) {
+    NetAddress address;
+    address.length = sizeof(address.storage);
+
+    ssize_t size = recvfrom(
+      socket->fd,
+      data,
+      NET_PACKET_SIZE,
+      0,
+      (struct sockaddr *) &address.storage,
+      &address.length
+    );
+    if (size < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return NET_RECEIVE_NONE;
+      // a datagram refused earlier on, the socket itself is fine
+      if (errno == EINTR || errno == ECONNREFUSED) continue;
+      return -1;
+    }
+
+    socket->bytes_received += size;
+    socket->packets_received++;
+    // nothing to read in it, and the callers stop on anything but a size
+    if (size == 0) continue;
+
+    if (from != NULL) *from = address;
+    return (int) size;
+  }
+}
+
+bool net_socket_send(NetSocket *socket, const Uint8 *data, int size, const NetAddress *to)
+{
+  if (to == NULL) to = &socket->peer;
+
+  if (socket->loss > 0 && rand() % 100 < socket->loss) {
+    // lost on the way, as far as the sender knows it went out
+    socket->packets_lost++;
+  } else if (socket->latency > 0) {
+    if (socket->delayed_count == NET_DELAYED_CAPACITY) net_socket_flush_delayed(socket);
+    if (socket->delayed_count == NET_DELAYED_CAPACITY) return false;
+
+    NetDelayed *delayed = &socket->delayed[socket->delayed_count++];
+    delayed->due = SDL_GetTicks() + socket->latency;
+    delayed->to = *to;
+    delayed->size = size;
+    memcpy(delayed->data, data, size);
+  } else if (!net_socket_send_now(socket, data, size, to)) {
+    return false;
+  }
+
+  socket->bytes_sent += size;
+  socket->packets_sent++;
+  return true;
+}
+
+bool net_socket_set_conditions(NetSocket *socket, int latency, int loss)
+{
+  if (latency > 0 && socket->delayed == NULL) {
+    socket->delayed = malloc(sizeof(NetDelayed) * NET_DELAYED_CAPACITY);
+    if (socket->delayed == NULL) {
+      fprintf(stderr, "Erreur d'allocation mémoire\n");
+      return false;
+    }
+  }
+
+  socket->latency = latency;
+  socket->loss = loss;
+  return true;
+}
+
+bool net_address_equal(const NetAddress *a, const NetAddress *b)
+{
+  return a->length == b->length && memcmp(&a->storage, &b->storage, a->length) == 0;
+}
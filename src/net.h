@@ -0,0 +1,103 @@
+# ifndef NET_H
+# define NET_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+
+// bytes of a datagram at most, below the MTU of any LAN
+#define NET_PACKET_SIZE 1200
+// from net_socket_receive, no datagram waiting
+#define NET_RECEIVE_NONE -2
+#define NET_DEFAULT_PORT "7777"
+// "unix:PATH" addresses, for tests on one machine
+#define NET_UNIX_PREFIX "unix:"
+
+// datagrams held back at once by an emulated latency
+#define NET_DELAYED_CAPACITY 256
+
+typedef struct {
+  struct sockaddr_storage storage;
+  socklen_t length;
+} NetAddress;
+
+typedef struct {
+  Uint32 due;
+  NetAddress to;
+  int size;
+  Uint8 data[NET_PACKET_SIZE];
+} NetDelayed;
+
+/**
+ * Non blocking datagram socket, UDP for "HOST:PORT" addresses or a Unix
+ * datagram socket for "unix:PATH" ones
+ */
+typedef struct {
+  int fd;
+  bool is_server;
+  // where a client sends, unused by a server
+  NetAddress peer;
+  // bound by a server, removed on close
+  char path[108];
+  Uint64 bytes_sent, bytes_received;
+  Uint32 packets_sent, packets_received;
+  // emulated network, see net_socket_set_conditions
+  int latency, loss;
+  NetDelayed *delayed;
+  int delayed_count;
+  Uint32 packets_lost;
+} NetSocket;
+
+/**
+ * @brief Open a socket
+ * @param address "HOST:PORT", ":PORT" or "unix:PATH"
+ * @param is_server Bind to the address instead of sending to it
+ * @return NetSocket*, NULL on error
+ */
+NetSocket *net_socket_open(const char *address, bool is_server);
+
+/**
+ * @brief Close the socket, a server removes its Unix socket file
+ * @param socket NetSocket
+ */
+void net_socket_close(NetSocket *socket);
+
+/**
+ * @brief Receive one datagram, never waits
+ * @param socket NetSocket
+ * @param data Buffer of NET_PACKET_SIZE bytes
+ * @param from Sender, may be NULL
+ * @return Size of the datagram, NET_RECEIVE_NONE if none is waiting, -1
+ * on error. Empty datagrams are dropped, a size is never 0.
+ */
+int net_socket_receive(NetSocket *socket, Uint8 *data, NetAddress *from);
+
+/**
+ * @brief Send one datagram
+ * @param socket NetSocket
+ * @param data Datagram
+ * @param size Size of the datagram
+ * @param to Receiver, NULL for the peer of a client
+ * @return true if sent, a full socket buffer drops it
+ */
+bool net_socket_send(NetSocket *socket, const Uint8 *data, int size, const NetAddress *to);
+
+/**
+ * @brief Emulate a worse network on the datagrams sent, for tests over
+ * loopback: each is held back for a latency, or dropped at random
+ * @param socket NetSocket
+ * @param latency Delay of every datagram, in ms
+ * @param loss Datagrams dropped, in percent
+ * @return false on error
+ */
+bool net_socket_set_conditions(NetSocket *socket, int latency, int loss);
+
+/**
+ * @brief Compare two addresses
+ * @param a NetAddress
+ * @param b NetAddress
+ * @return true if equal
+ */
+bool net_address_equal(const NetAddress *a, const NetAddress *b);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net_client.h"
+#include "game.h"
+#include "net.h"
+#include "net_protocol.h"
+
+NetClient *net_client_create(Game *game, const char *address)
+{
+  if (game->map->cols * game->map->rows > NET_MAX_TILES) {
+    fprintf(stderr, "[net_client_create] Carte trop grande pour le réseau\n");
+    return NULL;
+  }
+
+  NetClient *client = malloc(sizeof(NetClient));
+  if (client == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(client, 0, sizeof(NetClient));
+
+  client->socket = net_socket_open(address, false);
+  if (client->socket == NULL) {
+    free(client);
+    return NULL;
+  }
+
+  client->game = game;
+  // the same level file as the server, the baseline of tick 0
+  net_state_init(&client->initial, game->map);
+  client->connected_at = SDL_GetTicks();
+  client->last_received = client->connected_at;
+
+  printf("Connecting to %s\n", address);
+  return client;
+}
+
+void net_client_destroy(NetClient *client)
+{
+  if (client == NULL) return;
+
+  // the server would find out after NET_TIMEOUT_MS anyway
+  Uint8 bye = NET_MESSAGE_BYE;
+  net_socket_send(client->socket, &bye, 1, NULL);
+
+  double seconds = (SDL_GetTicks() - client->connected_at) / 1000.0;
+  if (client->snapshots > 0 && seconds > 0) {
+    printf(
+      "Client: %u snapshots, %u dropped, %.0f B/s received\n",
+      client->snapshots,
+      client->dropped,
+      client->socket->bytes_received / seconds
+    );
+  }
+
+  net_socket_close(client->socket);
+  free(client);
+}
+
+void net_client_send_input(NetClient *client)
+{
+  NetInput input = {
+    ++client->sequence,
+    client->tick,
+    net_keys_from_keyboard(client->game->keys)
+  };
+
+  Uint8 data[NET_PACKET_SIZE];
+  int size = net_input_write(&input, data);
+  net_socket_send(client->socket, data, size, NULL);
+}
+
+static void net_client_apply(NetClient *client, const NetState *state)
+{
+  Game *game = client->game;
+  Map *map = game->map;
+
+  game->state = state->state;
+  game->is_paused = state->is_paused;
+  game->score = state->score;
+  game->level = state->level;
+  game->player->lives = state->lives;
+
+  for (int x = 0; x < map->cols; x++) {
+    for (int y = 0; y < map->rows; y++) map->map[x][y] = state->tiles[x * map->rows + y];
+  }
+
+  // drawn between the last two snapshots, animated while they move
+  Player *player = game->player;
+  const NetEntity *entity = &state->entities[0];
+  player->moving = entity->x != player->x || entity->y != player->y;
+  player->animation_frame = player->moving ? player->animation_frame + 1 : 0;
+  player->prev_x = player->x;
+  player->prev_y = player->y;
+  player->x = entity->x;
+  player->y = entity->y;
+  player->direction = entity->look & 0x7;
+  player->invincible = entity->look & NET_ENTITY_INVINCIBLE;
+
+  for (int i = 0; i < GHOST_AMOUNT; i++) {
+    Ghost *ghost = game->ghosts[i];
+    entity = &state->entities[i + 1];
+    ghost->animation_frame++;
+    ghost->prev_x = ghost->x;
+    ghost->prev_y = ghost->y;
+    ghost->x = entity->x;
+    ghost->y = entity->y;
+    ghost->direction = entity->look & 0x7;
+    ghost->is_active = entity->look & NET_ENTITY_ACTIVE;
+    ghost->is_scared = entity->look & NET_ENTITY_SCARED;
+    ghost->is_eaten = entity->look & NET_ENTITY_EATEN;
+  }
+}
+
+bool net_client_receive(NetClient *client)
+{
+  Uint8 data[NET_PACKET_SIZE];
+  const NetState *newest = NULL;
+  int size;
+
+  while ((size = net_socket_receive(client->socket, data, NULL)) > 0) {
+    Uint32 tick, baseline_tick;
+    if (!net_snapshot_peek(data, size, &tick, &baseline_tick)) continue;
+    // late, a newer one was applied already
+    if (tick <= client->tick) {
+      client->dropped++;
+      continue;
+    }
+
+    const NetState *baseline = &client->initial;
+    if (baseline_tick != 0) {
+      baseline = &client->history[baseline_tick % NET_HISTORY];
+      // gone from the history, the next snapshots are on a newer baseline
+      if (baseline->tick != baseline_tick) {
+        client->dropped++;
+        continue;
+      }
+    }
+
+    NetState *state = &client->history[tick % NET_HISTORY];
+    NetRole role;
+    if (!net_snapshot_read(state, baseline, &role, data, size)) {
+      // the slot held a baseline, it is not one anymore
+      state->tick = 0;
+      client->dropped++;
+      continue;
+    }
+
+    if (!client->has_role || role != client->role) {
+      const char *names[] = { "Pac-Man", "the ghost", "a spectator" };
+      printf("Playing as %s\n", names[role < NET_ROLE_SPECTATOR ? role : NET_ROLE_SPECTATOR]);
+      client->role = role;
+      client->has_role = true;
+    }
+
+    client->tick = tick;
+    client->snapshots++;
+    client->last_received = SDL_GetTicks();
+    newest = state;
+  }
+
+  if (newest == NULL) return false;
+
+  net_client_apply(client, newest);
+  return true;
+}
+
+bool net_client_is_lost(NetClient *client)
+{
+  return SDL_GetTicks() - client->last_received > NET_CLIENT_TIMEOUT_MS;
+}
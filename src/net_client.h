@@ -0,0 +1,67 @@
+# ifndef NET_CLIENT_H
+# define NET_CLIENT_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "game.h"
+#include "net.h"
+#include "net_protocol.h"
+
+/**
+ * Game shown from the snapshots of a server. The client never updates the
+ * game itself, it sends the keys held and draws what comes back.
+ */
+typedef struct {
+  Game *game;
+  NetSocket *socket;
+  NetRole role;
+  bool has_role;
+  Uint32 sequence;
+  // last snapshot applied, acknowledged in every input frame
+  Uint32 tick;
+  NetState initial;
+  // by tick % NET_HISTORY, the baselines of the next snapshots
+  NetState history[NET_HISTORY];
+  Uint32 connected_at, last_received;
+  Uint32 snapshots, dropped;
+} NetClient;
+
+/**
+ * @brief Create a NetClient object and join a server
+ * @param game Game, drawn from the snapshots from now on
+ * @param address See net_socket_open
+ * @return NetClient*, NULL on error
+ */
+NetClient *net_client_create(Game *game, const char *address);
+
+/**
+ * @brief Leave the server and destroy the NetClient object
+ * @param client NetClient
+ */
+void net_client_destroy(NetClient *client);
+
+/**
+ * @brief Send the keys held, read from game->keys
+ * @param client NetClient
+ */
+void net_client_send_input(NetClient *client);
+
+/**
+ * @brief Read every snapshot waiting and apply the newest to the game
+ * @param client NetClient
+ * @return true if the game changed
+ */
+bool net_client_receive(NetClient *client);
+
+/**
+ * @brief Check if the server went silent for NET_CLIENT_TIMEOUT_MS
+ * @param client NetClient
+ * @return true if it did
+ */
+bool net_client_is_lost(NetClient *client);
+
+// no snapshot for that long, the server is gone
+#define NET_CLIENT_TIMEOUT_MS 5000
+
+# endif
\ No newline at end of file
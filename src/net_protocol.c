@@ -0,0 +1,319 @@
+#include <SDL2/SDL.h>
+#include <string.h>
+
+#include "net_protocol.h"
+
+#define NET_INPUT_SIZE 11
+#define NET_SNAPSHOT_HEADER_SIZE 8
+#define NET_INPUTS_HEADER_SIZE 11
+
+// fields of a snapshot that differ from its baseline
+#define NET_FIELD_GAME (1 << 0)
+#define NET_FIELD_SCORE (1 << 1)
+#define NET_FIELD_TILES (1 << 2)
+#define NET_FIELD_ENTITY(i) (1 << (3 + (i)))
+
+#define NET_ENTITY_X (1 << 0)
+#define NET_ENTITY_Y (1 << 1)
+#define NET_ENTITY_LOOK (1 << 2)
+
+// scancode of each NetKey bit
+static const SDL_Scancode net_key_codes[NET_KEY_COUNT] = {
+  SDL_SCANCODE_UP,
+  SDL_SCANCODE_DOWN,
+  SDL_SCANCODE_LEFT,
+  SDL_SCANCODE_RIGHT,
+  SDL_SCANCODE_SPACE,
+  SDL_SCANCODE_ESCAPE,
+  SDL_SCANCODE_RETURN
+};
+
+/**
+ * Bytes read or written in order, a read or a write past the end marks the
+ * buffer invalid instead of going on
+ */
+typedef struct {
+  Uint8 *data;
+  const Uint8 *input;
+  int size, position;
+  bool is_valid;
+} NetBuffer;
+
+static void net_write_byte(NetBuffer *buffer, Uint8 value)
+{
+  if (buffer->position >= buffer->size) {
+    buffer->is_valid = false;
+    return;
+  }
+  buffer->data[buffer->position++] = value;
+}
+
+static void net_write_u32(NetBuffer *buffer, Uint32 value)
+{
+  for (int i = 0; i < 4; i++) net_write_byte(buffer, (value >> (8 * i)) & 0xff);
+}
+
+// 7 bits per byte, small values take one byte
+static void net_write_varint(NetBuffer *buffer, Uint32 value)
+{
+  while (value >= 0x80) {
+    net_write_byte(buffer, (value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  net_write_byte(buffer, value);
+}
+
+// signed values folded so that small negative ones stay small
+static void net_write_signed(NetBuffer *buffer, Sint32 value)
+{
+  net_write_varint(buffer, ((Uint32) value << 1) ^ (Uint32) (value >> 31));
+}
+
+static Uint8 net_read_byte(NetBuffer *buffer)
+{
+  if (buffer->position >= buffer->size) {
+    buffer->is_valid = false;
+    return 0;
+  }
+  return buffer->input[buffer->position++];
+}
+
+static Uint32 net_read_u32(NetBuffer *buffer)
+{
+  Uint32 value = 0;
+  for (int i = 0; i < 4; i++) value |= (Uint32) net_read_byte(buffer) << (8 * i);
+  return value;
+}
+
+static Uint32 net_read_varint(NetBuffer *buffer)
+{
+  Uint32 value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    Uint8 byte = net_read_byte(buffer);
+    value |= (Uint32) (byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return value;
+  }
+  buffer->is_valid = false;
+  return 0;
+}
+
+static Sint32 net_read_signed(NetBuffer *buffer)
+{
+  Uint32 value = net_read_varint(buffer);
+  return (Sint32) (value >> 1) ^ -(Sint32) (value & 1);
+}
+
+static bool net_entity_equal(const NetEntity *a, const NetEntity *b)
+{
+  return a->x == b->x && a->y == b->y && a->look == b->look;
+}
+
+void net_state_init(NetState *state, Map *map)
+{
+  memset(state, 0, sizeof(NetState));
+  state->tile_count = map->cols * map->rows;
+  for (int x = 0; x < map->cols; x++) {
+    for (int y = 0; y < map->rows; y++) state->tiles[x * map->rows + y] = map->map[x][y];
+  }
+}
+
+Uint8 net_keys_from_keyboard(const Uint8 *keyboard)
+{
+  Uint8 keys = 0;
+  for (int key = 0; key < NET_KEY_COUNT; key++) {
+    if (keyboard[net_key_codes[key]]) keys |= 1 << key;
+  }
+  return keys;
+}
+
+void net_keys_to_keyboard(Uint8 keys, Uint8 *keyboard)
+{
+  for (int key = 0; key < NET_KEY_COUNT; key++) keyboard[net_key_codes[key]] = (keys >> key) & 1;
+}
+
+int net_input_write(const NetInput *input, Uint8 *data)
+{
+  NetBuffer buffer = { data, NULL, NET_PACKET_SIZE, 0, true };
+  net_write_byte(&buffer, NET_MESSAGE_INPUT);
+  net_write_byte(&buffer, NET_PROTOCOL_VERSION);
+  net_write_u32(&buffer, input->sequence);
+  net_write_u32(&buffer, input->ack);
+  net_write_byte(&buffer, input->keys);
+  return buffer.position;
+}
+
+bool net_input_read(NetInput *input, const Uint8 *data, int size)
+{
+  if (size != NET_INPUT_SIZE || data[0] != NET_MESSAGE_INPUT) return false;
+  // a client of another version would read the snapshots wrong
+  if (data[1] != NET_PROTOCOL_VERSION) return false;
+
+  NetBuffer buffer = { NULL, data, size, 2, true };
+  input->sequence = net_read_u32(&buffer);
+  input->ack = net_read_u32(&buffer);
+  input->keys = net_read_byte(&buffer);
+  return buffer.is_valid;
+}
+
+GhostDirection net_keys_to_ghost_direction(Uint8 keys, GhostDirection direction)
+{
+  if (keys & NET_KEY_UP) direction = GHOST_UP;
+  if (keys & NET_KEY_DOWN) direction = GHOST_DOWN;
+  if (keys & NET_KEY_LEFT) direction = GHOST_LEFT;
+  if (keys & NET_KEY_RIGHT) direction = GHOST_RIGHT;
+  return direction;
+}
+
+int net_inputs_write(const NetInputs *inputs, Uint8 *data)
+{
+  NetBuffer buffer = { data, NULL, NET_PACKET_SIZE, 0, true };
+  net_write_byte(&buffer, NET_MESSAGE_INPUTS);
+  net_write_byte(&buffer, NET_PROTOCOL_VERSION);
+  net_write_u32(&buffer, inputs->ack);
+  net_write_u32(&buffer, inputs->start);
+  net_write_byte(&buffer, inputs->count);
+  for (int i = 0; i < inputs->count; i++) net_write_byte(&buffer, inputs->keys[i]);
+  return buffer.position;
+}
+
+bool net_inputs_read(NetInputs *inputs, const Uint8 *data, int size)
+{
+  if (size < NET_INPUTS_HEADER_SIZE || data[0] != NET_MESSAGE_INPUTS || data[1] != NET_PROTOCOL_VERSION) return false;
+
+  NetBuffer buffer = { NULL, data, size, 2, true };
+  inputs->ack = net_read_u32(&buffer);
+  inputs->start = net_read_u32(&buffer);
+  inputs->count = net_read_byte(&buffer);
+  if (inputs->count > NET_MAX_INPUTS) return false;
+  for (int i = 0; i < inputs->count; i++) inputs->keys[i] = net_read_byte(&buffer);
+  return buffer.is_valid && buffer.position == size;
+}
+
+int net_snapshot_write(const NetState *state, const NetState *baseline, NetRole role, Uint8 *data)
+{
+  NetBuffer buffer = { data, NULL, NET_PACKET_SIZE, 0, true };
+
+  Uint8 fields = 0;
+  if (
+    state->state != baseline->state ||
+    state->is_paused != baseline->is_paused ||
+    state->level != baseline->level ||
+    state->lives != baseline->lives
+  ) fields |= NET_FIELD_GAME;
+  if (state->score != baseline->score) fields |= NET_FIELD_SCORE;
+  if (memcmp(state->tiles, baseline->tiles, state->tile_count) != 0) fields |= NET_FIELD_TILES;
+  for (int i = 0; i < NET_ENTITY_COUNT; i++) {
+    if (!net_entity_equal(&state->entities[i], &baseline->entities[i])) {
+      fields |= NET_FIELD_ENTITY(i);
+    }
+  }
+
+  net_write_byte(&buffer, NET_MESSAGE_SNAPSHOT);
+  net_write_u32(&buffer, state->tick);
+  // the baseline is at most NET_HISTORY ticks old, 0 is the initial state
+  net_write_byte(&buffer, baseline->tick == 0 ? 0 : state->tick - baseline->tick);
+  net_write_byte(&buffer, role);
+  net_write_byte(&buffer, fields);
+
+  if (fields & NET_FIELD_GAME) {
+    net_write_byte(&buffer, state->state | (state->is_paused << 7));
+    net_write_byte(&buffer, state->level);
+    net_write_byte(&buffer, state->lives);
+  }
+  if (fields & NET_FIELD_SCORE) net_write_signed(&buffer, state->score - baseline->score);
+
+  if (fields & NET_FIELD_TILES) {
+    int count = 0;
+    for (int i = 0; i < state->tile_count; i++) count += state->tiles[i] != baseline->tiles[i];
+    net_write_varint(&buffer, count);
+
+    // the dirty tiles in order, each index as the gap from the previous one
+    int previous = -1;
+    for (int i = 0; i < state->tile_count; i++) {
+      if (state->tiles[i] == baseline->tiles[i]) continue;
+      net_write_varint(&buffer, i - previous - 1);
+      net_write_byte(&buffer, state->tiles[i]);
+      previous = i;
+    }
+  }
+
+  for (int i = 0; i < NET_ENTITY_COUNT; i++) {
+    if (!(fields & NET_FIELD_ENTITY(i))) continue;
+
+    const NetEntity *entity = &state->entities[i];
+    const NetEntity *base = &baseline->entities[i];
+    Uint8 changes = 0;
+    if (entity->x != base->x) changes |= NET_ENTITY_X;
+    if (entity->y != base->y) changes |= NET_ENTITY_Y;
+    if (entity->look != base->look) changes |= NET_ENTITY_LOOK;
+
+    net_write_byte(&buffer, changes);
+    if (changes & NET_ENTITY_X) net_write_signed(&buffer, entity->x - base->x);
+    if (changes & NET_ENTITY_Y) net_write_signed(&buffer, entity->y - base->y);
+    if (changes & NET_ENTITY_LOOK) net_write_byte(&buffer, entity->look);
+  }
+
+  if (!buffer.is_valid) {
+    fprintf(stderr, "[net_snapshot_write] Snapshot %u trop grand\n", state->tick);
+    return -1;
+  }
+  return buffer.position;
+}
+
+bool net_snapshot_peek(const Uint8 *data, int size, Uint32 *tick, Uint32 *baseline_tick)
+{
+  if (size < NET_SNAPSHOT_HEADER_SIZE || data[0] != NET_MESSAGE_SNAPSHOT) return false;
+
+  NetBuffer buffer = { NULL, data, size, 1, true };
+  *tick = net_read_u32(&buffer);
+  Uint8 offset = net_read_byte(&buffer);
+  *baseline_tick = offset == 0 ? 0 : *tick - offset;
+  return buffer.is_valid;
+}
+
+bool net_snapshot_read(NetState *state, const NetState *baseline, NetRole *role, const Uint8 *data, int size)
+{
+  if (size < NET_SNAPSHOT_HEADER_SIZE || data[0] != NET_MESSAGE_SNAPSHOT) return false;
+
+  NetBuffer buffer = { NULL, data, size, 1, true };
+  *state = *baseline;
+  state->tick = net_read_u32(&buffer);
+  net_read_byte(&buffer);
+  *role = net_read_byte(&buffer);
+  if (*role > NET_ROLE_SPECTATOR) return false;
+  Uint8 fields = net_read_byte(&buffer);
+
+  if (fields & NET_FIELD_GAME) {
+    Uint8 game = net_read_byte(&buffer);
+    state->state = game & 0x7f;
+    state->is_paused = game >> 7;
+    state->level = net_read_byte(&buffer);
+    state->lives = net_read_byte(&buffer);
+  }
+  if (fields & NET_FIELD_SCORE) state->score += net_read_signed(&buffer);
+
+  if (fields & NET_FIELD_TILES) {
+    Uint32 count = net_read_varint(&buffer);
+    int index = -1;
+    for (Uint32 i = 0; i < count && buffer.is_valid; i++) {
+      Uint32 gap = net_read_varint(&buffer);
+      Uint8 tile = net_read_byte(&buffer);
+      // past the last tile, checked before the sum overflows
+      if (gap >= (Uint32) (state->tile_count - index - 1)) return false;
+      index += gap + 1;
+      state->tiles[index] = tile;
+    }
+  }
+
+  for (int i = 0; i < NET_ENTITY_COUNT; i++) {
+    if (!(fields & NET_FIELD_ENTITY(i))) continue;
+
+    NetEntity *entity = &state->entities[i];
+    Uint8 changes = net_read_byte(&buffer);
+    if (changes & NET_ENTITY_X) entity->x += net_read_signed(&buffer);
+    if (changes & NET_ENTITY_Y) entity->y += net_read_signed(&buffer);
+    if (changes & NET_ENTITY_LOOK) entity->look = net_read_byte(&buffer);
+  }
+
+  return buffer.is_valid && buffer.position == size;
+}
@@ -0,0 +1,205 @@
+# ifndef NET_PROTOCOL_H
+# define NET_PROTOCOL_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "ghost.h"
+#include "map.h"
+#include "net.h"
+
+#define NET_PROTOCOL_VERSION 1
+
+// the player and the ghosts
+#define NET_ENTITY_COUNT 5
+// the ghost a player can move
+#define NET_CONTROLLED_GHOST 0
+// tiles of the map at most, cols * rows
+#define NET_MAX_TILES 1024
+// snapshots kept on both sides, a baseline older than that is not used
+#define NET_HISTORY 64
+
+typedef enum {
+  NET_MESSAGE_INPUT = 1,
+  NET_MESSAGE_SNAPSHOT = 2,
+  NET_MESSAGE_BYE = 3,
+  NET_MESSAGE_INPUTS = 4
+} NetMessage;
+
+typedef enum {
+  NET_ROLE_PACMAN,
+  NET_ROLE_GHOST,
+  NET_ROLE_SPECTATOR
+} NetRole;
+
+// keys of an input frame, one bit each
+typedef enum {
+  NET_KEY_UP = 1 << 0,
+  NET_KEY_DOWN = 1 << 1,
+  NET_KEY_LEFT = 1 << 2,
+  NET_KEY_RIGHT = 1 << 3,
+  NET_KEY_SPACE = 1 << 4,
+  NET_KEY_ESCAPE = 1 << 5,
+  NET_KEY_RETURN = 1 << 6
+} NetKey;
+
+#define NET_KEY_COUNT 7
+
+// look of an entity, packed with its direction
+typedef enum {
+  NET_ENTITY_ACTIVE = 1 << 3,
+  NET_ENTITY_SCARED = 1 << 4,
+  NET_ENTITY_EATEN = 1 << 5,
+  NET_ENTITY_INVINCIBLE = 1 << 6
+} NetEntityFlag;
+
+typedef struct {
+  Sint16 x, y;
+  // direction in the low 3 bits, NetEntityFlag above
+  Uint8 look;
+} NetEntity;
+
+/**
+ * What the clients see of the game at one tick. The tiles start from the
+ * level file, which every client loads too, so a full snapshot only
+ * carries the dots eaten.
+ */
+typedef struct {
+  Uint32 tick;
+  Uint8 state;
+  bool is_paused;
+  Sint32 score;
+  Uint8 level, lives;
+  NetEntity entities[NET_ENTITY_COUNT];
+  int tile_count;
+  Uint8 tiles[NET_MAX_TILES];
+} NetState;
+
+/**
+ * Client to server, every tick: the keys held, and the last snapshot
+ * received, the baseline of the next ones
+ */
+typedef struct {
+  Uint32 sequence;
+  Uint32 ack;
+  Uint8 keys;
+} NetInput;
+
+// ticks of inputs in one NET_MESSAGE_INPUTS datagram at most
+#define NET_MAX_INPUTS 32
+
+/**
+ * Peer to peer, every tick: the keys of every tick the other side has not
+ * acknowledged yet, so that a lost datagram is covered by the next one
+ */
+typedef struct {
+  // ticks of the other side received, all of them up to this one
+  Uint32 ack;
+  // tick of keys[0]
+  Uint32 start;
+  int count;
+  Uint8 keys[NET_MAX_INPUTS];
+} NetInputs;
+
+/**
+ * @brief Initial state, the baseline of tick 0: the tiles of the level as
+ * loaded, everything else zero
+ * @param state NetState
+ * @param map Map, at most NET_MAX_TILES tiles
+ */
+void net_state_init(NetState *state, Map *map);
+
+/**
+ * @brief Get the keys of an input frame from a keyboard state
+ * @param keyboard Keyboard state, as SDL_GetKeyboardState
+ * @return NetKey bits
+ */
+Uint8 net_keys_from_keyboard(const Uint8 *keyboard);
+
+/**
+ * @brief Set a keyboard state from the keys of an input frame
+ * @param keys NetKey bits
+ * @param keyboard Keyboard state of SDL_NUM_SCANCODES keys
+ */
+void net_keys_to_keyboard(Uint8 keys, Uint8 *keyboard);
+
+/**
+ * @brief Steer a ghost by the keys of an input frame: the last direction
+ * pressed is kept until another one is, as for the player
+ * @param keys NetKey bits
+ * @param direction Direction wanted so far
+ * @return GhostDirection
+ */
+GhostDirection net_keys_to_ghost_direction(Uint8 keys, GhostDirection direction);
+
+/**
+ * @brief Write an input frame
+ * @param input NetInput
+ * @param data Buffer of NET_PACKET_SIZE bytes
+ * @return Size written
+ */
+int net_input_write(const NetInput *input, Uint8 *data);
+
+/**
+ * @brief Read an input frame
+ * @param input NetInput
+ * @param data Datagram
+ * @param size Size of the datagram
+ * @return false if it is not a valid input frame
+ */
+bool net_input_read(NetInput *input, const Uint8 *data, int size);
+
+/**
+ * @brief Write the inputs of several ticks
+ * @param inputs NetInputs
+ * @param data Buffer of NET_PACKET_SIZE bytes
+ * @return Size written
+ */
+int net_inputs_write(const NetInputs *inputs, Uint8 *data);
+
+/**
+ * @brief Read the inputs of several ticks
+ * @param inputs NetInputs
+ * @param data Datagram
+ * @param size Size of the datagram
+ * @return false if it is not a valid datagram of inputs
+ */
+bool net_inputs_read(NetInputs *inputs, const Uint8 *data, int size);
+
+/**
+ * @brief Write a snapshot as the changes from a baseline. Fields equal to
+ * the baseline are left out, positions are written as small differences
+ * and eaten dots as the list of tiles that changed.
+ * @param state Snapshot
+ * @param baseline State the receiver has, with tick 0 for the initial state
+ * @param role Role of the receiver, written at NET_SNAPSHOT_ROLE_OFFSET
+ * @param data Buffer of NET_PACKET_SIZE bytes
+ * @return Size written, -1 if it does not fit in a packet
+ */
+int net_snapshot_write(const NetState *state, const NetState *baseline, NetRole role, Uint8 *data);
+
+// the role is the only byte that differs between receivers of one snapshot
+#define NET_SNAPSHOT_ROLE_OFFSET 6
+
+/**
+ * @brief Read the tick and the baseline tick of a snapshot
+ * @param data Datagram
+ * @param size Size of the datagram
+ * @param tick Tick of the snapshot
+ * @param baseline_tick Tick of its baseline, 0 for the initial state
+ * @return false if it is not a valid snapshot
+ */
+bool net_snapshot_peek(const Uint8 *data, int size, Uint32 *tick, Uint32 *baseline_tick);
+
+/**
+ * @brief Read a snapshot over its baseline
+ * @param state Snapshot read
+ * @param baseline The state given to net_snapshot_write
+ * @param role Role of the receiver
+ * @param data Datagram
+ * @param size Size of the datagram
+ * @return false if the datagram is cut or invalid
+ */
+bool net_snapshot_read(NetState *state, const NetState *baseline, NetRole *role, const Uint8 *data, int size);
+
+# endif
\ No newline at end of file
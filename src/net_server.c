@@ -0,0 +1,279 @@
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net_server.h"
+#include "game.h"
+#include "net.h"
+#include "net_protocol.h"
+
+static const char *net_role_names[] = { "Pac-Man", "ghost", "spectator" };
+
+NetServer *net_server_create(Game *game, const char *address)
+{
+  if (game->map->cols * game->map->rows > NET_MAX_TILES) {
+    fprintf(stderr, "[net_server_create] Carte trop grande pour le réseau\n");
+    return NULL;
+  }
+
+  NetServer *server = malloc(sizeof(NetServer));
+  if (server == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(server, 0, sizeof(NetServer));
+
+  server->socket = net_socket_open(address, true);
+  if (server->socket == NULL) {
+    free(server);
+    return NULL;
+  }
+
+  server->game = game;
+  // the game reads the keys of the Pac-Man player, none until one joins
+  game->keys = server->keys;
+  net_state_init(&server->initial, game->map);
+
+  printf("Server listening on %s\n", address);
+  return server;
+}
+
+static void net_server_print_peer(NetPeer *peer, int index)
+{
+  double seconds = (SDL_GetTicks() - peer->joined_at) / 1000.0;
+  printf(
+    "Client %d (%s): %u snapshots, %u full, %.0f B/s over %.1f s\n",
+    index,
+    net_role_names[peer->role],
+    peer->snapshots,
+    peer->full_snapshots,
+    seconds > 0 ? peer->bytes_sent / seconds : 0.0,
+    seconds
+  );
+}
+
+static void net_server_leave(NetServer *server, NetPeer *peer)
+{
+  net_server_print_peer(peer, (int) (peer - server->peers));
+  peer->is_connected = false;
+  server->peer_count--;
+
+  // the ghost goes back to its own mind
+  if (peer->role == NET_ROLE_GHOST) server->game->ghosts[NET_CONTROLLED_GHOST]->is_controlled = false;
+}
+
+void net_server_destroy(NetServer *server)
+{
+  if (server == NULL) return;
+
+  for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+    if (server->peers[i].is_connected) net_server_leave(server, &server->peers[i]);
+  }
+  if (server->written > 0) {
+    printf(
+      "Server: %u ticks, %llu snapshots sent, %llu written\n",
+      server->tick,
+      (unsigned long long) server->sent,
+      (unsigned long long) server->written
+    );
+  }
+
+  net_socket_close(server->socket);
+  free(server);
+}
+
+static NetRole net_server_free_role(NetServer *server)
+{
+  bool is_taken[NET_ROLE_SPECTATOR] = { false, false };
+  for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+    NetPeer *peer = &server->peers[i];
+    if (peer->is_connected && peer->role != NET_ROLE_SPECTATOR) is_taken[peer->role] = true;
+  }
+
+  if (!is_taken[NET_ROLE_PACMAN]) return NET_ROLE_PACMAN;
+  if (!is_taken[NET_ROLE_GHOST]) return NET_ROLE_GHOST;
+  return NET_ROLE_SPECTATOR;
+}
+
+static NetPeer *net_server_join(NetServer *server, const NetAddress *address)
+{
+  for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+    NetPeer *peer = &server->peers[i];
+    if (peer->is_connected) continue;
+
+    NetRole role = net_server_free_role(server);
+    memset(peer, 0, sizeof(NetPeer));
+    peer->is_connected = true;
+    peer->address = *address;
+    peer->role = role;
+    peer->joined_at = SDL_GetTicks();
+    server->peer_count++;
+
+    printf("Client %d joined as %s\n", i, net_role_names[peer->role]);
+    return peer;
+  }
+
+  return NULL;
+}
+
+static NetPeer *net_server_find(NetServer *server, const NetAddress *address)
+{
+  for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+    NetPeer *peer = &server->peers[i];
+    if (peer->is_connected && net_address_equal(&peer->address, address)) return peer;
+  }
+  return NULL;
+}
+
+void net_server_receive(NetServer *server)
+{
+  Uint8 data[NET_PACKET_SIZE];
+  NetAddress from;
+  int size;
+
+  while ((size = net_socket_receive(server->socket, data, &from)) > 0) {
+    NetPeer *peer = net_server_find(server, &from);
+
+    if (data[0] == NET_MESSAGE_BYE) {
+      if (peer != NULL) net_server_leave(server, peer);
+      continue;
+    }
+
+    NetInput input;
+    if (!net_input_read(&input, data, size)) continue;
+    // full, the newcomer is left out until someone leaves
+    if (peer == NULL) peer = net_server_join(server, &from);
+    if (peer == NULL) continue;
+
+    peer->last_seen = SDL_GetTicks();
+    // datagrams come in any order, only a newer baseline is taken
+    if (input.ack > peer->ack && input.ack <= server->tick) peer->ack = input.ack;
+    if (input.sequence > peer->sequence) {
+      peer->sequence = input.sequence;
+      peer->keys = input.keys;
+    }
+  }
+}
+
+// the player and the controlled ghost move by the keys of their clients
+static void net_server_apply_inputs(NetServer *server)
+{
+  Ghost *ghost = server->game->ghosts[NET_CONTROLLED_GHOST];
+  memset(server->keys, 0, sizeof(server->keys));
+  ghost->is_controlled = false;
+
+  Uint32 now = SDL_GetTicks();
+  for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+    NetPeer *peer = &server->peers[i];
+    if (!peer->is_connected) continue;
+
+    if (now - peer->last_seen > NET_TIMEOUT_MS) {
+      net_server_leave(server, peer);
+      continue;
+    }
+
+    if (peer->role == NET_ROLE_PACMAN) net_keys_to_keyboard(peer->keys, server->keys);
+    if (peer->role == NET_ROLE_GHOST) {
+      ghost->is_controlled = true;
+      ghost->wanted_direction = net_keys_to_ghost_direction(peer->keys, ghost->wanted_direction);
+    }
+  }
+}
+
+static Uint8 net_server_look(int direction, bool is_active, bool is_scared, bool is_eaten, bool is_invincible)
+{
+  return direction
+    | (is_active ? NET_ENTITY_ACTIVE : 0)
+    | (is_scared ? NET_ENTITY_SCARED : 0)
+    | (is_eaten ? NET_ENTITY_EATEN : 0)
+    | (is_invincible ? NET_ENTITY_INVINCIBLE : 0);
+}
+
+static void net_server_capture(NetServer *server, NetState *state)
+{
+  Game *game = server->game;
+  Map *map = game->map;
+
+  state->tick = server->tick;
+  state->state = game->state;
+  state->is_paused = game->is_paused;
+  state->score = game->score;
+  state->level = game->level;
+  state->lives = game->player->lives;
+
+  Player *player = game->player;
+  state->entities[0] = (NetEntity) {
+    player->x,
+    player->y,
+    net_server_look(player->direction, true, false, false, player->invincible)
+  };
+  for (int i = 0; i < GHOST_AMOUNT; i++) {
+    Ghost *ghost = game->ghosts[i];
+    state->entities[i + 1] = (NetEntity) {
+      ghost->x,
+      ghost->y,
+      net_server_look(ghost->direction, ghost->is_active, ghost->is_scared, ghost->is_eaten, false)
+    };
+  }
+
+  // the map is made again on every level, with the same size
+  state->tile_count = map->cols * map->rows;
+  for (int x = 0; x < map->cols; x++) {
+    for (int y = 0; y < map->rows; y++) state->tiles[x * map->rows + y] = map->map[x][y];
+  }
+}
+
+// the last snapshot a client has, or the initial state when it is too old
+static const NetState *net_server_baseline(NetServer *server, NetPeer *peer)
+{
+  if (peer->ack == 0 || server->tick - peer->ack >= NET_HISTORY) return &server->initial;
+
+  const NetState *baseline = &server->history[peer->ack % NET_HISTORY];
+  return baseline->tick == peer->ack ? baseline : &server->initial;
+}
+
+static void net_server_broadcast(NetServer *server, const NetState *state)
+{
+  server->encoded_count = 0;
+
+  for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+    NetPeer *peer = &server->peers[i];
+    if (!peer->is_connected) continue;
+
+    // clients on the same baseline get the same bytes, written once
+    const NetState *baseline = net_server_baseline(server, peer);
+    NetEncoded *encoded = NULL;
+    for (int j = 0; j < server->encoded_count; j++) {
+      if (server->encoded[j].baseline_tick == baseline->tick) encoded = &server->encoded[j];
+    }
+    if (encoded == NULL) {
+      encoded = &server->encoded[server->encoded_count];
+      encoded->baseline_tick = baseline->tick;
+      encoded->size = net_snapshot_write(state, baseline, peer->role, encoded->data);
+      if (encoded->size < 0) continue;
+      server->encoded_count++;
+      server->written++;
+    }
+
+    encoded->data[NET_SNAPSHOT_ROLE_OFFSET] = peer->role;
+    if (!net_socket_send(server->socket, encoded->data, encoded->size, &peer->address)) continue;
+
+    peer->bytes_sent += encoded->size;
+    peer->snapshots++;
+    if (baseline == &server->initial) peer->full_snapshots++;
+    server->sent++;
+  }
+}
+
+void net_server_tick(NetServer *server)
+{
+  net_server_apply_inputs(server);
+
+  // tick 0 is the initial state, the first snapshot is tick 1
+  server->tick++;
+  game_update(server->game, (float) UPDATE_CAP);
+
+  NetState *state = &server->history[server->tick % NET_HISTORY];
+  net_server_capture(server, state);
+  net_server_broadcast(server, state);
+}
@@ -0,0 +1,86 @@
+# ifndef NET_SERVER_H
+# define NET_SERVER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "game.h"
+#include "net.h"
+#include "net_protocol.h"
+
+#define NET_MAX_CLIENTS 64
+// a client silent for that long is gone
+#define NET_TIMEOUT_MS 5000
+
+typedef struct {
+  bool is_connected;
+  NetAddress address;
+  NetRole role;
+  Uint32 sequence;
+  // last snapshot it received, the baseline of the next ones
+  Uint32 ack;
+  Uint8 keys;
+  Uint32 joined_at, last_seen;
+  Uint64 bytes_sent;
+  Uint32 snapshots, full_snapshots;
+} NetPeer;
+
+/**
+ * A snapshot already written, for every client on the same baseline
+ */
+typedef struct {
+  Uint32 baseline_tick;
+  int size;
+  Uint8 data[NET_PACKET_SIZE];
+} NetEncoded;
+
+/**
+ * Authoritative game: runs game_update on the inputs of the clients and
+ * sends them the state of every tick. The first client plays Pac-Man, the
+ * second the ghost NET_CONTROLLED_GHOST, the others watch.
+ */
+typedef struct {
+  Game *game;
+  NetSocket *socket;
+  NetPeer peers[NET_MAX_CLIENTS];
+  int peer_count;
+  // keyboard of the Pac-Man player, read by game_update
+  Uint8 keys[SDL_NUM_SCANCODES];
+  Uint32 tick;
+  NetState initial;
+  // by tick % NET_HISTORY
+  NetState history[NET_HISTORY];
+  NetEncoded encoded[NET_MAX_CLIENTS];
+  int encoded_count;
+  // snapshots written, and sent, fewer written when clients share a baseline
+  Uint64 written, sent;
+} NetServer;
+
+/**
+ * @brief Create a NetServer object listening on an address
+ * @param game Game, updated by the server from now on
+ * @param address See net_socket_open
+ * @return NetServer*, NULL on error
+ */
+NetServer *net_server_create(Game *game, const char *address);
+
+/**
+ * @brief Destroy the NetServer object and print the traffic of the clients
+ * @param server NetServer
+ */
+void net_server_destroy(NetServer *server);
+
+/**
+ * @brief Read every datagram waiting: joins, input frames and leaves
+ * @param server NetServer
+ */
+void net_server_receive(NetServer *server);
+
+/**
+ * @brief Run one tick of the game with the last inputs, then send its
+ * snapshot to every client
+ * @param server NetServer
+ */
+void net_server_tick(NetServer *server);
+
+# endif
\ No newline at end of file
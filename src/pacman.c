@@ -0,0 +1,253 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pacman.h"
+#include "game.h"
+#include "map_tile.h"
+#include "simulation.h"
+
+// the buffers of the callers are laid out from pacman.h alone
+_Static_assert(sizeof(PacmanObservation) == PACMAN_OBSERVATION_SIZE, "PacmanObservation layout");
+_Static_assert(sizeof(PacmanEntity) == 6, "PacmanEntity layout");
+
+// tiles set by the last observation that move on the next one
+#define PACMAN_MARKS (PACMAN_ENTITIES + BONUS_POOL_CAPACITY)
+
+typedef struct {
+  Game *game;
+  // the simulation of this game, in the global one while it steps
+  Simulation simulation;
+  Uint8 keys[SDL_NUM_SCANCODES];
+  Uint32 seed, episodes;
+  // level of the tiles in the observation, all of them are written again on a new one
+  int level;
+  // tile of Pac-Man in the observation, not its previous position, a death moves both
+  int player_col, player_row;
+  Uint8 *marks[PACMAN_MARKS];
+  int mark_count;
+} PacmanGame;
+
+struct Pacman {
+  // loads the sprites once for every game, never drawn
+  Window *window;
+  int count;
+  PacmanGame *games;
+  PacmanObservation *observations;
+};
+
+static const SDL_Scancode pacman_action_keys[PACMAN_ACTION_COUNT] = {
+  SDL_SCANCODE_UNKNOWN,
+  SDL_SCANCODE_UP,
+  SDL_SCANCODE_DOWN,
+  SDL_SCANCODE_LEFT,
+  SDL_SCANCODE_RIGHT
+};
+
+Pacman *pacman_create(int count, PacmanObservation *observations)
+{
+  if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+    fprintf(stderr, "Erreur d'initialisation de SDL_image : %s\n", IMG_GetError());
+    return NULL;
+  }
+
+  Pacman *pacman = malloc(sizeof(Pacman));
+  if (pacman == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  pacman->count = count;
+  pacman->observations = observations;
+  pacman->games = calloc(count, sizeof(PacmanGame));
+  pacman->window = window_create(
+    "Pacman",
+    PACMAN_COLS * MAP_TILE_SIZE,
+    PACMAN_ROWS * MAP_TILE_SIZE,
+    1,
+    RENDER_SOFTWARE
+  );
+  if (pacman->games == NULL || pacman->window == NULL) {
+    fprintf(stderr, "[pacman_create] Erreur lors de la création des jeux\n");
+    pacman_destroy(pacman);
+    return NULL;
+  }
+
+  for (int i = 0; i < count; i++) {
+    PacmanGame *game = &pacman->games[i];
+    game->game = game_create_shared(pacman->window);
+    if (game->game == NULL) {
+      pacman_destroy(pacman);
+      return NULL;
+    }
+    // the keys of the actions, none of the others is ever held
+    game->game->keys = game->keys;
+  }
+
+  pacman_reset(pacman, 0);
+  return pacman;
+}
+
+void pacman_destroy(Pacman *pacman)
+{
+  if (pacman == NULL) return;
+
+  if (pacman->games != NULL) {
+    for (int i = 0; i < pacman->count; i++) game_destroy(pacman->games[i].game);
+    free(pacman->games);
+  }
+  // after the games, they give their sprites back to it
+  if (pacman->window != NULL) window_destroy(pacman->window);
+  free(pacman);
+}
+
+int pacman_count(Pacman *pacman)
+{
+  return pacman->count;
+}
+
+static Uint8 pacman_ghost_direction(GhostDirection direction)
+{
+  if (direction == GHOST_NULL) return PACMAN_ACTION_NONE;
+  return PACMAN_ACTION_UP + direction;
+}
+
+static Uint8 *pacman_tile(PacmanObservation *observation, PacmanChannel channel, int x, int y, int size)
+{
+  // the middle of the entity, as the collisions see it
+  int col = (x + size / 2) / MAP_TILE_SIZE;
+  int row = (y + size / 2) / MAP_TILE_SIZE;
+  // half way through a tunnel
+  if (col < 0 || col >= PACMAN_COLS || row < 0 || row >= PACMAN_ROWS) return NULL;
+  return &observation->tiles[channel][row][col];
+}
+
+static void pacman_mark(PacmanGame *game, Uint8 *tile)
+{
+  if (tile == NULL) return;
+  *tile = 1;
+  game->marks[game->mark_count++] = tile;
+}
+
+static void pacman_observe_map_tile(PacmanObservation *observation, Map *map, int col, int row)
+{
+  if (col < 0 || col >= PACMAN_COLS || row < 0 || row >= PACMAN_ROWS) return;
+
+  Tiles tile = map->map[col][row];
+  observation->tiles[PACMAN_CHANNEL_WALL][row][col] = !tile_is_accessible(tile);
+  observation->tiles[PACMAN_CHANNEL_DOT][row][col] = tile == TILE_DOT;
+  observation->tiles[PACMAN_CHANNEL_POWER_PELLET][row][col] = tile == TILE_POWER_UP;
+}
+
+// only what moved, the tiles of the level are written on reset and level change
+static void pacman_observe(PacmanGame *game, PacmanObservation *observation)
+{
+  Game *state = game->game;
+  Map *map = state->map;
+  Player *player = state->player;
+
+  if (state->level != game->level) {
+    memset(observation->tiles, 0, sizeof(observation->tiles));
+    for (int col = 0; col < PACMAN_COLS; col++) {
+      for (int row = 0; row < PACMAN_ROWS; row++) pacman_observe_map_tile(observation, map, col, row);
+    }
+    game->level = state->level;
+    game->mark_count = 0;
+  } else {
+    // a dot is only ever eaten under Pac-Man, where the last observation saw it
+    pacman_observe_map_tile(observation, map, game->player_col, game->player_row);
+  }
+  game->player_col = (player->x + PLAYER_SIZE / 2) / MAP_TILE_SIZE;
+  game->player_row = (player->y + PLAYER_SIZE / 2) / MAP_TILE_SIZE;
+
+  for (int i = 0; i < game->mark_count; i++) *game->marks[i] = 0;
+  game->mark_count = 0;
+
+  observation->tick = simulation.tick;
+  observation->score = state->score;
+  observation->lives = player->lives;
+  observation->level = state->level;
+
+  PacmanEntity *entity = &observation->entities[0];
+  entity->x = player->x;
+  entity->y = player->y;
+  entity->direction = player->direction;
+  entity->flags = PACMAN_ENTITY_ACTIVE | (player->invincible ? PACMAN_ENTITY_INVINCIBLE : 0);
+  pacman_mark(game, pacman_tile(observation, PACMAN_CHANNEL_PACMAN, player->x, player->y, PLAYER_SIZE));
+
+  for (int i = 0; i < GHOST_AMOUNT; i++) {
+    Ghost *ghost = state->ghosts[i];
+    entity = &observation->entities[i + 1];
+    entity->x = ghost->x;
+    entity->y = ghost->y;
+    entity->direction = pacman_ghost_direction(ghost->direction);
+    entity->flags =
+      (ghost->is_active ? PACMAN_ENTITY_ACTIVE : 0) |
+      (ghost->is_scared ? PACMAN_ENTITY_SCARED : 0) |
+      (ghost->is_eaten ? PACMAN_ENTITY_EATEN : 0);
+
+    PacmanChannel channel = PACMAN_CHANNEL_GHOST;
+    if (ghost->is_eaten) channel = PACMAN_CHANNEL_EATEN_GHOST;
+    else if (ghost->is_scared) channel = PACMAN_CHANNEL_SCARED_GHOST;
+    pacman_mark(game, pacman_tile(observation, channel, ghost->x, ghost->y, GHOST_SIZE));
+  }
+
+  for (int i = 0; i < BONUS_POOL_CAPACITY; i++) {
+    Bonus *bonus = pool_get(state->bonuses, i);
+    if (bonus == NULL || !bonus->is_activate) continue;
+    pacman_mark(game, pacman_tile(observation, PACMAN_CHANNEL_BONUS, bonus->x, bonus->y, MAP_TILE_SIZE));
+  }
+}
+
+static void pacman_start(Pacman *pacman, int index)
+{
+  PacmanGame *game = &pacman->games[index];
+
+  // the next episodes of a game follow from its seed, never meeting another game's
+  simulation_seed(game->seed + game->episodes * pacman->count);
+  game_reset(game->game);
+  // straight into the level, past the menu
+  game->game->state = STATE_GAME;
+  memset(game->keys, 0, sizeof(game->keys));
+  game->simulation = simulation;
+
+  game->level = 0;
+  pacman_observe(game, &pacman->observations[index]);
+}
+
+void pacman_reset(Pacman *pacman, uint32_t seed)
+{
+  for (int i = 0; i < pacman->count; i++) {
+    pacman->games[i].seed = seed + i;
+    pacman->games[i].episodes = 0;
+    pacman_start(pacman, i);
+  }
+}
+
+void pacman_step(Pacman *pacman, const uint8_t *actions, float *rewards, uint8_t *dones)
+{
+  for (int i = 0; i < pacman->count; i++) {
+    PacmanGame *game = &pacman->games[i];
+    Game *state = game->game;
+
+    for (int action = PACMAN_ACTION_UP; action < PACMAN_ACTION_COUNT; action++) {
+      game->keys[pacman_action_keys[action]] = action == actions[i];
+    }
+
+    simulation = game->simulation;
+    int score = state->score;
+    game_update(state, (float) UPDATE_CAP);
+    game->simulation = simulation;
+
+    bool is_done = state->state != STATE_GAME;
+    if (rewards != NULL) rewards[i] = (float) (state->score - score);
+    if (dones != NULL) dones[i] = is_done;
+
+    if (is_done) {
+      game->episodes++;
+      pacman_start(pacman, i);
+    } else {
+      pacman_observe(game, &pacman->observations[i]);
+    }
+  }
+}
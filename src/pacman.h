@@ -0,0 +1,138 @@
+# ifndef PACMAN_H
+# define PACMAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * libpacman, the game logic for programs driving many games at once,
+ * without a window nor the SDL types. Games are stepped one tick per
+ * call, and their observations are written in place into a buffer of
+ * the caller.
+ *
+ * The level is read from ../data/level.txt, or from the bundle when one
+ * is mounted, as the game does.
+ *
+ * The library is not reentrant. The games share the clock and the random
+ * numbers of the game (simulation.h) and its counters, and a step swaps
+ * each game's own clock in and out of them. Several batches can live in
+ * one process, but only one thread may call into the library at a time.
+ * To step batches in parallel, run them in separate processes, for example
+ * with pacman_ipc.h.
+ */
+
+// size of the level, in tiles
+#define PACMAN_COLS 35
+#define PACMAN_ROWS 25
+// Pac-Man, then Inky, Pinky, Blinky and Clyde
+#define PACMAN_ENTITIES 5
+// bytes of a PacmanObservation, the layout never depends on the compiler
+#define PACMAN_OBSERVATION_SIZE 7044
+
+/**
+ * Keys held by Pac-Man for a tick, also the direction of the entities
+ */
+typedef enum {
+  PACMAN_ACTION_NONE,
+  PACMAN_ACTION_UP,
+  PACMAN_ACTION_DOWN,
+  PACMAN_ACTION_LEFT,
+  PACMAN_ACTION_RIGHT,
+  PACMAN_ACTION_COUNT
+} PacmanAction;
+
+typedef enum {
+  PACMAN_CHANNEL_WALL,
+  PACMAN_CHANNEL_DOT,
+  PACMAN_CHANNEL_POWER_PELLET,
+  PACMAN_CHANNEL_BONUS,
+  PACMAN_CHANNEL_PACMAN,
+  PACMAN_CHANNEL_GHOST,
+  PACMAN_CHANNEL_SCARED_GHOST,
+  // eyes going back to the house
+  PACMAN_CHANNEL_EATEN_GHOST,
+  PACMAN_CHANNEL_COUNT
+} PacmanChannel;
+
+typedef enum {
+  // out of the ghost house
+  PACMAN_ENTITY_ACTIVE = 1 << 0,
+  PACMAN_ENTITY_SCARED = 1 << 1,
+  PACMAN_ENTITY_EATEN = 1 << 2,
+  // Pac-Man after a power pellet
+  PACMAN_ENTITY_INVINCIBLE = 1 << 3
+} PacmanEntityFlag;
+
+typedef struct {
+  // top left corner, in pixels, 32 to a tile
+  int16_t x, y;
+  // PacmanAction
+  uint8_t direction;
+  // PacmanEntityFlag bits
+  uint8_t flags;
+} PacmanEntity;
+
+/**
+ * What a game looks like after a tick, in host byte order
+ */
+typedef struct {
+  // ticks since the start of the episode
+  uint32_t tick;
+  int32_t score;
+  uint8_t lives;
+  uint8_t level;
+  uint8_t reserved[2];
+  PacmanEntity entities[PACMAN_ENTITIES];
+  // 1 where the channel is, 0 elsewhere
+  uint8_t tiles[PACMAN_CHANNEL_COUNT][PACMAN_ROWS][PACMAN_COLS];
+  uint8_t padding[2];
+} PacmanObservation;
+
+/**
+ * A batch of games, stepped together
+ */
+typedef struct Pacman Pacman;
+
+/**
+ * @brief Create a batch of games, each waiting for pacman_reset
+ * @param count Number of games
+ * @param observations Buffer of count observations, written by the library
+ * on every reset and step and only read by the caller, until destroyed
+ * @return Pacman*, NULL on error
+ */
+Pacman *pacman_create(int count, PacmanObservation *observations);
+
+/**
+ * @brief Destroy the batch of games
+ * @param pacman Pacman
+ */
+void pacman_destroy(Pacman *pacman);
+
+/**
+ * @brief Start a new episode in every game, the game i from seed + i, so
+ * that the same seed plays the same games again
+ * @param pacman Pacman
+ * @param seed Seed of the batch
+ */
+void pacman_reset(Pacman *pacman, uint32_t seed);
+
+/**
+ * @brief Run one tick of every game. A game ending its episode starts the
+ * next one right away, its observation is the first of the new episode.
+ * Nothing is allocated nor copied but the changes to the observations,
+ * except when a level is loaded.
+ * @param pacman Pacman
+ * @param actions PacmanAction of every game
+ * @param rewards Points scored by every game during the tick, may be NULL
+ * @param dones 1 for the games whose episode ended, 0 otherwise, may be NULL
+ */
+void pacman_step(Pacman *pacman, const uint8_t *actions, float *rewards, uint8_t *dones);
+
+/**
+ * @brief Number of games of the batch
+ * @param pacman Pacman
+ * @return int
+ */
+int pacman_count(Pacman *pacman);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,374 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pacman_ipc.h"
+
+_Static_assert(sizeof(PacmanIpcHeader) == 3 * PACMAN_IPC_CACHE_LINE, "PacmanIpcHeader layout");
+_Static_assert(offsetof(PacmanIpcHeader, submitted) == PACMAN_IPC_CACHE_LINE, "PacmanIpcHeader layout");
+_Static_assert(offsetof(PacmanIpcHeader, completed) == 2 * PACMAN_IPC_CACHE_LINE, "PacmanIpcHeader layout");
+
+// checks of the counter before sleeping, a few microseconds, longer than a step of a small batch
+#define PACMAN_IPC_SPINS 4096
+// a sleeper wakes up that often to see if the other side died
+#define PACMAN_IPC_POLL_MS 100
+
+struct PacmanIpc {
+  char name[64];
+  PacmanIpcHeader *header;
+  uint8_t *segment;
+  uint32_t size;
+  bool is_server;
+  // no point spinning with a single core, the other side can't run meanwhile
+  int spins;
+  // server only, the games write their observations there, copied to the slot of each request
+  Pacman *pacman;
+  PacmanObservation *observations;
+  // agent only, next request to submit
+  uint32_t sequence;
+};
+
+static void pacman_ipc_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+static uint32_t pacman_ipc_align(uint32_t offset)
+{
+  return (offset + PACMAN_IPC_CACHE_LINE - 1) / PACMAN_IPC_CACHE_LINE * PACMAN_IPC_CACHE_LINE;
+}
+
+// offsets of the arrays, the same on both sides
+static void pacman_ipc_layout(PacmanIpcHeader *header, int count)
+{
+  header->count = count;
+  header->slots = PACMAN_IPC_SLOTS;
+  header->requests_offset = sizeof(PacmanIpcHeader);
+  header->actions_offset = pacman_ipc_align(header->requests_offset + sizeof(PacmanIpcRequest) * PACMAN_IPC_SLOTS);
+  header->rewards_offset = pacman_ipc_align(header->actions_offset + count * PACMAN_IPC_SLOTS);
+  header->dones_offset = pacman_ipc_align(header->rewards_offset + sizeof(float) * count * PACMAN_IPC_SLOTS);
+  header->observations_offset = pacman_ipc_align(header->dones_offset + count * PACMAN_IPC_SLOTS);
+  header->size = header->observations_offset + sizeof(PacmanObservation) * count * PACMAN_IPC_SLOTS;
+}
+
+static PacmanIpc *pacman_ipc_new(const char *name)
+{
+  if (strlen(name) >= sizeof(((PacmanIpc *) NULL)->name)) {
+    fprintf(stderr, "[pacman_ipc_new] Nom trop long : %s\n", name);
+    return NULL;
+  }
+
+  PacmanIpc *ipc = malloc(sizeof(PacmanIpc));
+  if (ipc == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(ipc, 0, sizeof(PacmanIpc));
+  strcpy(ipc->name, name);
+  ipc->spins = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? PACMAN_IPC_SPINS : 0;
+
+  return ipc;
+}
+
+PacmanIpc *pacman_ipc_create(const char *name, int count)
+{
+  PacmanIpc *ipc = pacman_ipc_new(name);
+  if (ipc == NULL) return NULL;
+  ipc->is_server = true;
+
+  PacmanIpcHeader layout;
+  memset(&layout, 0, sizeof(layout));
+  pacman_ipc_layout(&layout, count);
+  ipc->size = layout.size;
+
+  int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+  if (fd < 0 || ftruncate(fd, ipc->size) < 0) {
+    fprintf(stderr, "[pacman_ipc_create] Erreur lors de la création de %s\n", name);
+    if (fd >= 0) close(fd);
+    free(ipc);
+    return NULL;
+  }
+
+  void *segment = mmap(NULL, ipc->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    fprintf(stderr, "[pacman_ipc_create] Erreur lors du mappage de %s\n", name);
+    shm_unlink(name);
+    free(ipc);
+    return NULL;
+  }
+  ipc->segment = segment;
+  ipc->header = segment;
+  memset(segment, 0, ipc->size);
+
+  ipc->observations = malloc(sizeof(PacmanObservation) * count);
+  if (ipc->observations == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    pacman_ipc_destroy(ipc);
+    return NULL;
+  }
+  ipc->pacman = pacman_create(count, ipc->observations);
+  if (ipc->pacman == NULL) {
+    pacman_ipc_destroy(ipc);
+    return NULL;
+  }
+
+  *ipc->header = layout;
+  ipc->header->version = PACMAN_IPC_VERSION;
+  ipc->header->server_pid = getpid();
+  // last, an agent that sees the magic sees the rest
+  __atomic_store_n(&ipc->header->magic, PACMAN_IPC_MAGIC, __ATOMIC_RELEASE);
+
+  return ipc;
+}
+
+PacmanIpc *pacman_ipc_attach(const char *name)
+{
+  PacmanIpc *ipc = pacman_ipc_new(name);
+  if (ipc == NULL) return NULL;
+
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) {
+    free(ipc);
+    return NULL;
+  }
+
+  // the header first, it gives the size of the rest
+  PacmanIpcHeader *header = mmap(NULL, sizeof(PacmanIpcHeader), PROT_READ, MAP_SHARED, fd, 0);
+  if (header == MAP_FAILED) {
+    close(fd);
+    free(ipc);
+    return NULL;
+  }
+  bool is_ready = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == PACMAN_IPC_MAGIC;
+  bool is_same_version = header->version == PACMAN_IPC_VERSION;
+  ipc->size = header->size;
+  munmap(header, sizeof(PacmanIpcHeader));
+
+  if (!is_ready || !is_same_version) {
+    // still being created, the caller tries again
+    if (is_ready) fprintf(stderr, "[pacman_ipc_attach] Version de %s différente de %d\n", name, PACMAN_IPC_VERSION);
+    close(fd);
+    free(ipc);
+    return NULL;
+  }
+
+  void *segment = mmap(NULL, ipc->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    free(ipc);
+    return NULL;
+  }
+  ipc->segment = segment;
+  ipc->header = segment;
+
+  // after the requests of an agent before this one
+  ipc->sequence = __atomic_load_n(&ipc->header->submitted, __ATOMIC_ACQUIRE);
+  __atomic_store_n(&ipc->header->agent_pid, getpid(), __ATOMIC_RELEASE);
+
+  return ipc;
+}
+
+void pacman_ipc_destroy(PacmanIpc *ipc)
+{
+  if (ipc == NULL) return;
+
+  pacman_destroy(ipc->pacman);
+  free(ipc->observations);
+  if (ipc->segment != NULL) munmap(ipc->segment, ipc->size);
+  if (ipc->is_server) shm_unlink(ipc->name);
+  free(ipc);
+}
+
+static bool pacman_ipc_is_alive(uint32_t pid)
+{
+  if (pid == 0) return true;
+  if (kill(pid, 0) < 0) return errno != ESRCH;
+
+  // an exited child not waited for yet by its parent, which may be the other side
+  char path[32];
+  snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+  FILE *file = fopen(path, "r");
+  if (file == NULL) return true;
+  char line[256];
+  bool is_read = fgets(line, sizeof(line), file) != NULL;
+  fclose(file);
+
+  // after the name, between parentheses, that may hold anything
+  char *name_end = is_read ? strrchr(line, ')') : NULL;
+  char state = name_end != NULL && name_end[1] == ' ' ? name_end[2] : 0;
+
+  return state != 'Z' && state != 'X';
+}
+
+// until counter reaches target, as a sequence number that wraps around
+static bool pacman_ipc_wait_for(PacmanIpc *ipc, uint32_t *counter, uint32_t target, uint32_t *waiting, uint32_t *peer_pid)
+{
+  for (int i = 0; i < ipc->spins; i++) {
+    if ((int32_t) (__atomic_load_n(counter, __ATOMIC_ACQUIRE) - target) >= 0) return true;
+    pacman_ipc_pause();
+  }
+
+  // announced before the last check, the other side wakes us for anything published after it
+  __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+  bool is_alive = true;
+  while (true) {
+    uint32_t value = __atomic_load_n(counter, __ATOMIC_SEQ_CST);
+    if ((int32_t) (value - target) >= 0) break;
+
+    struct timespec timeout = { 0, PACMAN_IPC_POLL_MS * 1000000L };
+    // returns at once if the counter moved since it was read
+    long result = syscall(SYS_futex, counter, FUTEX_WAIT, value, &timeout, NULL, 0);
+
+    // only when nothing came for a while, never on the way of a wake up
+    if (result < 0 && errno == ETIMEDOUT && !pacman_ipc_is_alive(__atomic_load_n(peer_pid, __ATOMIC_ACQUIRE))) {
+      is_alive = false;
+      break;
+    }
+  }
+  __atomic_store_n(waiting, 0, __ATOMIC_RELEASE);
+
+  return is_alive;
+}
+
+static void pacman_ipc_publish(uint32_t *counter, uint32_t value, uint32_t *waiting)
+{
+  __atomic_store_n(counter, value, __ATOMIC_SEQ_CST);
+  // no system call while the other side spins
+  if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST)) syscall(SYS_futex, counter, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static PacmanIpcRequest *pacman_ipc_request(PacmanIpc *ipc, uint32_t sequence)
+{
+  PacmanIpcRequest *requests = (PacmanIpcRequest *) (ipc->segment + ipc->header->requests_offset);
+  return &requests[sequence % ipc->header->slots];
+}
+
+static uint8_t *pacman_ipc_slot_actions(PacmanIpc *ipc, uint32_t sequence)
+{
+  return ipc->segment + ipc->header->actions_offset + (sequence % ipc->header->slots) * ipc->header->count;
+}
+
+static float *pacman_ipc_slot_rewards(PacmanIpc *ipc, uint32_t sequence)
+{
+  float *rewards = (float *) (ipc->segment + ipc->header->rewards_offset);
+  return rewards + (sequence % ipc->header->slots) * ipc->header->count;
+}
+
+static uint8_t *pacman_ipc_slot_dones(PacmanIpc *ipc, uint32_t sequence)
+{
+  return ipc->segment + ipc->header->dones_offset + (sequence % ipc->header->slots) * ipc->header->count;
+}
+
+static PacmanObservation *pacman_ipc_slot_observations(PacmanIpc *ipc, uint32_t sequence)
+{
+  PacmanObservation *observations = (PacmanObservation *) (ipc->segment + ipc->header->observations_offset);
+  return observations + (sequence % ipc->header->slots) * ipc->header->count;
+}
+
+bool pacman_ipc_serve(PacmanIpc *ipc)
+{
+  PacmanIpcHeader *header = ipc->header;
+
+  while (true) {
+    uint32_t sequence = header->completed;
+    bool is_alive = pacman_ipc_wait_for(
+      ipc,
+      &header->submitted,
+      sequence + 1,
+      &header->server_waiting,
+      &header->agent_pid
+    );
+    if (!is_alive) {
+      fprintf(stderr, "[pacman_ipc_serve] L'agent ne répond plus\n");
+      return false;
+    }
+
+    PacmanIpcRequest request = *pacman_ipc_request(ipc, sequence);
+    float *rewards = pacman_ipc_slot_rewards(ipc, sequence);
+    uint8_t *dones = pacman_ipc_slot_dones(ipc, sequence);
+
+    if (request.command == PACMAN_IPC_STEP) {
+      pacman_step(ipc->pacman, pacman_ipc_slot_actions(ipc, sequence), rewards, dones);
+    } else {
+      if (request.command == PACMAN_IPC_RESET) pacman_reset(ipc->pacman, request.seed);
+      memset(rewards, 0, sizeof(float) * header->count);
+      memset(dones, 0, header->count);
+    }
+    // the agent may still read the slots of the requests before
+    memcpy(pacman_ipc_slot_observations(ipc, sequence), ipc->observations, sizeof(PacmanObservation) * header->count);
+
+    pacman_ipc_publish(&header->completed, sequence + 1, &header->agent_waiting);
+    if (request.command == PACMAN_IPC_CLOSE) return true;
+  }
+}
+
+uint8_t *pacman_ipc_actions(PacmanIpc *ipc)
+{
+  PacmanIpcHeader *header = ipc->header;
+
+  // the slot is still read by the server until the request slots ago completes
+  if ((int32_t) (ipc->sequence - header->slots) >= 0) {
+    bool is_alive = pacman_ipc_wait_for(
+      ipc,
+      &header->completed,
+      ipc->sequence - header->slots + 1,
+      &header->agent_waiting,
+      &header->server_pid
+    );
+    if (!is_alive) return NULL;
+  }
+
+  return pacman_ipc_slot_actions(ipc, ipc->sequence);
+}
+
+uint32_t pacman_ipc_submit(PacmanIpc *ipc, PacmanIpcCommand command, uint32_t seed)
+{
+  uint32_t sequence = ipc->sequence++;
+  PacmanIpcRequest *request = pacman_ipc_request(ipc, sequence);
+  request->command = command;
+  request->seed = seed;
+
+  pacman_ipc_publish(&ipc->header->submitted, ipc->sequence, &ipc->header->server_waiting);
+  return sequence;
+}
+
+bool pacman_ipc_wait(PacmanIpc *ipc, uint32_t sequence)
+{
+  PacmanIpcHeader *header = ipc->header;
+  return pacman_ipc_wait_for(ipc, &header->completed, sequence + 1, &header->agent_waiting, &header->server_pid);
+}
+
+const float *pacman_ipc_rewards(PacmanIpc *ipc, uint32_t sequence)
+{
+  return pacman_ipc_slot_rewards(ipc, sequence);
+}
+
+const uint8_t *pacman_ipc_dones(PacmanIpc *ipc, uint32_t sequence)
+{
+  return pacman_ipc_slot_dones(ipc, sequence);
+}
+
+const PacmanObservation *pacman_ipc_observations(PacmanIpc *ipc, uint32_t sequence)
+{
+  return pacman_ipc_slot_observations(ipc, sequence);
+}
+
+int pacman_ipc_count(PacmanIpc *ipc)
+{
+  return ipc->header->count;
+}
@@ -0,0 +1,171 @@
+# ifndef PACMAN_IPC_H
+# define PACMAN_IPC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pacman.h"
+
+/**
+ * A batch of games served to an agent in another process through shared
+ * memory, with no system call on a step when both sides are running, and
+ * a futex wake up when one of them was asleep.
+ *
+ * The agent writes the actions and the request of a step into the next
+ * slot of a ring, then publishes it by incrementing submitted. The server
+ * steps the games, writes the rewards, the done flags and a copy of the
+ * observations in the same slot, then increments completed. With several
+ * requests in flight, the results of one are never overwritten by the
+ * next. Each side spins a little before sleeping on the counter of the
+ * other.
+ *
+ * The segment is laid out as below whatever the language of the agent,
+ * in host byte order, every array starting on a cache line:
+ *   PacmanIpcHeader
+ *   PacmanIpcRequest requests[slots]
+ *   uint8_t actions[slots][count]
+ *   float rewards[slots][count]
+ *   uint8_t dones[slots][count]
+ *   PacmanObservation observations[slots][count]
+ */
+
+#define PACMAN_IPC_NAME "/pacman-ipc"
+#define PACMAN_IPC_MAGIC 0x43504950
+// bumped on any change of the layout, agents refuse other versions
+#define PACMAN_IPC_VERSION 2
+// requests in flight at most
+#define PACMAN_IPC_SLOTS 16
+#define PACMAN_IPC_CACHE_LINE 64
+
+typedef enum {
+  PACMAN_IPC_STEP,
+  // pacman_reset with the seed of the request
+  PACMAN_IPC_RESET,
+  // the server stops serving once it is completed
+  PACMAN_IPC_CLOSE
+} PacmanIpcCommand;
+
+typedef struct {
+  // PacmanIpcCommand
+  uint32_t command;
+  uint32_t seed;
+} PacmanIpcRequest;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  // bytes of the whole segment
+  uint32_t size;
+  uint32_t server_pid;
+  uint32_t count;
+  uint32_t slots;
+  // from the start of the segment, in bytes
+  uint32_t requests_offset;
+  uint32_t actions_offset;
+  uint32_t rewards_offset;
+  uint32_t dones_offset;
+  uint32_t observations_offset;
+  uint32_t reserved[5];
+
+  // written by the agent alone, each side on its own cache line
+  uint32_t submitted;
+  // set while the agent sleeps on completed, the server wakes it
+  uint32_t agent_waiting;
+  uint32_t agent_pid;
+  uint32_t agent_padding[13];
+
+  // written by the server alone
+  uint32_t completed;
+  // set while the server sleeps on submitted, the agent wakes it
+  uint32_t server_waiting;
+  uint32_t server_padding[14];
+} PacmanIpcHeader;
+
+typedef struct PacmanIpc PacmanIpc;
+
+/**
+ * @brief Create the shared memory segment and the games served in it
+ * @param name Name of the segment, such as PACMAN_IPC_NAME
+ * @param count Number of games
+ * @return PacmanIpc*, NULL on error
+ */
+PacmanIpc *pacman_ipc_create(const char *name, int count);
+
+/**
+ * @brief Serve the requests of the agent, waiting for it to attach first
+ * @param ipc PacmanIpc, from pacman_ipc_create
+ * @return true once PACMAN_IPC_CLOSE is completed, false if the agent died
+ */
+bool pacman_ipc_serve(PacmanIpc *ipc);
+
+/**
+ * @brief Attach to the segment of a server, as its agent
+ * @param name Name of the segment
+ * @return PacmanIpc*, NULL if there is none or of another version
+ */
+PacmanIpc *pacman_ipc_attach(const char *name);
+
+/**
+ * @brief Unmap the segment, the server also removes it
+ * @param ipc PacmanIpc
+ */
+void pacman_ipc_destroy(PacmanIpc *ipc);
+
+/**
+ * @brief Actions of the next request, to be written before submitting it.
+ * With every slot in flight, waits for the oldest one to complete, whose
+ * rewards, done flags and observations are then overwritten.
+ * @param ipc PacmanIpc, from pacman_ipc_attach
+ * @return One PacmanAction per game, NULL if the server died
+ */
+uint8_t *pacman_ipc_actions(PacmanIpc *ipc);
+
+/**
+ * @brief Publish the next request, never waits
+ * @param ipc PacmanIpc, from pacman_ipc_attach
+ * @param command PacmanIpcCommand
+ * @param seed Seed of PACMAN_IPC_RESET, unused otherwise
+ * @return Sequence number of the request
+ */
+uint32_t pacman_ipc_submit(PacmanIpc *ipc, PacmanIpcCommand command, uint32_t seed);
+
+/**
+ * @brief Wait for a request to complete
+ * @param ipc PacmanIpc, from pacman_ipc_attach
+ * @param sequence From pacman_ipc_submit
+ * @return false if the server died
+ */
+bool pacman_ipc_wait(PacmanIpc *ipc, uint32_t sequence);
+
+/**
+ * @brief Rewards of a completed request, until its slot is used again
+ * @param ipc PacmanIpc
+ * @param sequence From pacman_ipc_submit
+ * @return One per game
+ */
+const float *pacman_ipc_rewards(PacmanIpc *ipc, uint32_t sequence);
+
+/**
+ * @brief Done flags of a completed request, until its slot is used again
+ * @param ipc PacmanIpc
+ * @param sequence From pacman_ipc_submit
+ * @return One per game
+ */
+const uint8_t *pacman_ipc_dones(PacmanIpc *ipc, uint32_t sequence);
+
+/**
+ * @brief Observations after a completed request, until its slot is used again
+ * @param ipc PacmanIpc
+ * @param sequence From pacman_ipc_submit
+ * @return One per game
+ */
+const PacmanObservation *pacman_ipc_observations(PacmanIpc *ipc, uint32_t sequence);
+
+/**
+ * @brief Number of games served
+ * @param ipc PacmanIpc
+ * @return int
+ */
+int pacman_ipc_count(PacmanIpc *ipc);
+
+# endif
\ No newline at end of file
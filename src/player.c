@@ -8,6 +8,11 @@
 #include "game_state.h"
 #include "map.h"
 #include "map_tile.h"
+#include "movement.h"
+#include "simulation.h"
+
+static const int player_dx[] = { 0, 0, 0, -1, 1 };
+static const int player_dy[] = { 0, -1, 1, 0, 0 };
 
 Player *player_create(Window *window)
 {
@@ -23,18 +28,22 @@ Player *player_create(Window *window)
   player->invincible = false;
   player->lives = PLAYER_LIVES;
   player->invincible_start_time = 0;
-  player->start_time = SDL_GetTicks() / 1000.0f;
+  player->start_time = simulation_time();
   player->number_of_dots_eaten = 0;
   player->number_of_power_pellets_eaten = 0;
   player->number_of_ghosts_eaten = 0;
-  window_load_texture(window, PLAYER_TEXTURE_FILE, &player->sprite);
+  player->sprite = window_load_sprite(window, PLAYER_TEXTURE_FILE);
 
   return player;
 }
 
-void player_render(Player *player, Window *window)
+void player_render(Player *player, Window *window, float alpha)
 {
-  SDL_Rect rect = {player->x, player->y, PLAYER_SIZE, PLAYER_SIZE};
+  window_set_layer(window, RENDER_LAYER_ENTITIES);
+
+  int x = movement_interpolate(player->prev_x, player->x, alpha);
+  int y = movement_interpolate(player->prev_y, player->y, alpha);
+  SDL_Rect rect = {x, y, PLAYER_SIZE, PLAYER_SIZE};
   SDL_Rect src = {PLAYER_SIZE * (player->animation_frame % PLAYER_ANIMATION_COUNT), 0, PLAYER_SIZE, PLAYER_SIZE};
 
   switch (player->direction)
@@ -59,7 +68,7 @@ void player_destroy(Player *player)
 {
   if (player == NULL) return;
 
-  SDL_DestroyTexture(player->sprite);
+  asset_manager_release(player->sprite);
   free(player);
 }
 
@@ -70,60 +79,24 @@ void player_set_direction(Player *player, PlayerDirection direction)
 
 void player_update(Map *map, Player *player, const Uint8 *keys)
 {
-  float current_time = SDL_GetTicks() / 1000.0f;
-
-  int next_x = player->next_x / MAP_TILE_SIZE;
-  int next_y = player->next_y / MAP_TILE_SIZE;
-
-  if (!player->moving) {
+  float current_time = simulation_time();
 
-    if (keys[SDL_SCANCODE_UP]) {
-      player->next_direction = PLAYER_UP;
-    }
-    if (keys[SDL_SCANCODE_DOWN]) {
-      player->next_direction = PLAYER_DOWN;
-    }
-    if (keys[SDL_SCANCODE_LEFT]) {
-      player->next_direction = PLAYER_LEFT;
-    } 
-    if (keys[SDL_SCANCODE_RIGHT]) {
-      player->next_direction = PLAYER_RIGHT;
-    }
-
-    switch (player->next_direction)
-    {
-      case PLAYER_UP:
-        next_y--;
-        break;
-      case PLAYER_DOWN:
-        next_y++;
-        break;
-      case PLAYER_LEFT:
-        next_x--;
-        break;
-      case PLAYER_RIGHT:
-        next_x++;
-        break;
-      default:
-        break;
-    }
+  // the last pressed direction is kept until the player can turn
+  if (keys[SDL_SCANCODE_UP]) {
+    player->next_direction = PLAYER_UP;
   }
-
-  Tiles next_tile = map_get_tile(map, next_x, next_y);
-
-  if (tile_is_accessible(next_tile)) {
-    player->direction = player->next_direction;
-    player->next_x = next_x * MAP_TILE_SIZE;
-    player->next_y = next_y * MAP_TILE_SIZE;
-    player->moving = true;
-  } else {
-    player->next_x = player->x;
-    player->next_y = player->y;
-    player->moving = false;
+  if (keys[SDL_SCANCODE_DOWN]) {
+    player->next_direction = PLAYER_DOWN;
+  }
+  if (keys[SDL_SCANCODE_LEFT]) {
+    player->next_direction = PLAYER_LEFT;
+  } 
+  if (keys[SDL_SCANCODE_RIGHT]) {
+    player->next_direction = PLAYER_RIGHT;
   }
 
   // move player
-  player_move(player);
+  player_move(map, player);
 
   // update player animation
   if (current_time - player->start_time >= PLAYER_ANIMATION_CAP) {
@@ -143,38 +116,70 @@ void player_update(Map *map, Player *player, const Uint8 *keys)
   }
 }
 
-void player_move(Player *player)
+bool player_choose_next(Map *map, Player *player)
 {
-  if (player->x == player->next_x && player->y == player->next_y) {
-    player->moving = false;
-  } else {
-    switch (player->direction)
-    {
-      case PLAYER_UP:
-        player->y -= player->speed;
-        break;
-      case PLAYER_DOWN:
-        player->y += player->speed;
-        break;
-      case PLAYER_LEFT:
-        player->x -= player->speed;
-        break;
-      case PLAYER_RIGHT:
-        player->x += player->speed;
-        break;
-      default:
-        break;
+  int x = player->next_x / MAP_TILE_SIZE;
+  int y = player->next_y / MAP_TILE_SIZE;
+
+  // try to turn first, then keep going straight
+  PlayerDirection directions[2] = { player->next_direction, player->direction };
+
+  for (int i = 0; i < 2; i++) {
+    PlayerDirection direction = directions[i];
+    int next_x = x + player_dx[direction];
+    int next_y = y + player_dy[direction];
+
+    if (direction != PLAYER_NULL && tile_is_accessible(map_get_tile(map, next_x, next_y))) {
+      player->direction = direction;
+      player->next_x = next_x * MAP_TILE_SIZE;
+      player->next_y = next_y * MAP_TILE_SIZE;
+      player->moving = true;
+      return true;
     }
   }
+
+  player->moving = false;
+  return false;
+}
+
+void player_move(Map *map, Player *player)
+{
+  fixed_t budget = player->speed;
+
+  // leftover distance is carried past tile centers, whatever the speed is
+  while (budget > 0) {
+    fixed_t target_x = FIXED_FROM_INT(player->next_x);
+    fixed_t target_y = FIXED_FROM_INT(player->next_y);
+
+    if (player->pos_x == target_x && player->pos_y == target_y) {
+      if (!player_choose_next(map, player)) break;
+      target_x = FIXED_FROM_INT(player->next_x);
+      target_y = FIXED_FROM_INT(player->next_y);
+    }
+
+    budget = movement_advance(&player->pos_x, &player->pos_y, target_x, target_y, budget);
+  }
+
+  player->x = FIXED_TO_INT(player->pos_x);
+  player->y = FIXED_TO_INT(player->pos_y);
+}
+
+void player_set_position(Player *player, int x, int y)
+{
+  player->x = x;
+  player->y = y;
+  player->prev_x = x;
+  player->prev_y = y;
+  player->next_x = x;
+  player->next_y = y;
+  player->pos_x = FIXED_FROM_INT(x);
+  player->pos_y = FIXED_FROM_INT(y);
 }
 
 void player_move_to_spawn(Player *player)
 {
-  player->x = PLAYER_SPAWN_X * MAP_TILE_SIZE;
-  player->y = PLAYER_SPAWN_Y * MAP_TILE_SIZE;
+  player_set_position(player, PLAYER_SPAWN_X * MAP_TILE_SIZE, PLAYER_SPAWN_Y * MAP_TILE_SIZE);
   player->moving = false;
-  player->next_x = player->x;
-  player->next_y = player->y;
   player->direction = PLAYER_NULL;
   player->next_direction = PLAYER_NULL;
 }
@@ -186,7 +191,7 @@ void player_kill(Player *player)
   player->moving = false;
   player->invincible = false;
   player->invincible_start_time = 0;
-  player->start_time = SDL_GetTicks() / 1000.0f;
+  player->start_time = simulation_time();
   player->animation_frame = 0;
   player->number_of_ghosts_eaten = 0;
 }
@@ -197,7 +202,7 @@ void player_reset(Player *player)
   player->moving = false;
   player->invincible = false;
   player->invincible_start_time = 0;
-  player->start_time = SDL_GetTicks() / 1000.0f;
+  player->start_time = simulation_time();
   player->number_of_dots_eaten = 0;
   player->number_of_power_pellets_eaten = 0;
   player->number_of_ghosts_eaten = 0;
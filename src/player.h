@@ -7,8 +7,9 @@
 
 #include "window.h"
 #include "map.h"
+#include "fixed.h"
 
-#define PLAYER_SPEED 4
+#define PLAYER_SPEED FIXED_FROM_INT(4)
 #define PLAYER_SIZE 32
 
 #define PLAYER_SPAWN_X 17
@@ -31,11 +32,14 @@ typedef enum {
 typedef struct {
   int x, y;
   int next_x, next_y;
-  int speed;
+  // position at the previous tick, rendering interpolates from it
+  int prev_x, prev_y;
+  fixed_t pos_x, pos_y;
+  fixed_t speed;
   float start_time;
   int animation_frame;
   int lives;
-  SDL_Texture *sprite;
+  Sprite *sprite;
   PlayerDirection direction, next_direction;
   bool moving;
   bool invincible;
@@ -60,10 +64,28 @@ Player *player_create(Window *window);
 void player_update(Map *map, Player *player, const Uint8 *keys);
 
 /**
- * @brief Move the Player object
+ * @brief Move the Player object by its speed, turning at tile centers
+ * @param map Map
+ * @param player Player
+ */
+void player_move(Map *map, Player *player);
+
+/**
+ * @brief Choose the next tile once the Player object reached its target
+ * @param map Map
  * @param player Player
+ * @return true if the player keeps moving, false if it is blocked
  */
-void player_move(Player *player);
+bool player_choose_next(Map *map, Player *player);
+
+/**
+ * @brief Place the Player object on a pixel position, without interpolating
+ * from the previous one
+ * @param player Player
+ * @param x X position
+ * @param y Y position
+ */
+void player_set_position(Player *player, int x, int y);
 
 /**
  * @brief Move the Player object to spawn
@@ -72,11 +94,12 @@ void player_move(Player *player);
 void player_move_to_spawn(Player *player);
 
 /**
- * @brief Draw the Player object
+ * @brief Draw the Player object between its last two positions
  * @param player Player
- * @param game Game
+ * @param window Window
+ * @param alpha Fraction of a tick elapsed since the last update, from 0 to 1
  */
-void player_render(Player *player, Window *window);
+void player_render(Player *player, Window *window, float alpha);
 
 /**
  * @brief Kill the Player object
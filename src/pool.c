@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+
+Pool *pool_create(size_t item_size, int capacity)
+{
+  Pool *pool = malloc(sizeof(Pool));
+  if (pool == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  pool->item_size = item_size;
+  pool->capacity = capacity;
+  pool->items = calloc(capacity, item_size);
+  pool->free_list = malloc(sizeof(int) * capacity);
+  pool->is_used = malloc(sizeof(bool) * capacity);
+  if (pool->items == NULL || pool->free_list == NULL || pool->is_used == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    pool_destroy(pool);
+    return NULL;
+  }
+
+  pool_clear(pool);
+  return pool;
+}
+
+void pool_destroy(Pool *pool)
+{
+  if (pool == NULL) return;
+
+  free(pool->items);
+  free(pool->free_list);
+  free(pool->is_used);
+  free(pool);
+}
+
+void *pool_acquire(Pool *pool)
+{
+  if (pool->free_count == 0) return NULL;
+
+  int index = pool->free_list[--pool->free_count];
+  pool->is_used[index] = true;
+  return pool->items + index * pool->item_size;
+}
+
+void pool_release(Pool *pool, void *item)
+{
+  int index = ((unsigned char *) item - pool->items) / pool->item_size;
+  if (index < 0 || index >= pool->capacity || !pool->is_used[index]) {
+    fprintf(stderr, "[pool_release] Objet absent du pool\n");
+    return;
+  }
+
+  pool->is_used[index] = false;
+  pool->free_list[pool->free_count++] = index;
+}
+
+void pool_clear(Pool *pool)
+{
+  // the lowest indices are taken first
+  pool->free_count = 0;
+  for (int i = pool->capacity - 1; i >= 0; i--) {
+    pool->is_used[i] = false;
+    pool->free_list[pool->free_count++] = i;
+  }
+}
+
+void pool_copy(Pool *destination, Pool *source)
+{
+  memcpy(destination->items, source->items, source->item_size * source->capacity);
+  memcpy(destination->free_list, source->free_list, sizeof(int) * source->capacity);
+  memcpy(destination->is_used, source->is_used, sizeof(bool) * source->capacity);
+  destination->free_count = source->free_count;
+}
+
+void *pool_get(Pool *pool, int index)
+{
+  if (index < 0 || index >= pool->capacity || !pool->is_used[index]) return NULL;
+  return pool->items + index * pool->item_size;
+}
+
+int pool_count(Pool *pool)
+{
+  return pool->capacity - pool->free_count;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+# ifndef POOL_H
+# define POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Fixed number of objects of one type, allocated once. Taking and giving
+ * back an object is O(1) and never touches the heap, the object is set up
+ * again in place by its owner.
+ */
+typedef struct {
+  unsigned char *items;
+  size_t item_size;
+  int capacity;
+  // indices of the free objects, used as a stack
+  int *free_list;
+  int free_count;
+  bool *is_used;
+} Pool;
+
+/**
+ * @brief Create a pool of objects of a type
+ * @param type Type of the objects
+ * @param capacity Number of objects
+ * @return Pool*, NULL on error
+ */
+#define POOL_CREATE(type, capacity) pool_create(sizeof(type), capacity)
+
+/**
+ * @brief Create a Pool object
+ * @param item_size Size of an object
+ * @param capacity Number of objects
+ * @return Pool*, NULL on error
+ */
+Pool *pool_create(size_t item_size, int capacity);
+
+/**
+ * @brief Destroy the Pool object, the objects are not cleaned up
+ * @param pool Pool
+ */
+void pool_destroy(Pool *pool);
+
+/**
+ * @brief Take a free object, its content is whatever it was last time
+ * @param pool Pool
+ * @return Object, NULL when every object is used
+ */
+void *pool_acquire(Pool *pool);
+
+/**
+ * @brief Give an object back to the pool
+ * @param pool Pool
+ * @param item Object taken from this pool
+ */
+void pool_release(Pool *pool, void *item);
+
+/**
+ * @brief Give every object back to the pool
+ * @param pool Pool
+ */
+void pool_clear(Pool *pool);
+
+/**
+ * @brief Get an object by its index, to go through the used ones
+ * @param pool Pool
+ * @param index Index, from 0 to capacity - 1
+ * @return Object, NULL if it is free
+ */
+void *pool_get(Pool *pool, int index);
+
+/**
+ * @brief Copy the objects of a pool and which of them are in use
+ * @param destination Pool of the same item size and capacity
+ * @param source Pool
+ */
+void pool_copy(Pool *destination, Pool *source);
+
+/**
+ * @brief Number of objects in use
+ * @param pool Pool
+ * @return int
+ */
+int pool_count(Pool *pool);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include <SDL2/SDL.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "primitives.h"
+
+Primitives *primitives_create(void)
+{
+  Primitives *primitives = malloc(sizeof(Primitives));
+  if (primitives == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(primitives, 0, sizeof(Primitives));
+
+  return primitives;
+}
+
+void primitives_destroy(Primitives *primitives)
+{
+  if (primitives == NULL) return;
+
+  for (int i = 0; i <= PRIMITIVES_CACHE_RADIUS; i++) free(primitives->reaches[i]);
+  free(primitives->spans);
+  free(primitives);
+}
+
+// largest d with d * d <= value
+static int primitives_sqrt(int value)
+{
+  int d = (int) sqrt((double) value);
+  while (d * d > value) d--;
+  while ((d + 1) * (d + 1) <= value) d++;
+  return d;
+}
+
+// half width of the row of a disc at k rows from its center
+static int primitives_reach(Primitives *primitives, int radius, int k)
+{
+  if (radius <= PRIMITIVES_CACHE_RADIUS) {
+    Sint16 *reach = primitives->reaches[radius];
+    if (reach == NULL) {
+      reach = malloc(sizeof(Sint16) * (radius + 1));
+      if (reach == NULL) return primitives_sqrt(radius * radius - k * k);
+      for (int i = 0; i <= radius; i++) reach[i] = primitives_sqrt(radius * radius - i * i);
+      primitives->reaches[radius] = reach;
+    }
+    return reach[k];
+  }
+
+  // big shapes are rare, they are not worth a table each
+  return primitives_sqrt(radius * radius - k * k);
+}
+
+static bool primitives_push(Primitives *primitives, int y, int x1, int x2)
+{
+  if (x1 >= x2) return true;
+
+  if (primitives->count == primitives->capacity) {
+    int capacity = primitives->capacity == 0 ? 256 : primitives->capacity * 2;
+    Span *spans = realloc(primitives->spans, sizeof(Span) * capacity);
+    if (spans == NULL) {
+      fprintf(stderr, "Erreur d'allocation mémoire\n");
+      return false;
+    }
+    primitives->spans = spans;
+    primitives->capacity = capacity;
+  }
+
+  primitives->spans[primitives->count++] = (Span) { y, x1, x2 };
+  return true;
+}
+
+// a row of an outline, the outer run without the inner one
+static bool primitives_push_ring(Primitives *primitives, int y, int a, int b, int c, int d)
+{
+  if (c >= d) return primitives_push(primitives, y, a, b);
+  return primitives_push(primitives, y, a, c) && primitives_push(primitives, y, d, b);
+}
+
+// run of the disc at row dy, for dy from -radius + 1 to radius
+static void primitives_disc_row(Primitives *primitives, int radius, int dy, int *from, int *to)
+{
+  if (radius <= 0 || dy <= -radius || dy > radius) {
+    *from = *to = 0;
+    return;
+  }
+
+  int reach = primitives_reach(primitives, radius, abs(dy));
+  *from = -reach < -radius + 1 ? -radius + 1 : -reach;
+  *to = reach + 1;
+}
+
+bool primitives_circle(Primitives *primitives, int x, int y, int radius, bool filled)
+{
+  primitives->count = 0;
+
+  for (int dy = -radius + 1; dy <= radius; dy++) {
+    int a, b, c = 0, d = 0;
+    primitives_disc_row(primitives, radius, dy, &a, &b);
+    if (!filled) primitives_disc_row(primitives, radius - 1, dy, &c, &d);
+
+    if (!primitives_push_ring(primitives, y + dy, x + a, x + b, x + c, x + d)) return false;
+  }
+
+  return true;
+}
+
+// run of the rounded rectangle at row j, relative to its left side
+static void primitives_rounded_row(Primitives *primitives, int w, int h, int radius, int j, int *from, int *to)
+{
+  int inset = 0;
+  if (j < radius) {
+    inset = radius - primitives_reach(primitives, radius, radius - j - 1);
+  } else if (j >= h - radius) {
+    inset = radius - primitives_reach(primitives, radius, j - (h - radius));
+  }
+
+  *from = inset;
+  *to = w - inset;
+}
+
+bool primitives_rounded_rect(Primitives *primitives, const SDL_Rect *rect, int radius, bool filled)
+{
+  primitives->count = 0;
+  if (rect->w <= 0 || rect->h <= 0) return true;
+
+  int max_radius = (rect->w < rect->h ? rect->w : rect->h) / 2;
+  if (radius > max_radius) radius = max_radius;
+  if (radius < 0) radius = 0;
+
+  for (int j = 0; j < rect->h; j++) {
+    int a, b, c = 0, d = 0;
+    primitives_rounded_row(primitives, rect->w, rect->h, radius, j, &a, &b);
+
+    // the outline is what the rectangle inset by one pixel does not cover
+    if (!filled && j >= 1 && j < rect->h - 1 && rect->w > 2) {
+      int inner_radius = radius > 0 ? radius - 1 : 0;
+      primitives_rounded_row(primitives, rect->w - 2, rect->h - 2, inner_radius, j - 1, &c, &d);
+      c += 1;
+      d += 1;
+    }
+
+    if (!primitives_push_ring(primitives, rect->y + j, rect->x + a, rect->x + b, rect->x + c, rect->x + d)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool primitives_line(Primitives *primitives, int x1, int y1, int x2, int y2, int thickness)
+{
+  primitives->count = 0;
+  if (thickness < 1) thickness = 1;
+
+  // quad around the segment between the centers of both end pixels,
+  // going half the thickness past the ends so that they are covered
+  float ax = x1 + 0.5f, ay = y1 + 0.5f, bx = x2 + 0.5f, by = y2 + 0.5f;
+  float length = sqrtf((bx - ax) * (bx - ax) + (by - ay) * (by - ay));
+  float ux = 1, uy = 0;
+  if (length > 0) {
+    ux = (bx - ax) / length;
+    uy = (by - ay) / length;
+  }
+  float half = thickness / 2.0f;
+  float px = -uy * half, py = ux * half;
+  float qx = ux * half, qy = uy * half;
+
+  float corners[4][2] = {
+    { ax - qx + px, ay - qy + py },
+    { bx + qx + px, by + qy + py },
+    { bx + qx - px, by + qy - py },
+    { ax - qx - px, ay - qy - py }
+  };
+
+  float top = corners[0][1], bottom = corners[0][1];
+  for (int i = 1; i < 4; i++) {
+    if (corners[i][1] < top) top = corners[i][1];
+    if (corners[i][1] > bottom) bottom = corners[i][1];
+  }
+
+  // the quad is convex, each row crossing it is a single run
+  for (int y = (int) ceilf(top - 0.5f); y <= (int) floorf(bottom - 0.5f); y++) {
+    float center = y + 0.5f, left = INFINITY, right = -INFINITY;
+    for (int i = 0; i < 4; i++) {
+      const float *p = corners[i], *q = corners[(i + 1) % 4];
+      if (p[1] == q[1] || (center - p[1]) * (center - q[1]) > 0) continue;
+
+      float x = p[0] + (center - p[1]) * (q[0] - p[0]) / (q[1] - p[1]);
+      if (x < left) left = x;
+      if (x > right) right = x;
+    }
+    if (left > right) continue;
+
+    int from = (int) ceilf(left - 0.5f), to = (int) floorf(right - 0.5f) + 1;
+    if (!primitives_push(primitives, y, from, to)) return false;
+  }
+
+  return true;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+# ifndef PRIMITIVES_H
+# define PRIMITIVES_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// radii up to this one keep their row widths between frames
+#define PRIMITIVES_CACHE_RADIUS 64
+
+/**
+ * Horizontal run of pixels, from x1 included to x2 excluded
+ */
+typedef struct {
+  int y;
+  int x1, x2;
+} Span;
+
+typedef struct {
+  // spans of the last shape built, reused from one shape to the next
+  Span *spans;
+  int count, capacity;
+  // half width of each row of a disc, per radius, built on first use
+  Sint16 *reaches[PRIMITIVES_CACHE_RADIUS + 1];
+} Primitives;
+
+/**
+ * @brief Create a Primitives object
+ * @return Primitives*, NULL on error
+ */
+Primitives *primitives_create(void);
+
+/**
+ * @brief Destroy the Primitives object
+ * @param primitives Primitives
+ */
+void primitives_destroy(Primitives *primitives);
+
+/**
+ * @brief Build the spans of a circle, same pixels as a point by point test
+ * of the offsets from -radius + 1 to radius
+ * @param primitives Primitives, spans are in primitives->spans
+ * @param x X of the center
+ * @param y Y of the center
+ * @param radius Radius
+ * @param filled Disc, or only its one pixel outline
+ * @return true on success
+ */
+bool primitives_circle(Primitives *primitives, int x, int y, int radius, bool filled);
+
+/**
+ * @brief Build the spans of a rectangle with rounded corners
+ * @param primitives Primitives, spans are in primitives->spans
+ * @param rect Rectangle
+ * @param radius Corner radius, 0 for square corners
+ * @param filled Whole rectangle, or only its one pixel outline
+ * @return true on success
+ */
+bool primitives_rounded_rect(Primitives *primitives, const SDL_Rect *rect, int radius, bool filled);
+
+/**
+ * @brief Build the spans of a line, both ends included
+ * @param primitives Primitives, spans are in primitives->spans
+ * @param x1 X of the first end
+ * @param y1 Y of the first end
+ * @param x2 X of the second end
+ * @param y2 Y of the second end
+ * @param thickness Thickness in pixels
+ * @return true on success
+ */
+bool primitives_line(Primitives *primitives, int x1, int y1, int x2, int y2, int thickness);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include <SDL2/SDL.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "raster.h"
+#include "fixed.h"
+
+#define WHITE (SDL_Color) { 255, 255, 255, 255 }
+
+Raster *raster_create(int width, int height)
+{
+  Raster *raster = malloc(sizeof(Raster));
+  if (raster == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  raster->width = width;
+  raster->height = height;
+  raster->pitch = width * 4;
+  raster->pixels = malloc((size_t) raster->pitch * height);
+  raster->row = malloc(sizeof(Uint32) * width);
+  if (raster->pixels == NULL || raster->row == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    raster_destroy(raster);
+    return NULL;
+  }
+
+  return raster;
+}
+
+void raster_destroy(Raster *raster)
+{
+  if (raster == NULL) return;
+
+  free(raster->pixels);
+  free(raster->row);
+  free(raster);
+}
+
+static Uint32 raster_pack(SDL_Color color)
+{
+  // RGBA32 is a byte order, whatever the endianness
+  Uint8 bytes[4] = { color.r, color.g, color.b, color.a };
+  Uint32 pixel;
+  memcpy(&pixel, bytes, sizeof(pixel));
+  return pixel;
+}
+
+// x / 255 rounded, exact for every x up to 255 * 255
+static inline Uint32 raster_div255(Uint32 x)
+{
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+static void raster_blend_row_scalar(
+  Uint8 *dst,
+  const Uint8 *src,
+  int count,
+  SDL_Color color,
+  bool modulate
+) {
+  for (int i = 0; i < count; i++, dst += 4, src += 4) {
+    Uint32 r = src[0], g = src[1], b = src[2], a = src[3];
+    if (modulate) {
+      r = raster_div255(r * color.r);
+      g = raster_div255(g * color.g);
+      b = raster_div255(b * color.b);
+      a = raster_div255(a * color.a);
+    }
+    if (a == 0) continue;
+
+    // SDL_BLENDMODE_BLEND
+    Uint32 inverse = 255 - a;
+    dst[0] = raster_div255(r * a + dst[0] * inverse);
+    dst[1] = raster_div255(g * a + dst[1] * inverse);
+    dst[2] = raster_div255(b * a + dst[2] * inverse);
+    dst[3] = raster_div255(a * 255 + dst[3] * inverse);
+  }
+}
+
+#ifdef __SSE2__
+static inline __m128i raster_div255_sse2(__m128i x)
+{
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// two pixels, one channel per 16 bit lane
+static inline __m128i raster_blend_sse2(__m128i src, __m128i dst)
+{
+  const __m128i rgb_lanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+  const __m128i alpha_lanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+  __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xff), 0xff);
+  __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+  // the alpha channel itself is weighted by 255, not by alpha
+  __m128i weight = _mm_or_si128(_mm_and_si128(alpha, rgb_lanes), alpha_lanes);
+
+  return raster_div255_sse2(_mm_add_epi16(
+    _mm_mullo_epi16(src, weight),
+    _mm_mullo_epi16(dst, inverse)
+  ));
+}
+
+static void raster_blend_row_sse2(
+  Uint8 *dst,
+  const Uint8 *src,
+  int count,
+  SDL_Color color,
+  bool modulate
+) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_bytes = _mm_set1_epi32((int) 0xff000000);
+  const __m128i tint = _mm_set_epi16(
+    color.a, color.b, color.g, color.r,
+    color.a, color.b, color.g, color.r
+  );
+
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128((const __m128i *) (src + i * 4));
+    __m128i alpha = _mm_and_si128(s, alpha_bytes);
+
+    // whole blocks of transparent or opaque pixels are common in sprites
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xffff) continue;
+    if (!modulate && _mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alpha_bytes)) == 0xffff) {
+      _mm_storeu_si128((__m128i *) (dst + i * 4), s);
+      continue;
+    }
+
+    __m128i d = _mm_loadu_si128((const __m128i *) (dst + i * 4));
+    __m128i s_low = _mm_unpacklo_epi8(s, zero);
+    __m128i s_high = _mm_unpackhi_epi8(s, zero);
+    if (modulate) {
+      s_low = raster_div255_sse2(_mm_mullo_epi16(s_low, tint));
+      s_high = raster_div255_sse2(_mm_mullo_epi16(s_high, tint));
+    }
+
+    __m128i low = raster_blend_sse2(s_low, _mm_unpacklo_epi8(d, zero));
+    __m128i high = raster_blend_sse2(s_high, _mm_unpackhi_epi8(d, zero));
+    _mm_storeu_si128((__m128i *) (dst + i * 4), _mm_packus_epi16(low, high));
+  }
+
+  raster_blend_row_scalar(dst + i * 4, src + i * 4, count - i, color, modulate);
+}
+#endif
+
+static void raster_blend_row(
+  Uint8 *dst,
+  const Uint8 *src,
+  int count,
+  SDL_Color color,
+  bool modulate
+) {
+#ifdef __SSE2__
+  raster_blend_row_sse2(dst, src, count, color, modulate);
+#else
+  raster_blend_row_scalar(dst, src, count, color, modulate);
+#endif
+}
+
+static void raster_fill_span(Raster *raster, int x1, int x2, int y, SDL_Color color)
+{
+  if (y < 0 || y >= raster->height) return;
+  if (x1 < 0) x1 = 0;
+  if (x2 > raster->width) x2 = raster->width;
+  if (x1 >= x2) return;
+
+  Uint32 pixel = raster_pack(color);
+  Uint32 *out = (Uint32 *) (raster->pixels + y * raster->pitch);
+  if (color.a == 255) {
+    for (int x = x1; x < x2; x++) out[x] = pixel;
+    return;
+  }
+
+  // translucent, blended like any image row
+  for (int x = x1; x < x2; x++) raster->row[x - x1] = pixel;
+  raster_blend_row((Uint8 *) (out + x1), (const Uint8 *) raster->row, x2 - x1, WHITE, false);
+}
+
+void raster_clear(Raster *raster, SDL_Color color)
+{
+  SDL_Rect all = { 0, 0, raster->width, raster->height };
+  raster_fill_rect(raster, &all, color);
+}
+
+void raster_fill_rect(Raster *raster, const SDL_Rect *rect, SDL_Color color)
+{
+  for (int y = rect->y; y < rect->y + rect->h; y++) {
+    raster_fill_span(raster, rect->x, rect->x + rect->w, y, color);
+  }
+}
+
+int raster_draw(
+  Raster *raster,
+  SDL_Surface *image,
+  const SDL_Rect *src,
+  const SDL_FRect *dst,
+  double angle,
+  SDL_RendererFlip flip,
+  SDL_Color color
+) {
+  if (image == NULL || image->format->format != SDL_PIXELFORMAT_RGBA32) {
+    return SDL_SetError("[raster_draw] Image absente ou pas en RGBA32");
+  }
+
+  SDL_Rect whole = { 0, 0, image->w, image->h };
+  if (src == NULL) src = &whole;
+  if (src->w <= 0 || src->h <= 0 || dst->w <= 0 || dst->h <= 0) return 0;
+
+  float cos_a = 1, sin_a = 0;
+  if (angle != 0.0) {
+    // right angles are exact so that tiles stay pixel aligned
+    if (fmod(angle, 90.0) == 0.0) {
+      int quarter = ((int) (angle / 90.0) % 4 + 4) % 4;
+      static const float quarter_cos[] = { 1, 0, -1, 0 };
+      static const float quarter_sin[] = { 0, 1, 0, -1 };
+      cos_a = quarter_cos[quarter];
+      sin_a = quarter_sin[quarter];
+    } else {
+      double radians = angle * M_PI / 180.0;
+      cos_a = cos(radians);
+      sin_a = sin(radians);
+    }
+  }
+
+  float half_w = dst->w / 2, half_h = dst->h / 2;
+  float center_x = dst->x + half_w, center_y = dst->y + half_h;
+  float extent_x = fabsf(half_w * cos_a) + fabsf(half_h * sin_a);
+  float extent_y = fabsf(half_w * sin_a) + fabsf(half_h * cos_a);
+
+  // pixels whose center is inside the bounds of the rotated quad
+  int x1 = (int) ceilf(center_x - extent_x - 0.5f);
+  int x2 = (int) ceilf(center_x + extent_x - 0.5f);
+  int y1 = (int) ceilf(center_y - extent_y - 0.5f);
+  int y2 = (int) ceilf(center_y + extent_y - 0.5f);
+  if (x1 < 0) x1 = 0;
+  if (y1 < 0) y1 = 0;
+  if (x2 > raster->width) x2 = raster->width;
+  if (y2 > raster->height) y2 = raster->height;
+  if (x1 >= x2 || y1 >= y2) return 0;
+
+  // one pixel right on screen is (cos, -sin) in the unrotated quad
+  float scale_u = src->w / dst->w, scale_v = src->h / dst->h;
+  float step_u = cos_a * scale_u, step_v = -sin_a * scale_v;
+  if (flip & SDL_FLIP_HORIZONTAL) step_u = -step_u;
+  if (flip & SDL_FLIP_VERTICAL) step_v = -step_v;
+  fixed_t fixed_step_u = FIXED_FROM_FLOAT(step_u);
+  fixed_t fixed_step_v = FIXED_FROM_FLOAT(step_v);
+
+  bool modulate = color.r != 255 || color.g != 255 || color.b != 255 || color.a != 255;
+  const Uint8 *pixels = image->pixels;
+  int count = x2 - x1;
+
+  for (int y = y1; y < y2; y++) {
+    float rx = x1 + 0.5f - center_x, ry = y + 0.5f - center_y;
+    float u = (rx * cos_a + ry * sin_a + half_w) * scale_u;
+    float v = (-rx * sin_a + ry * cos_a + half_h) * scale_v;
+    if (flip & SDL_FLIP_HORIZONTAL) u = src->w - u;
+    if (flip & SDL_FLIP_VERTICAL) v = src->h - v;
+
+    fixed_t fixed_u = FIXED_FROM_FLOAT(u), fixed_v = FIXED_FROM_FLOAT(v);
+    int first_u = FIXED_TO_INT(fixed_u), first_v = FIXED_TO_INT(fixed_v);
+    Uint8 *out = raster->pixels + y * raster->pitch + x1 * 4;
+
+    // upright and unscaled, blend straight from the image
+    if (
+      fixed_step_u == FIXED_ONE && fixed_step_v == 0 &&
+      first_u >= 0 && first_u + count <= src->w &&
+      first_v >= 0 && first_v < src->h
+    ) {
+      const Uint8 *in = pixels + (src->y + first_v) * image->pitch + (src->x + first_u) * 4;
+      raster_blend_row(out, in, count, color, modulate);
+      continue;
+    }
+
+    // otherwise gather the row with nearest sampling, outside the quad is transparent
+    for (int i = 0; i < count; i++, fixed_u += fixed_step_u, fixed_v += fixed_step_v) {
+      int su = FIXED_TO_INT(fixed_u), sv = FIXED_TO_INT(fixed_v);
+      if ((unsigned) su < (unsigned) src->w && (unsigned) sv < (unsigned) src->h) {
+        memcpy(&raster->row[i], pixels + (src->y + sv) * image->pitch + (src->x + su) * 4, 4);
+      } else {
+        raster->row[i] = 0;
+      }
+    }
+    raster_blend_row(out, (const Uint8 *) raster->row, count, color, modulate);
+  }
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+# ifndef RASTER_H
+# define RASTER_H
+
+#include <SDL2/SDL.h>
+
+/**
+ * Framebuffer in system memory, drawn without any GPU or display.
+ * Pixels are SDL_PIXELFORMAT_RGBA32, bytes R, G, B, A in memory order.
+ */
+typedef struct {
+  Uint8 *pixels;
+  int width, height;
+  int pitch;
+  // source pixels of the row being drawn, once flipped, rotated or scaled
+  Uint32 *row;
+} Raster;
+
+/**
+ * @brief Create a Raster object
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @return Raster*, NULL on error
+ */
+Raster *raster_create(int width, int height);
+
+/**
+ * @brief Destroy the Raster object
+ * @param raster Raster
+ */
+void raster_destroy(Raster *raster);
+
+/**
+ * @brief Fill the whole framebuffer with a color
+ * @param raster Raster
+ * @param color SDL_Color
+ */
+void raster_clear(Raster *raster, SDL_Color color);
+
+/**
+ * @brief Fill a rectangle, blended when the color is translucent
+ * @param raster Raster
+ * @param rect Rectangle
+ * @param color SDL_Color
+ */
+void raster_fill_rect(Raster *raster, const SDL_Rect *rect, SDL_Color color);
+
+/**
+ * @brief Alpha blend a region of an image, like SDL_RenderCopyEx
+ * @param raster Raster
+ * @param image SDL_Surface in SDL_PIXELFORMAT_RGBA32
+ * @param src Source rect in the image, NULL for the whole image
+ * @param dst Destination rect
+ * @param angle Angle to rotate around the center of dst, in degrees
+ * @param flip Flip image
+ * @param color Color the image is modulated with
+ * @return 0 on success, a negative value on error
+ */
+int raster_draw(
+  Raster *raster,
+  SDL_Surface *image,
+  const SDL_Rect *src,
+  const SDL_FRect *dst,
+  double angle,
+  SDL_RendererFlip flip,
+  SDL_Color color
+);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "render_queue.h"
+
+RenderQueue *render_queue_create(SpriteBatch *batch)
+{
+  RenderQueue *queue = malloc(sizeof(RenderQueue));
+  if (queue == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  queue->batch = batch;
+  render_queue_reset(queue);
+
+  return queue;
+}
+
+void render_queue_destroy(RenderQueue *queue)
+{
+  free(queue);
+}
+
+void render_queue_reset(RenderQueue *queue)
+{
+  queue->count = 0;
+  queue->text_size = 0;
+  queue->texture_count = 0;
+}
+
+static int render_queue_texture_id(RenderQueue *queue, const void *texture)
+{
+  for (int i = 0; i < queue->texture_count; i++) {
+    if (queue->textures[i] == texture) return i;
+  }
+  // past the table, the remaining textures share the last id
+  if (queue->texture_count == RENDER_QUEUE_TEXTURES) return RENDER_QUEUE_TEXTURES;
+  queue->textures[queue->texture_count] = texture;
+  return queue->texture_count++;
+}
+
+// texture, or the surface of the software backend, NULL for solid quads
+static const void *render_queue_command_texture(const RenderCommand *command)
+{
+  switch (command->type)
+  {
+    case RENDER_COMMAND_SPRITE:
+      if (command->sprite.sprite.texture != NULL) return command->sprite.sprite.texture;
+      return command->sprite.sprite.surface;
+    case RENDER_COMMAND_TEXT:
+      if (command->text.atlas->sheet.texture != NULL) return command->text.atlas->sheet.texture;
+      return command->text.atlas->sheet.surface;
+    case RENDER_COMMAND_FILL:
+      break;
+  }
+  return NULL;
+}
+
+static RenderCommand *render_queue_push(RenderQueue *queue, RenderCommandType type, RenderLayer layer, SDL_Color color)
+{
+  if (queue->count == RENDER_QUEUE_CAPACITY && render_queue_submit(queue) != 0) return NULL;
+
+  RenderCommand *command = &queue->commands[queue->count];
+  command->type = type;
+  command->layer = layer;
+  command->color = color;
+  return command;
+}
+
+// layers whose draws never overlap, grouped by texture, see RenderLayer
+static const bool render_layer_is_sorted[] = {
+  [RENDER_LAYER_MAP] = true,
+  [RENDER_LAYER_ITEMS] = true,
+  [RENDER_LAYER_ENTITIES] = false,
+  [RENDER_LAYER_HUD] = false
+};
+
+// the key is only known once the command is filled in
+static void render_queue_commit(RenderQueue *queue)
+{
+  RenderCommand *command = &queue->commands[queue->count];
+  Uint64 texture = 0;
+  if (render_layer_is_sorted[command->layer]) {
+    texture = render_queue_texture_id(queue, render_queue_command_texture(command));
+  }
+  queue->keys[queue->count] = (Uint64) command->layer << 48 | texture << 32 | (Uint64) queue->count;
+  queue->count++;
+}
+
+int render_queue_sprite(
+  RenderQueue *queue,
+  RenderLayer layer,
+  const Sprite *sprite,
+  const SDL_Rect *src,
+  const SDL_FRect *dst,
+  double angle,
+  SDL_RendererFlip flip,
+  SDL_Color color
+) {
+  RenderCommand *command = render_queue_push(queue, RENDER_COMMAND_SPRITE, layer, color);
+  if (command == NULL) return -1;
+
+  command->sprite.sprite = *sprite;
+  command->sprite.src = src != NULL ? *src : sprite->rect;
+  command->sprite.dst = *dst;
+  command->sprite.angle = angle;
+  command->sprite.flip = flip;
+  render_queue_commit(queue);
+
+  return 0;
+}
+
+int render_queue_fill(
+  RenderQueue *queue,
+  RenderLayer layer,
+  const SDL_Rect *rect,
+  SDL_Color color
+) {
+  RenderCommand *command = render_queue_push(queue, RENDER_COMMAND_FILL, layer, color);
+  if (command == NULL) return -1;
+
+  command->fill = *rect;
+  render_queue_commit(queue);
+
+  return 0;
+}
+
+int render_queue_text(
+  RenderQueue *queue,
+  RenderLayer layer,
+  GlyphAtlas *atlas,
+  int x, int y,
+  const char *text,
+  SDL_Color color
+) {
+  int length = strlen(text) + 1;
+  if (length > RENDER_QUEUE_TEXT_SIZE) {
+    return SDL_SetError("[render_queue_text] Texte trop long");
+  }
+  if (queue->text_size + length > RENDER_QUEUE_TEXT_SIZE && render_queue_submit(queue) != 0) {
+    return -1;
+  }
+
+  RenderCommand *command = render_queue_push(queue, RENDER_COMMAND_TEXT, layer, color);
+  if (command == NULL) return -1;
+
+  command->text.atlas = atlas;
+  command->text.x = x;
+  command->text.y = y;
+  command->text.offset = queue->text_size;
+  memcpy(queue->text + queue->text_size, text, length);
+  queue->text_size += length;
+  render_queue_commit(queue);
+
+  return 0;
+}
+
+static int render_queue_compare(const void *a, const void *b)
+{
+  Uint64 key_a = *(const Uint64 *) a, key_b = *(const Uint64 *) b;
+  return (key_a > key_b) - (key_a < key_b);
+}
+
+static int render_queue_replay(RenderQueue *queue, const RenderCommand *command)
+{
+  switch (command->type)
+  {
+    case RENDER_COMMAND_SPRITE:
+      return sprite_batch_draw(
+        queue->batch,
+        &command->sprite.sprite,
+        &command->sprite.src,
+        &command->sprite.dst,
+        command->sprite.angle,
+        command->sprite.flip,
+        command->color
+      );
+    case RENDER_COMMAND_FILL:
+      return sprite_batch_fill(queue->batch, &command->fill, command->color);
+    case RENDER_COMMAND_TEXT:
+      return glyph_atlas_draw(
+        command->text.atlas,
+        queue->batch,
+        command->text.x,
+        command->text.y,
+        queue->text + command->text.offset,
+        command->color
+      );
+  }
+  return 0;
+}
+
+int render_queue_submit(RenderQueue *queue)
+{
+  // the recording order is in the low bits, keys are unique and the sort stable
+  qsort(queue->keys, queue->count, sizeof(Uint64), render_queue_compare);
+
+  int result = 0;
+  for (int i = 0; i < queue->count && result == 0; i++) {
+    result = render_queue_replay(queue, &queue->commands[queue->keys[i] & 0xffffffff]);
+  }
+
+  render_queue_reset(queue);
+  return result;
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+# ifndef RENDER_QUEUE_H
+# define RENDER_QUEUE_H
+
+#include <SDL2/SDL.h>
+
+#include "glyph_atlas.h"
+#include "sprite_atlas.h"
+#include "sprite_batch.h"
+
+#define RENDER_QUEUE_CAPACITY 4096
+#define RENDER_QUEUE_TEXT_SIZE 8192
+#define RENDER_QUEUE_TEXTURES 32
+
+/**
+ * Layers are drawn from the first to the last, whatever the order the
+ * commands were recorded in. Inside a layer:
+ * - RENDER_LAYER_MAP and RENDER_LAYER_ITEMS are grouped by texture, then
+ *   drawn in recording order, as nothing in them overlaps.
+ * - RENDER_LAYER_ENTITIES and RENDER_LAYER_HUD are drawn in recording
+ *   order alone. Their draws overlap on purpose, such as the eyes of an
+ *   eaten ghost, solid fills drawn over and under sprites.
+ */
+typedef enum {
+  RENDER_LAYER_MAP,
+  RENDER_LAYER_ITEMS,
+  RENDER_LAYER_ENTITIES,
+  RENDER_LAYER_HUD
+} RenderLayer;
+
+typedef enum {
+  RENDER_COMMAND_SPRITE,
+  RENDER_COMMAND_FILL,
+  RENDER_COMMAND_TEXT
+} RenderCommandType;
+
+/**
+ * One draw, plain data with no pointer into the caller's memory, so the
+ * commands can be kept, sorted and replayed later
+ */
+typedef struct {
+  RenderCommandType type;
+  RenderLayer layer;
+  SDL_Color color;
+  union {
+    struct {
+      Sprite sprite;
+      SDL_Rect src;
+      SDL_FRect dst;
+      float angle;
+      SDL_RendererFlip flip;
+    } sprite;
+    SDL_Rect fill;
+    struct {
+      GlyphAtlas *atlas;
+      int x, y;
+      // offset of the text in the text arena of the queue
+      int offset;
+    } text;
+  };
+} RenderCommand;
+
+typedef struct {
+  // where the commands are replayed
+  SpriteBatch *batch;
+  RenderCommand commands[RENDER_QUEUE_CAPACITY];
+  // layer, texture and recording order of each command, sorted on submit,
+  // the texture is left out in the layers drawn in recording order
+  Uint64 keys[RENDER_QUEUE_CAPACITY];
+  int count;
+  // strings of the text commands, reset every frame
+  char text[RENDER_QUEUE_TEXT_SIZE];
+  int text_size;
+  // textures in the order they were first seen this frame
+  const void *textures[RENDER_QUEUE_TEXTURES];
+  int texture_count;
+} RenderQueue;
+
+/**
+ * @brief Create a RenderQueue object
+ * @param batch SpriteBatch the commands are replayed in
+ * @return RenderQueue*, NULL on error
+ */
+RenderQueue *render_queue_create(SpriteBatch *batch);
+
+/**
+ * @brief Destroy the RenderQueue object
+ * @param queue RenderQueue
+ */
+void render_queue_destroy(RenderQueue *queue);
+
+/**
+ * @brief Forget every command recorded so far
+ * @param queue RenderQueue
+ */
+void render_queue_reset(RenderQueue *queue);
+
+/**
+ * @brief Record a textured quad
+ * @param queue RenderQueue
+ * @param layer RenderLayer
+ * @param sprite Sprite, copied into the command
+ * @param src Source rect in the texture, NULL for the sprite region
+ * @param dst Destination rect
+ * @param angle Angle to rotate around the center of dst, in degrees
+ * @param flip Flip image
+ * @param color Color the texture is modulated with
+ * @return 0 on success, a negative value on error
+ */
+int render_queue_sprite(
+  RenderQueue *queue,
+  RenderLayer layer,
+  const Sprite *sprite,
+  const SDL_Rect *src,
+  const SDL_FRect *dst,
+  double angle,
+  SDL_RendererFlip flip,
+  SDL_Color color
+);
+
+/**
+ * @brief Record a quad of a solid color
+ * @param queue RenderQueue
+ * @param layer RenderLayer
+ * @param rect Rectangle
+ * @param color SDL_Color
+ * @return 0 on success, a negative value on error
+ */
+int render_queue_fill(
+  RenderQueue *queue,
+  RenderLayer layer,
+  const SDL_Rect *rect,
+  SDL_Color color
+);
+
+/**
+ * @brief Record a text, copied into the queue
+ * @param queue RenderQueue
+ * @param layer RenderLayer
+ * @param atlas GlyphAtlas of the font
+ * @param x X of the left of the text
+ * @param y Y of the top of the text
+ * @param text Text
+ * @param color SDL_Color
+ * @return 0 on success, a negative value on error
+ */
+int render_queue_text(
+  RenderQueue *queue,
+  RenderLayer layer,
+  GlyphAtlas *atlas,
+  int x, int y,
+  const char *text,
+  SDL_Color color
+);
+
+/**
+ * @brief Sort the commands by layer, then by texture in the layers that
+ * allow it, and replay them in the sprite batch, the queue is empty
+ * afterwards
+ *
+ * Commands keep their recording order inside the same layer and texture.
+ * A full queue is submitted on its own before recording more.
+ *
+ * @param queue RenderQueue
+ * @return 0 on success, a negative value on error
+ */
+int render_queue_submit(RenderQueue *queue);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+
+#define REPLAY_INITIAL_CAPACITY 64
+#define REPLAY_KEY_COUNT 6
+
+static const char *replay_key_names[REPLAY_KEY_COUNT] = {
+  "up", "down", "left", "right", "space", "escape"
+};
+
+static const SDL_Scancode replay_key_codes[REPLAY_KEY_COUNT] = {
+  SDL_SCANCODE_UP,
+  SDL_SCANCODE_DOWN,
+  SDL_SCANCODE_LEFT,
+  SDL_SCANCODE_RIGHT,
+  SDL_SCANCODE_SPACE,
+  SDL_SCANCODE_ESCAPE
+};
+
+static Replay *replay_new(ReplayMode mode)
+{
+  Replay *replay = malloc(sizeof(Replay));
+  if (replay == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(replay, 0, sizeof(Replay));
+  replay->mode = mode;
+
+  return replay;
+}
+
+static bool replay_add(Replay *replay, Uint32 tick, Uint8 held)
+{
+  if (replay->count == replay->capacity) {
+    int capacity = replay->capacity == 0 ? REPLAY_INITIAL_CAPACITY : replay->capacity * 2;
+    ReplayEvent *events = realloc(replay->events, sizeof(ReplayEvent) * capacity);
+    if (events == NULL) {
+      fprintf(stderr, "Erreur d'allocation mémoire\n");
+      return false;
+    }
+    replay->events = events;
+    replay->capacity = capacity;
+  }
+
+  replay->events[replay->count++] = (ReplayEvent) { tick, held };
+  return true;
+}
+
+// keys held from a line of names, -1 for the end of the replay
+static int replay_parse_keys(char *names)
+{
+  int held = 0;
+  for (char *name = strtok(names, " \t\r\n"); name != NULL; name = strtok(NULL, " \t\r\n")) {
+    if (strcmp(name, "end") == 0) return -1;
+    if (strcmp(name, "none") == 0) continue;
+
+    int key = 0;
+    while (key < REPLAY_KEY_COUNT && strcmp(name, replay_key_names[key]) != 0) key++;
+    if (key == REPLAY_KEY_COUNT) {
+      fprintf(stderr, "[replay_parse_keys] Touche inconnue : %s\n", name);
+      continue;
+    }
+    held |= 1 << key;
+  }
+  return held;
+}
+
+Replay *replay_load(const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL) {
+    fprintf(stderr, "Erreur d'ouverture du fichier %s\n", path);
+    return NULL;
+  }
+
+  Replay *replay = replay_new(REPLAY_PLAY);
+  if (replay == NULL) {
+    fclose(fp);
+    return NULL;
+  }
+
+  char line[256];
+  bool has_end = false;
+  while (!has_end && fgets(line, sizeof(line), fp) != NULL) {
+    if (line[0] == '#' || line[0] == '\n') continue;
+    if (sscanf(line, "seed %u", &replay->seed) == 1) continue;
+
+    unsigned int tick;
+    int length;
+    if (sscanf(line, "%u%n", &tick, &length) != 1) continue;
+
+    int held = replay_parse_keys(line + length);
+    if (held < 0) {
+      replay->end_tick = tick;
+      has_end = true;
+    } else if (!replay_add(replay, tick, held)) {
+      replay_destroy(replay);
+      fclose(fp);
+      return NULL;
+    }
+  }
+  fclose(fp);
+
+  if (!has_end) {
+    fprintf(stderr, "[replay_load] Replay sans fin : %s\n", path);
+    replay_destroy(replay);
+    return NULL;
+  }
+
+  return replay;
+}
+
+Replay *replay_record(const char *path, unsigned int seed)
+{
+  Replay *replay = replay_new(REPLAY_RECORD);
+  if (replay == NULL) return NULL;
+
+  replay->output = fopen(path, "w");
+  if (replay->output == NULL) {
+    fprintf(stderr, "Erreur d'ouverture du fichier %s\n", path);
+    replay_destroy(replay);
+    return NULL;
+  }
+  replay->seed = seed;
+  fprintf(replay->output, "# pacman replay\nseed %u\n", seed);
+
+  return replay;
+}
+
+void replay_destroy(Replay *replay)
+{
+  if (replay == NULL) return;
+
+  if (replay->output != NULL) {
+    fprintf(replay->output, "%u end\n", replay->tick);
+    fclose(replay->output);
+  }
+  free(replay->events);
+  free(replay);
+}
+
+static void replay_write(Replay *replay, Uint8 held)
+{
+  fprintf(replay->output, "%u", replay->tick);
+  if (held == 0) fprintf(replay->output, " none");
+  for (int key = 0; key < REPLAY_KEY_COUNT; key++) {
+    if (held & (1 << key)) fprintf(replay->output, " %s", replay_key_names[key]);
+  }
+  fprintf(replay->output, "\n");
+}
+
+void replay_tick(Replay *replay, const Uint8 **keys)
+{
+  if (replay == NULL) return;
+
+  if (replay->mode == REPLAY_RECORD) {
+    // only the changes are written
+    Uint8 held = 0;
+    for (int key = 0; key < REPLAY_KEY_COUNT; key++) {
+      if ((*keys)[replay_key_codes[key]]) held |= 1 << key;
+    }
+    if (held != replay->held || replay->tick == 0) replay_write(replay, held);
+    replay->held = held;
+  } else {
+    while (replay->next < replay->count && replay->events[replay->next].tick <= replay->tick) {
+      replay->held = replay->events[replay->next++].held;
+    }
+    for (int key = 0; key < REPLAY_KEY_COUNT; key++) {
+      replay->keys[replay_key_codes[key]] = (replay->held >> key) & 1;
+    }
+    *keys = replay->keys;
+  }
+
+  replay->tick++;
+}
+
+bool replay_is_finished(Replay *replay)
+{
+  return replay->mode == REPLAY_PLAY && replay->tick >= replay->end_tick;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+# ifndef REPLAY_H
+# define REPLAY_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * Keys held by the player, tick by tick. A replay file is made of lines
+ * "TICK KEY..." giving the keys held from that tick on, KEY being one of
+ * up, down, left, right, space, escape or none, then a last "TICK end".
+ * With the seed of the simulation on its own line "seed N", a replay plays
+ * the same game again.
+ */
+typedef enum {
+  REPLAY_RECORD,
+  REPLAY_PLAY
+} ReplayMode;
+
+typedef struct {
+  Uint32 tick;
+  // one bit per key of the replay key list
+  Uint8 held;
+} ReplayEvent;
+
+typedef struct {
+  ReplayMode mode;
+  unsigned int seed;
+  ReplayEvent *events;
+  int count, capacity;
+  // next event to play
+  int next;
+  Uint32 tick, end_tick;
+  Uint8 held;
+  // keyboard state read by the game while playing
+  Uint8 keys[SDL_NUM_SCANCODES];
+  FILE *output;
+} Replay;
+
+/**
+ * @brief Load a replay to play it
+ * @param path Path of the replay
+ * @return Replay*, NULL on error
+ */
+Replay *replay_load(const char *path);
+
+/**
+ * @brief Start recording a replay
+ * @param path Path of the replay
+ * @param seed Seed given to simulation_seed() for this game
+ * @return Replay*, NULL on error
+ */
+Replay *replay_record(const char *path, unsigned int seed);
+
+/**
+ * @brief Destroy the Replay object, a recording is ended at the current tick
+ * @param replay Replay
+ */
+void replay_destroy(Replay *replay);
+
+/**
+ * @brief Start of a tick: record the keys held, or make the game read the
+ * keys of the replay instead of the keyboard
+ * @param replay Replay
+ * @param keys Keyboard state of the game
+ */
+void replay_tick(Replay *replay, const Uint8 **keys);
+
+/**
+ * @brief Check if every tick of a replay was played
+ * @param replay Replay
+ * @return true once finished
+ */
+bool replay_is_finished(Replay *replay);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rollback.h"
+#include "game.h"
+#include "net.h"
+#include "net_protocol.h"
+#include "pool.h"
+
+static const char *rollback_role_names[] = { "Pac-Man", "ghost" };
+
+bool rollback_state_init(RollbackState *state)
+{
+  memset(state, 0, sizeof(RollbackState));
+  state->bonuses = POOL_CREATE(Bonus, BONUS_POOL_CAPACITY);
+  return state->bonuses != NULL;
+}
+
+void rollback_state_free(RollbackState *state)
+{
+  pool_destroy(state->bonuses);
+  state->bonuses = NULL;
+}
+
+void rollback_save(Game *game, RollbackState *state)
+{
+  state->simulation = simulation;
+  state->score = game->score;
+  state->level = game->level;
+  state->state = game->state;
+  state->is_paused = game->is_paused;
+  state->start_button_animation_frame = game->start_button_animation_frame;
+  state->number_of_dot = game->number_of_dot;
+  state->number_of_power_pellet = game->number_of_power_pellet;
+
+  // the sprites are copied too, they stay the same
+  state->player = *game->player;
+  for (int i = 0; i < GHOST_AMOUNT; i++) state->ghosts[i] = *game->ghosts[i];
+  state->ghost_house = *game->ghost_house;
+  pool_copy(state->bonuses, game->bonuses);
+
+  Map *map = game->map;
+  for (int x = 0; x < map->cols; x++) {
+    for (int y = 0; y < map->rows; y++) state->tiles[x * map->rows + y] = map->map[x][y];
+  }
+}
+
+void rollback_load(Game *game, RollbackState *state)
+{
+  simulation = state->simulation;
+  game->score = state->score;
+  game->level = state->level;
+  game->state = state->state;
+  game->is_paused = state->is_paused;
+  game->start_button_animation_frame = state->start_button_animation_frame;
+  game->number_of_dot = state->number_of_dot;
+  game->number_of_power_pellet = state->number_of_power_pellet;
+
+  *game->player = state->player;
+  for (int i = 0; i < GHOST_AMOUNT; i++) *game->ghosts[i] = state->ghosts[i];
+  *game->ghost_house = state->ghost_house;
+  pool_copy(game->bonuses, state->bonuses);
+
+  // every level loads the same map again, only its tiles change
+  Map *map = game->map;
+  for (int x = 0; x < map->cols; x++) {
+    for (int y = 0; y < map->rows; y++) map->map[x][y] = state->tiles[x * map->rows + y];
+  }
+}
+
+// FNV-1a
+static Uint32 rollback_hash(Uint32 hash, const void *data, size_t size)
+{
+  const Uint8 *bytes = data;
+  for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;
+  return hash;
+}
+
+#define ROLLBACK_HASH(hash, value) rollback_hash(hash, &(value), sizeof(value))
+
+Uint32 rollback_checksum(Game *game)
+{
+  // field by field, the padding of the structures is not part of the state
+  Uint32 hash = 2166136261u;
+  hash = ROLLBACK_HASH(hash, simulation.tick);
+  hash = ROLLBACK_HASH(hash, simulation.random);
+  hash = ROLLBACK_HASH(hash, game->score);
+  hash = ROLLBACK_HASH(hash, game->level);
+  hash = ROLLBACK_HASH(hash, game->state);
+
+  Player *player = game->player;
+  hash = ROLLBACK_HASH(hash, player->pos_x);
+  hash = ROLLBACK_HASH(hash, player->pos_y);
+  hash = ROLLBACK_HASH(hash, player->direction);
+  hash = ROLLBACK_HASH(hash, player->lives);
+  hash = ROLLBACK_HASH(hash, player->invincible);
+  hash = ROLLBACK_HASH(hash, player->number_of_dots_eaten);
+
+  for (int i = 0; i < GHOST_AMOUNT; i++) {
+    Ghost *ghost = game->ghosts[i];
+    hash = ROLLBACK_HASH(hash, ghost->pos_x);
+    hash = ROLLBACK_HASH(hash, ghost->pos_y);
+    hash = ROLLBACK_HASH(hash, ghost->direction);
+    hash = ROLLBACK_HASH(hash, ghost->is_active);
+    hash = ROLLBACK_HASH(hash, ghost->is_eaten);
+  }
+  hash = ROLLBACK_HASH(hash, game->ghost_house->dot_counters);
+  hash = ROLLBACK_HASH(hash, game->ghost_house->idle_ticks);
+
+  for (int i = 0; i < BONUS_POOL_CAPACITY; i++) {
+    Bonus *bonus = pool_get(game->bonuses, i);
+    if (bonus == NULL) continue;
+    hash = ROLLBACK_HASH(hash, bonus->x);
+    hash = ROLLBACK_HASH(hash, bonus->y);
+    hash = ROLLBACK_HASH(hash, bonus->is_activate);
+  }
+
+  Map *map = game->map;
+  for (int x = 0; x < map->cols; x++) hash = rollback_hash(hash, map->map[x], sizeof(int) * map->rows);
+
+  return hash;
+}
+
+void rollback_start(Game *game)
+{
+  simulation_seed(ROLLBACK_SEED);
+  game_reset(game);
+  game->ghosts[NET_CONTROLLED_GHOST]->wanted_direction = GHOST_NULL;
+}
+
+void rollback_simulate(Game *game, Uint8 pacman_keys, Uint8 ghost_keys)
+{
+  // only the keys of the input frames are ever set, the others stay released
+  static Uint8 keyboard[SDL_NUM_SCANCODES];
+  net_keys_to_keyboard(pacman_keys, keyboard);
+  game->keys = keyboard;
+
+  Ghost *ghost = game->ghosts[NET_CONTROLLED_GHOST];
+  ghost->is_controlled = true;
+  ghost->wanted_direction = net_keys_to_ghost_direction(ghost_keys, ghost->wanted_direction);
+
+  game_update(game, (float) UPDATE_CAP);
+}
+
+Rollback *rollback_create(Game *game, const char *address, bool is_host)
+{
+  if (game->map->cols * game->map->rows > NET_MAX_TILES) {
+    fprintf(stderr, "[rollback_create] Carte trop grande pour le réseau\n");
+    return NULL;
+  }
+
+  Rollback *rollback = malloc(sizeof(Rollback));
+  if (rollback == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+  memset(rollback, 0, sizeof(Rollback));
+
+  for (int i = 0; i < ROLLBACK_WINDOW; i++) {
+    if (!rollback_state_init(&rollback->states[i])) {
+      rollback_destroy(rollback);
+      return NULL;
+    }
+  }
+
+  rollback->socket = net_socket_open(address, is_host);
+  if (rollback->socket == NULL) {
+    rollback_destroy(rollback);
+    return NULL;
+  }
+
+  rollback->game = game;
+  rollback->role = is_host ? NET_ROLE_PACMAN : NET_ROLE_GHOST;
+  // the host learns the address of the other side from its first datagram
+  rollback->has_peer = !is_host;
+  rollback->last_received = SDL_GetTicks();
+
+  // a score would be saved again on every rewind past it
+  rollback->scores = game->scores;
+  game->scores = NULL;
+  rollback_start(game);
+
+  if (is_host) printf("Waiting for the other side on %s\n", address);
+  else printf("Joining %s\n", address);
+  return rollback;
+}
+
+void rollback_destroy(Rollback *rollback)
+{
+  if (rollback == NULL) return;
+
+  if (rollback->tick > 0) {
+    RollbackStats *stats = &rollback->stats;
+    double frequency = (double) SDL_GetPerformanceFrequency();
+    printf(
+      "Rollback (%s): %u ticks, %u rewinds, %u ticks run again, %u at most, worst rewind %.1f us, %.2f us per tick run again, %u stalls\n",
+      rollback_role_names[rollback->role],
+      rollback->tick,
+      stats->rollbacks,
+      stats->resimulated,
+      stats->max_depth,
+      stats->max_resimulation_time * 1e6 / frequency,
+      stats->resimulated > 0 ? stats->resimulation_time * 1e6 / frequency / stats->resimulated : 0.0,
+      stats->stalls
+    );
+  }
+
+  if (rollback->game != NULL) rollback->game->scores = rollback->scores;
+  for (int i = 0; i < ROLLBACK_WINDOW; i++) rollback_state_free(&rollback->states[i]);
+  net_socket_close(rollback->socket);
+  free(rollback);
+}
+
+// the keys of the other side are expected to stay as they were last known
+static Uint8 rollback_prediction(Rollback *rollback)
+{
+  if (rollback->confirmed == 0) return 0;
+  return rollback->remote_keys[(rollback->confirmed - 1) % ROLLBACK_INPUT_HISTORY];
+}
+
+static void rollback_run(Rollback *rollback, Uint32 tick)
+{
+  Uint8 local = rollback->local_keys[tick % ROLLBACK_INPUT_HISTORY];
+  Uint8 remote = rollback->remote_keys[tick % ROLLBACK_INPUT_HISTORY];
+
+  if (rollback->role == NET_ROLE_PACMAN) rollback_simulate(rollback->game, local, remote);
+  else rollback_simulate(rollback->game, remote, local);
+}
+
+// back to the state before a tick, then every tick since is run again
+static void rollback_resimulate(Rollback *rollback, Uint32 from)
+{
+  Uint64 start = SDL_GetPerformanceCounter();
+
+  rollback_load(rollback->game, &rollback->states[from % ROLLBACK_WINDOW]);
+  Uint8 prediction = rollback_prediction(rollback);
+  for (Uint32 tick = from; tick < rollback->tick; tick++) {
+    if (tick >= rollback->confirmed) rollback->remote_keys[tick % ROLLBACK_INPUT_HISTORY] = prediction;
+    if (tick > from) rollback_save(rollback->game, &rollback->states[tick % ROLLBACK_WINDOW]);
+    rollback_run(rollback, tick);
+  }
+
+  Uint64 time = SDL_GetPerformanceCounter() - start;
+  RollbackStats *stats = &rollback->stats;
+  Uint32 depth = rollback->tick - from;
+  stats->rollbacks++;
+  stats->resimulated += depth;
+  if (depth > stats->max_depth) stats->max_depth = depth;
+  stats->resimulation_time += time;
+  if (time > stats->max_resimulation_time) stats->max_resimulation_time = time;
+}
+
+static void rollback_receive(Rollback *rollback)
+{
+  Uint8 data[NET_PACKET_SIZE];
+  NetAddress from;
+  int size;
+  // first tick run on a wrong prediction
+  Uint32 mismatch = rollback->tick;
+
+  while ((size = net_socket_receive(rollback->socket, data, &from)) > 0) {
+    NetInputs inputs;
+    if (!net_inputs_read(&inputs, data, size)) continue;
+
+    if (rollback->socket->is_server) {
+      if (!rollback->has_peer) {
+        rollback->socket->peer = from;
+        rollback->has_peer = true;
+        printf("The ghost joined\n");
+      } else if (!net_address_equal(&from, &rollback->socket->peer)) {
+        // a third one, versus is for two
+        continue;
+      }
+    }
+    rollback->last_received = SDL_GetTicks();
+
+    if (inputs.ack > rollback->remote_ack && inputs.ack <= rollback->tick) rollback->remote_ack = inputs.ack;
+    Uint32 latest = inputs.start + inputs.count;
+    if (latest > rollback->remote_tick) {
+      rollback->remote_tick = latest;
+      rollback->remote_advantage = (Sint32) (latest - inputs.ack);
+    }
+
+    // taken in order only, a gap is filled by a later datagram
+    for (int i = 0; i < inputs.count; i++) {
+      Uint32 tick = inputs.start + i;
+      if (tick != rollback->confirmed) continue;
+
+      Uint8 keys = inputs.keys[i];
+      Uint8 *predicted = &rollback->remote_keys[tick % ROLLBACK_INPUT_HISTORY];
+      if (tick < rollback->tick && *predicted != keys && tick < mismatch) mismatch = tick;
+      *predicted = keys;
+      rollback->confirmed++;
+    }
+  }
+
+  if (mismatch < rollback->tick) rollback_resimulate(rollback, mismatch);
+}
+
+static bool rollback_can_advance(Rollback *rollback)
+{
+  if (!rollback->has_peer) return false;
+  if (rollback->end_tick != 0 && rollback->tick >= rollback->end_tick) return false;
+
+  // the state before the first tick predicted must still be there to go back to
+  if ((Sint32) (rollback->tick - rollback->confirmed) >= ROLLBACK_WINDOW) return false;
+
+  // further ahead of the other side than it is of us, wait for it a tick
+  Sint32 local_advantage = (Sint32) (rollback->tick - rollback->remote_tick);
+  return local_advantage - rollback->remote_advantage < 2;
+}
+
+static void rollback_send(Rollback *rollback)
+{
+  if (!rollback->has_peer) return;
+
+  // every tick the other side has not acknowledged, oldest first
+  NetInputs inputs;
+  inputs.ack = rollback->confirmed;
+  inputs.start = rollback->remote_ack;
+  inputs.count = SDL_min(rollback->tick - rollback->remote_ack, NET_MAX_INPUTS);
+  for (int i = 0; i < inputs.count; i++) {
+    inputs.keys[i] = rollback->local_keys[(inputs.start + i) % ROLLBACK_INPUT_HISTORY];
+  }
+
+  Uint8 data[NET_PACKET_SIZE];
+  int size = net_inputs_write(&inputs, data);
+  net_socket_send(rollback->socket, data, size, NULL);
+}
+
+bool rollback_update(Rollback *rollback, Uint8 keys)
+{
+  rollback_receive(rollback);
+
+  bool can_advance = rollback_can_advance(rollback);
+  if (can_advance) {
+    Uint32 tick = rollback->tick;
+    rollback->local_keys[tick % ROLLBACK_INPUT_HISTORY] = keys;
+    // already known when the other side is ahead
+    if (tick >= rollback->confirmed) {
+      rollback->remote_keys[tick % ROLLBACK_INPUT_HISTORY] = rollback_prediction(rollback);
+    }
+
+    rollback_save(rollback->game, &rollback->states[tick % ROLLBACK_WINDOW]);
+    rollback_run(rollback, tick);
+    rollback->tick++;
+  } else if (rollback->has_peer && (rollback->end_tick == 0 || rollback->tick < rollback->end_tick)) {
+    rollback->stats.stalls++;
+  }
+
+  rollback_send(rollback);
+  return can_advance;
+}
+
+bool rollback_is_lost(Rollback *rollback)
+{
+  return rollback->has_peer && SDL_GetTicks() - rollback->last_received > ROLLBACK_TIMEOUT_MS;
+}
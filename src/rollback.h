@@ -0,0 +1,163 @@
+# ifndef ROLLBACK_H
+# define ROLLBACK_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "game.h"
+#include "net.h"
+#include "net_protocol.h"
+#include "pool.h"
+
+// states kept, the deepest rewind in ticks
+#define ROLLBACK_WINDOW 16
+// keys kept per side, enough for the window and a datagram of inputs
+#define ROLLBACK_INPUT_HISTORY 64
+// both sides start from the same game, see rollback_start
+#define ROLLBACK_SEED 0x5eed
+// no datagram from the other side for that long, it is gone
+#define ROLLBACK_TIMEOUT_MS 5000
+
+/**
+ * Everything a tick of the game logic changes. The sprites, the window
+ * and the caches are left out, they are the same whatever the tick.
+ */
+typedef struct {
+  Simulation simulation;
+  int score, level;
+  GameState state;
+  bool is_paused;
+  int start_button_animation_frame;
+  int number_of_dot, number_of_power_pellet;
+  Player player;
+  Ghost ghosts[GHOST_AMOUNT];
+  GhostHouse ghost_house;
+  Pool *bonuses;
+  Uint8 tiles[NET_MAX_TILES];
+} RollbackState;
+
+typedef struct {
+  // rewinds, and the ticks run again for them
+  Uint32 rollbacks, resimulated;
+  Uint32 max_depth;
+  // ticks not run, to wait for the other side
+  Uint32 stalls;
+  // time spent running ticks again, in performance counter units
+  Uint64 resimulation_time, max_resimulation_time;
+} RollbackStats;
+
+/**
+ * Versus over the network, Pac-Man on the host and the ghost on the other
+ * side, each running the whole game. The keys of the other side are
+ * predicted to stay the same. When the real ones differ, the state from
+ * before the first wrong tick is restored and the ticks since are run
+ * again within the frame, so that nobody waits for the network.
+ */
+typedef struct {
+  Game *game;
+  NetSocket *socket;
+  NetRole role;
+  bool has_peer;
+  // next tick to run
+  Uint32 tick;
+  // no tick past this one when not 0, for tests
+  Uint32 end_tick;
+  // state before the tick, by tick % ROLLBACK_WINDOW
+  RollbackState states[ROLLBACK_WINDOW];
+  // by tick % ROLLBACK_INPUT_HISTORY, the remote ones predicted past confirmed
+  Uint8 local_keys[ROLLBACK_INPUT_HISTORY];
+  Uint8 remote_keys[ROLLBACK_INPUT_HISTORY];
+  // keys of the other side known for every tick before this one
+  Uint32 confirmed;
+  // the other side has our keys for every tick before this one
+  Uint32 remote_ack;
+  // last tick the other side ran, and how far ahead of us it thought it was
+  Uint32 remote_tick;
+  Sint32 remote_advantage;
+  Uint32 last_received;
+  // not saved by both sides, the scores of the game are put back on destroy
+  ScoreStore *scores;
+  RollbackStats stats;
+} Rollback;
+
+/**
+ * @brief Create a Rollback object, start the game again from ROLLBACK_SEED
+ * @param game Game
+ * @param address See net_socket_open
+ * @param is_host Wait for the other side on address and play Pac-Man,
+ * or join it and play the ghost
+ * @return Rollback*, NULL on error
+ */
+Rollback *rollback_create(Game *game, const char *address, bool is_host);
+
+/**
+ * @brief Destroy the Rollback object and print its statistics
+ * @param rollback Rollback
+ */
+void rollback_destroy(Rollback *rollback);
+
+/**
+ * @brief One tick: read the keys of the other side, rewind if a prediction
+ * was wrong, run the tick with the local keys and send them
+ * @param rollback Rollback
+ * @param keys Local NetKey bits
+ * @return false if the tick was not run, to wait for the other side
+ */
+bool rollback_update(Rollback *rollback, Uint8 keys);
+
+/**
+ * @brief Check if the other side went silent for ROLLBACK_TIMEOUT_MS
+ * @param rollback Rollback
+ * @return true if it did
+ */
+bool rollback_is_lost(Rollback *rollback);
+
+/**
+ * @brief Start the game again from ROLLBACK_SEED, as the other side does
+ * @param game Game
+ */
+void rollback_start(Game *game);
+
+/**
+ * @brief Run one tick of the game with the keys of both players
+ * @param game Game
+ * @param pacman_keys NetKey bits of Pac-Man
+ * @param ghost_keys NetKey bits of the ghost
+ */
+void rollback_simulate(Game *game, Uint8 pacman_keys, Uint8 ghost_keys);
+
+/**
+ * @brief Allocate the storage of a state
+ * @param state RollbackState
+ * @return false on error
+ */
+bool rollback_state_init(RollbackState *state);
+
+/**
+ * @brief Free the storage of a state
+ * @param state RollbackState
+ */
+void rollback_state_free(RollbackState *state);
+
+/**
+ * @brief Copy the state of the game
+ * @param game Game
+ * @param state RollbackState, from rollback_state_init
+ */
+void rollback_save(Game *game, RollbackState *state);
+
+/**
+ * @brief Put the game back in a saved state
+ * @param game Game
+ * @param state RollbackState
+ */
+void rollback_load(Game *game, RollbackState *state);
+
+/**
+ * @brief Hash the state of the game, equal on both sides once in sync
+ * @param game Game
+ * @return Uint32
+ */
+Uint32 rollback_checksum(Game *game);
+
+# endif
\ No newline at end of file
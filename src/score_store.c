@@ -0,0 +1,392 @@
+#include <SDL2/SDL.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "score_store.h"
+
+#define SCORE_STORE_INITIAL_CAPACITY 64
+#define SCORE_STORE_READ_CHUNK 4096
+
+static Uint32 score_record_checksum(const ScoreRecord *record)
+{
+  const Uint8 *bytes = (const Uint8 *) record;
+  Uint32 hash = 2166136261u;
+  for (size_t i = 0; i < offsetof(ScoreRecord, checksum); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+// a file created or cut is only durable once its directory is synced too
+static void score_store_sync_directory(const char *path)
+{
+  char directory[1024];
+  const char *slash = strrchr(path, '/');
+  if (slash == NULL || (size_t) (slash - path) >= sizeof(directory)) {
+    strcpy(directory, ".");
+  } else {
+    memcpy(directory, path, slash - path);
+    directory[slash - path] = '\0';
+    if (directory[0] == '\0') strcpy(directory, "/");
+  }
+
+  int fd = open(directory, O_RDONLY);
+  if (fd < 0) return;
+  fsync(fd);
+  close(fd);
+}
+
+static Uint32 score_store_random(ScoreStore *store)
+{
+  // xorshift32, the random numbers of the game are left alone
+  Uint32 x = store->seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return store->seed = x;
+}
+
+static Uint32 score_node_size(ScoreStore *store, Sint32 node)
+{
+  return node < 0 ? 0 : store->nodes[node].size;
+}
+
+static void score_node_update(ScoreStore *store, Sint32 node)
+{
+  ScoreNode *n = &store->nodes[node];
+  n->size = 1 + score_node_size(store, n->left) + score_node_size(store, n->right);
+}
+
+// best score first, the newest first between equal scores
+static bool score_store_before(ScoreStore *store, Sint32 a, Sint32 b)
+{
+  Sint32 score_a = store->records[a].score, score_b = store->records[b].score;
+  return score_a > score_b || (score_a == score_b && a > b);
+}
+
+// the nodes ranked before key go to left, the others to right
+static void score_store_split(ScoreStore *store, Sint32 node, Sint32 key, Sint32 *left, Sint32 *right)
+{
+  if (node < 0) {
+    *left = *right = -1;
+    return;
+  }
+
+  if (score_store_before(store, node, key)) {
+    score_store_split(store, store->nodes[node].right, key, &store->nodes[node].right, right);
+    *left = node;
+  } else {
+    score_store_split(store, store->nodes[node].left, key, left, &store->nodes[node].left);
+    *right = node;
+  }
+  score_node_update(store, node);
+}
+
+static Sint32 score_store_insert_node(ScoreStore *store, Sint32 node, Sint32 key)
+{
+  if (node < 0) return key;
+
+  ScoreNode *n = &store->nodes[node];
+  if (store->nodes[key].priority > n->priority) {
+    score_store_split(store, node, key, &store->nodes[key].left, &store->nodes[key].right);
+    score_node_update(store, key);
+    return key;
+  }
+
+  if (score_store_before(store, key, node)) {
+    n->left = score_store_insert_node(store, n->left, key);
+  } else {
+    n->right = score_store_insert_node(store, n->right, key);
+  }
+  score_node_update(store, node);
+  return node;
+}
+
+// add a record to the index only, returns its rank from 1
+static int score_store_add(ScoreStore *store, const ScoreRecord *record)
+{
+  if (store->count == store->capacity) {
+    int capacity = store->capacity * 2;
+    ScoreRecord *records = realloc(store->records, sizeof(ScoreRecord) * capacity);
+    if (records == NULL) {
+      fprintf(stderr, "Erreur d'allocation mémoire\n");
+      return -1;
+    }
+    store->records = records;
+    ScoreNode *nodes = realloc(store->nodes, sizeof(ScoreNode) * capacity);
+    if (nodes == NULL) {
+      fprintf(stderr, "Erreur d'allocation mémoire\n");
+      return -1;
+    }
+    store->nodes = nodes;
+    store->capacity = capacity;
+  }
+
+  Sint32 key = store->count++;
+  store->records[key] = *record;
+  store->nodes[key] = (ScoreNode) { -1, -1, score_store_random(store), 1 };
+  store->root = score_store_insert_node(store, store->root, key);
+
+  // count the nodes ranked before the new one on the way down
+  int before = 0;
+  Sint32 node = store->root;
+  while (node != key) {
+    if (score_store_before(store, node, key)) {
+      before += score_node_size(store, store->nodes[node].left) + 1;
+      node = store->nodes[node].right;
+    } else {
+      node = store->nodes[node].left;
+    }
+  }
+  return before + score_node_size(store, store->nodes[key].left) + 1;
+}
+
+static void score_store_refresh_top(ScoreStore *store)
+{
+  ScoreRecord *best = malloc(sizeof(ScoreRecord) * store->top_count);
+  if (best == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return;
+  }
+
+  int count = score_store_top(store, best, store->top_count);
+  for (int i = 0; i < store->top_count; i++) {
+    if (i < count) {
+      snprintf(store->top[i], SCORE_STORE_LINE_LENGTH, "%s : %d", best[i].name, (int) best[i].score);
+    } else {
+      snprintf(store->top[i], SCORE_STORE_LINE_LENGTH, "%s : 0", SCORE_STORE_PLACEHOLDER);
+    }
+  }
+
+  free(best);
+}
+
+static bool score_store_append(ScoreStore *store, const ScoreRecord *record)
+{
+  off_t end = lseek(store->fd, 0, SEEK_END);
+  if (write(store->fd, record, sizeof(ScoreRecord)) != sizeof(ScoreRecord)) {
+    // drop what was written of it, the next record starts where it should
+    fprintf(stderr, "[score_store_append] Erreur lors de l'écriture du score\n");
+    if (end >= 0 && ftruncate(store->fd, end) == 0) fsync(store->fd);
+    return false;
+  }
+  return true;
+}
+
+static void score_record_init(ScoreRecord *record, const char *name, int score)
+{
+  memset(record, 0, sizeof(ScoreRecord));
+  record->score = score;
+  record->time = (Uint32) time(NULL);
+  strncpy(record->name, name, SCORE_STORE_NAME_LENGTH - 1);
+  record->checksum = score_record_checksum(record);
+}
+
+// read every record, skip the damaged ones, and cut the tail a crash left unfinished
+static bool score_store_load(ScoreStore *store, const char *path, off_t size)
+{
+  ScoreStoreHeader header;
+  if (read(store->fd, &header, sizeof(header)) != sizeof(header)) return false;
+  if (
+    memcmp(header.magic, SCORE_STORE_MAGIC, sizeof(header.magic)) != 0 ||
+    header.record_size != sizeof(ScoreRecord)
+  ) {
+    fprintf(stderr, "[score_store_load] Fichier de scores invalide : %s\n", path);
+    return false;
+  }
+
+  ScoreRecord *chunk = malloc(sizeof(ScoreRecord) * SCORE_STORE_READ_CHUNK);
+  if (chunk == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return false;
+  }
+
+  // end of the last good record, anything after it is the torn tail
+  off_t valid = sizeof(header);
+  off_t offset = sizeof(header);
+  int damaged = 0, tail_damaged = 0;
+  ssize_t bytes;
+  while ((bytes = read(store->fd, chunk, sizeof(ScoreRecord) * SCORE_STORE_READ_CHUNK)) > 0) {
+    int count = bytes / sizeof(ScoreRecord);
+    for (int i = 0; i < count; i++) {
+      offset += sizeof(ScoreRecord);
+      if (chunk[i].checksum != score_record_checksum(&chunk[i])) {
+        damaged++;
+        tail_damaged++;
+        continue;
+      }
+      chunk[i].name[SCORE_STORE_NAME_LENGTH - 1] = '\0';
+      if (score_store_add(store, &chunk[i]) < 0) {
+        free(chunk);
+        return false;
+      }
+      valid = offset;
+      tail_damaged = 0;
+    }
+    // a record cut short can only be the last one
+    if (bytes % sizeof(ScoreRecord) != 0) break;
+  }
+  free(chunk);
+
+  if (damaged > tail_damaged) {
+    printf("Skipping %d damaged scores in %s\n", damaged - tail_damaged, path);
+  }
+  if (valid < size) {
+    printf("Dropping %ld bytes of unfinished scores from %s\n", (long) (size - valid), path);
+    if (ftruncate(store->fd, valid) < 0 || fsync(store->fd) < 0) {
+      fprintf(stderr, "[score_store_load] Erreur lors de la réparation de %s\n", path);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void score_store_import(ScoreStore *store, const char *legacy_path)
+{
+  FILE *fp = fopen(legacy_path, "r");
+  if (fp == NULL) return;
+
+  char line[256];
+  char name[SCORE_STORE_NAME_LENGTH];
+  int score, count = 0;
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    if (sscanf(line, "%11[^ :] : %d", name, &score) != 2) continue;
+    // the empty slots the old game wrote out with the scores
+    if (score == 0 && strcmp(name, SCORE_STORE_PLACEHOLDER) == 0) continue;
+
+    ScoreRecord record;
+    score_record_init(&record, name, score);
+    if (score_store_add(store, &record) < 0 || !score_store_append(store, &record)) break;
+    count++;
+  }
+  fclose(fp);
+
+  // one sync for the whole import
+  fsync(store->fd);
+  printf("Imported %d scores from %s\n", count, legacy_path);
+}
+
+ScoreStore *score_store_open(const char *path, const char *legacy_path, int top_count)
+{
+  ScoreStore *store = malloc(sizeof(ScoreStore));
+  if (store == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  store->count = 0;
+  store->capacity = SCORE_STORE_INITIAL_CAPACITY;
+  store->root = -1;
+  store->seed = 2463534242u;
+  store->top_count = top_count;
+  store->worker = NULL;
+  store->records = malloc(sizeof(ScoreRecord) * store->capacity);
+  store->nodes = malloc(sizeof(ScoreNode) * store->capacity);
+  store->top = malloc(SCORE_STORE_LINE_LENGTH * top_count);
+  store->fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (store->records == NULL || store->nodes == NULL || store->top == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    score_store_close(store);
+    return NULL;
+  }
+  if (store->fd < 0) {
+    fprintf(stderr, "Erreur d'ouverture du fichier %s\n", path);
+    score_store_close(store);
+    return NULL;
+  }
+
+  struct stat st;
+  if (fstat(store->fd, &st) < 0) {
+    score_store_close(store);
+    return NULL;
+  }
+
+  if (st.st_size == 0) {
+    ScoreStoreHeader header = { SCORE_STORE_MAGIC, sizeof(ScoreRecord), 0 };
+    if (write(store->fd, &header, sizeof(header)) != sizeof(header) || fsync(store->fd) < 0) {
+      fprintf(stderr, "[score_store_open] Erreur lors de la création de %s\n", path);
+      score_store_close(store);
+      return NULL;
+    }
+    score_store_sync_directory(path);
+    if (legacy_path != NULL) score_store_import(store, legacy_path);
+  } else if (!score_store_load(store, path, st.st_size)) {
+    score_store_close(store);
+    return NULL;
+  }
+
+  score_store_refresh_top(store);
+  return store;
+}
+
+void score_store_close(ScoreStore *store)
+{
+  if (store == NULL) return;
+
+  if (store->fd >= 0) close(store->fd);
+  free(store->records);
+  free(store->nodes);
+  free(store->top);
+  free(store);
+}
+
+void score_store_set_worker(ScoreStore *store, IoWorker *worker)
+{
+  store->worker = worker;
+}
+
+int score_store_insert(ScoreStore *store, const char *name, int score)
+{
+  ScoreRecord record;
+  score_record_init(&record, name, score);
+
+  if (store->worker != NULL) {
+    // the worker gets its own copy, synced with the other writes of its batch
+    if (!io_worker_append(store->worker, store->fd, &record, sizeof(record))) return -1;
+  } else if (!score_store_append(store, &record) || fsync(store->fd) < 0) {
+    // on the disk first, a score in the menu is a score that survives a crash
+    return -1;
+  }
+
+  int rank = score_store_add(store, &record);
+  if (rank > 0 && rank <= store->top_count) score_store_refresh_top(store);
+  return rank;
+}
+
+int score_store_rank(ScoreStore *store, int score)
+{
+  int before = 0;
+  Sint32 node = store->root;
+  while (node >= 0) {
+    if (store->records[node].score > score) {
+      before += score_node_size(store, store->nodes[node].left) + 1;
+      node = store->nodes[node].right;
+    } else {
+      node = store->nodes[node].left;
+    }
+  }
+  return before + 1;
+}
+
+static void score_store_collect(ScoreStore *store, Sint32 node, ScoreRecord *records, int count, int *written)
+{
+  if (node < 0 || *written >= count) return;
+
+  score_store_collect(store, store->nodes[node].left, records, count, written);
+  if (*written < count) records[(*written)++] = store->records[node];
+  score_store_collect(store, store->nodes[node].right, records, count, written);
+}
+
+int score_store_top(ScoreStore *store, ScoreRecord *records, int count)
+{
+  int written = 0;
+  score_store_collect(store, store->root, records, count, &written);
+  return written;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+# ifndef SCORE_STORE_H
+# define SCORE_STORE_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "io_worker.h"
+
+#define SCORE_STORE_MAGIC "PACSCOR1"
+#define SCORE_STORE_NAME_LENGTH 12
+#define SCORE_STORE_LINE_LENGTH 32
+// name of an empty slot of the best scores, "XXX : 0"
+#define SCORE_STORE_PLACEHOLDER "XXX"
+
+/**
+ * Record of the file, appended once and never rewritten. A record with a
+ * wrong checksum is skipped on the next open, and the ones after the last
+ * good record, cut by a crash, are dropped from the file.
+ */
+typedef struct {
+  Sint32 score;
+  Uint32 time;
+  char name[SCORE_STORE_NAME_LENGTH];
+  // FNV-1a of the fields above
+  Uint32 checksum;
+} ScoreRecord;
+
+typedef struct {
+  char magic[8];
+  Uint32 record_size;
+  Uint32 reserved;
+} ScoreStoreHeader;
+
+/**
+ * Node of the index, a treap ordered by rank where node i is record i
+ */
+typedef struct {
+  Sint32 left, right;
+  Uint32 priority;
+  // number of nodes in the subtree, for the rank queries
+  Uint32 size;
+} ScoreNode;
+
+typedef struct {
+  int fd;
+  ScoreRecord *records;
+  ScoreNode *nodes;
+  int count, capacity;
+  Sint32 root;
+  Uint32 seed;
+  // best scores formatted for the menu, only rebuilt when they change
+  char (*top)[SCORE_STORE_LINE_LENGTH];
+  int top_count;
+  // writes the records when set, otherwise they are written by the caller
+  IoWorker *worker;
+} ScoreStore;
+
+/**
+ * @brief Open the store, created if it does not exist, imported from the
+ * old text file of "name : score" lines if there is one
+ * @param path Path of the store
+ * @param legacy_path Path of the text file, NULL for none
+ * @param top_count Number of best scores kept formatted in store->top
+ * @return ScoreStore*, NULL on error
+ */
+ScoreStore *score_store_open(const char *path, const char *legacy_path, int top_count);
+
+/**
+ * @brief Close the ScoreStore object, every score is already on the disk
+ * @param store ScoreStore
+ */
+void score_store_close(ScoreStore *store);
+
+/**
+ * @brief Hand the writes of the store to a worker thread. The worker must
+ * be destroyed, which syncs what it has queued, before the store is closed.
+ * @param store ScoreStore
+ * @param worker IoWorker, NULL to write on the calling thread again
+ */
+void score_store_set_worker(ScoreStore *store, IoWorker *worker);
+
+/**
+ * @brief Add a score, written to the disk before returning, or queued
+ * to the worker of the store. O(log n).
+ * @param store ScoreStore
+ * @param name Name of the player, cut to SCORE_STORE_NAME_LENGTH - 1
+ * @param score Score
+ * @return Rank of the score from 1, -1 on error
+ */
+int score_store_insert(ScoreStore *store, const char *name, int score);
+
+/**
+ * @brief Rank that a score would get if it was added now. O(log n).
+ * @param store ScoreStore
+ * @param score Score
+ * @return Rank from 1
+ */
+int score_store_rank(ScoreStore *store, int score);
+
+/**
+ * @brief Get the best records, best first
+ * @param store ScoreStore
+ * @param records Array of at least count records
+ * @param count Number of records wanted
+ * @return Number of records written, at most the number of scores
+ */
+int score_store_top(ScoreStore *store, ScoreRecord *records, int count);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include <SDL2/SDL.h>
+
+#include "simulation.h"
+#include "window.h"
+
+Simulation simulation = { 0, 1 };
+
+void simulation_seed(unsigned int seed)
+{
+  simulation.tick = 0;
+  // xorshift is stuck on 0
+  simulation.random = seed != 0 ? seed : 0x9e3779b9;
+}
+
+float simulation_time(void)
+{
+  return simulation.tick / FPS;
+}
+
+int simulation_random(void)
+{
+  // xorshift32
+  Uint32 x = simulation.random;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  simulation.random = x;
+  return (int) (x >> 1);
+}
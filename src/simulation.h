@@ -0,0 +1,39 @@
+# ifndef SIMULATION_H
+# define SIMULATION_H
+
+#include <SDL2/SDL.h>
+
+/**
+ * Clock and random numbers of the game logic. The game reads the time and
+ * draws its random numbers from here, never from SDL_GetTicks or rand, so
+ * that the same inputs from the same seed give the same game, which is
+ * what replays and rollback rely on. Saved and restored with the rest of
+ * the state.
+ */
+typedef struct {
+  // ticks run since the seed, game_update counts them
+  Uint32 tick;
+  Uint32 random;
+} Simulation;
+
+extern Simulation simulation;
+
+/**
+ * @brief Start again from tick 0 with a seed
+ * @param seed Seed of the random numbers
+ */
+void simulation_seed(unsigned int seed);
+
+/**
+ * @brief Get the time of the game, in seconds
+ * @return float
+ */
+float simulation_time(void);
+
+/**
+ * @brief Draw a random number, like rand
+ * @return int, between 0 and 0x7fffffff
+ */
+int simulation_random(void);
+
+# endif
\ No newline at end of file
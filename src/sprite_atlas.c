@@ -0,0 +1,123 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sprite_atlas.h"
+#include "counters.h"
+
+SpriteAtlas *sprite_atlas_create(
+  SDL_Renderer *renderer,
+  const char **paths,
+  SDL_Surface **surfaces,
+  int count
+) {
+  bool is_valid = count <= SPRITE_ATLAS_CAPACITY;
+  for (int i = 0; i < count; i++) {
+    if (surfaces[i] == NULL || strlen(paths[i]) >= SPRITE_ATLAS_PATH_MAX) is_valid = false;
+  }
+
+  SpriteAtlas *atlas = is_valid ? malloc(sizeof(SpriteAtlas)) : NULL;
+  if (atlas == NULL) {
+    fprintf(stderr, "[sprite_atlas_create] Images invalides ou erreur d'allocation mémoire\n");
+    for (int i = 0; i < count; i++) SDL_FreeSurface(surfaces[i]);
+    return NULL;
+  }
+  atlas->texture = NULL;
+  atlas->surface = NULL;
+  atlas->count = 0;
+
+  // images are decoded already, only the packing and the upload are left
+  int order[SPRITE_ATLAS_CAPACITY];
+  for (int i = 0; i < count; i++) order[i] = i;
+
+  // tallest images first so that rows waste less space
+  for (int i = 1; i < count; i++) {
+    int current = order[i], j = i;
+    while (j > 0 && surfaces[order[j - 1]]->h < surfaces[current]->h) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = current;
+  }
+
+  int x = 0, y = 0, row_height = 0;
+  for (int i = 0; i < count; i++) {
+    SDL_Surface *surface = surfaces[order[i]];
+    if (x + surface->w > SPRITE_ATLAS_WIDTH) {
+      x = 0;
+      y += row_height + SPRITE_ATLAS_PADDING;
+      row_height = 0;
+    }
+    atlas->rects[order[i]] = (SDL_Rect) { x, y, surface->w, surface->h };
+    x += surface->w + SPRITE_ATLAS_PADDING;
+    if (surface->h > row_height) row_height = surface->h;
+  }
+
+  atlas->width = SPRITE_ATLAS_WIDTH;
+  atlas->height = y + row_height;
+
+  SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas->width, atlas->height, 32, SDL_PIXELFORMAT_RGBA32);
+
+  for (int i = 0; i < count; i++) {
+    if (sheet != NULL) {
+      SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(surfaces[i], NULL, sheet, &atlas->rects[i]);
+    }
+    SDL_FreeSurface(surfaces[i]);
+    strcpy(atlas->paths[i], paths[i]);
+  }
+  atlas->count = count;
+
+  if (sheet == NULL) {
+    fprintf(stderr, "[sprite_atlas_create] Erreur lors de la création de la surface : %s\n", SDL_GetError());
+    free(atlas);
+    return NULL;
+  }
+
+  // software rendering samples the sheet itself
+  if (renderer == NULL) {
+    atlas->surface = sheet;
+    return atlas;
+  }
+
+  atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+  COUNTER_INC(COUNTER_TEXTURES_CREATED);
+  SDL_FreeSurface(sheet);
+  if (atlas->texture == NULL) {
+    fprintf(stderr, "[sprite_atlas_create] Erreur lors de la création de la texture : %s\n", SDL_GetError());
+    free(atlas);
+    return NULL;
+  }
+  SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+
+  return atlas;
+}
+
+void sprite_atlas_destroy(SpriteAtlas *atlas)
+{
+  if (atlas == NULL) return;
+
+  if (atlas->texture != NULL) {
+    SDL_DestroyTexture(atlas->texture);
+    COUNTER_INC(COUNTER_TEXTURES_DESTROYED);
+  }
+  SDL_FreeSurface(atlas->surface);
+  free(atlas);
+}
+
+bool sprite_atlas_find(SpriteAtlas *atlas, const char *path, Sprite *sprite)
+{
+  if (atlas == NULL) return false;
+
+  for (int i = 0; i < atlas->count; i++) {
+    if (strcmp(atlas->paths[i], path) == 0) {
+      sprite->texture = atlas->texture;
+      sprite->surface = atlas->surface;
+      sprite->rect = atlas->rects[i];
+      return true;
+    }
+  }
+
+  return false;
+}
\ No newline at end of file
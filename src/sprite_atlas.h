@@ -0,0 +1,63 @@
+# ifndef SPRITE_ATLAS_H
+# define SPRITE_ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdbool.h>
+
+#define SPRITE_ATLAS_WIDTH 512
+#define SPRITE_ATLAS_PADDING 1
+#define SPRITE_ATLAS_CAPACITY 16
+#define SPRITE_ATLAS_PATH_MAX 128
+
+/**
+ * Region of a texture holding one image, sprite sheets keep their frames
+ * side by side inside the region. Without a renderer the pixels stay in
+ * an RGBA32 surface for the software rasterizer instead.
+ */
+typedef struct {
+  SDL_Texture *texture;
+  SDL_Surface *surface;
+  SDL_Rect rect;
+} Sprite;
+
+typedef struct {
+  SDL_Texture *texture;
+  SDL_Surface *surface;
+  int width, height;
+  char paths[SPRITE_ATLAS_CAPACITY][SPRITE_ATLAS_PATH_MAX];
+  SDL_Rect rects[SPRITE_ATLAS_CAPACITY];
+  int count;
+} SpriteAtlas;
+
+/**
+ * @brief Pack decoded images into a single texture
+ * @param renderer SDL_Renderer, NULL to keep the sheet in memory
+ * @param paths Image paths, the names of the images in the atlas
+ * @param surfaces Decoded images, freed by the atlas
+ * @param count Number of images
+ * @return SpriteAtlas*, NULL on error
+ */
+SpriteAtlas *sprite_atlas_create(
+  SDL_Renderer *renderer,
+  const char **paths,
+  SDL_Surface **surfaces,
+  int count
+);
+
+/**
+ * @brief Destroy the SpriteAtlas object
+ * @param atlas SpriteAtlas
+ */
+void sprite_atlas_destroy(SpriteAtlas *atlas);
+
+/**
+ * @brief Find the sprite of an image packed in the atlas
+ * @param atlas SpriteAtlas
+ * @param path Image path
+ * @param sprite Sprite
+ * @return true if the image is in the atlas
+ */
+bool sprite_atlas_find(SpriteAtlas *atlas, const char *path, Sprite *sprite);
+
+# endif
\ No newline at end of file
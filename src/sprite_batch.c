@@ -0,0 +1,179 @@
+#include <SDL2/SDL.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "sprite_batch.h"
+
+SpriteBatch *sprite_batch_create(SDL_Renderer *renderer, Raster *raster)
+{
+  SpriteBatch *batch = malloc(sizeof(SpriteBatch));
+  if (batch == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return NULL;
+  }
+
+  batch->renderer = renderer;
+  batch->raster = raster;
+  batch->texture = NULL;
+  batch->count = 0;
+  batch->stats = (RenderStats) { 0, 0 };
+
+  // every quad is made of two triangles, the indices never change
+  for (int i = 0; i < SPRITE_BATCH_CAPACITY; i++) {
+    int *index = &batch->indices[i * 6];
+    index[0] = i * 4;
+    index[1] = i * 4 + 1;
+    index[2] = i * 4 + 2;
+    index[3] = i * 4 + 2;
+    index[4] = i * 4 + 1;
+    index[5] = i * 4 + 3;
+  }
+
+  return batch;
+}
+
+void sprite_batch_destroy(SpriteBatch *batch)
+{
+  free(batch);
+}
+
+void sprite_batch_begin(SpriteBatch *batch)
+{
+  batch->count = 0;
+  batch->texture = NULL;
+  batch->stats = (RenderStats) { 0, 0 };
+}
+
+int sprite_batch_flush(SpriteBatch *batch)
+{
+  if (batch->count == 0) return 0;
+
+  int count = batch->count;
+  batch->count = 0;
+  batch->stats.draw_calls++;
+
+  return SDL_RenderGeometry(
+    batch->renderer,
+    batch->texture,
+    batch->vertices,
+    count * 4,
+    batch->indices,
+    count * 6
+  );
+}
+
+int sprite_batch_draw(
+  SpriteBatch *batch,
+  const Sprite *sprite,
+  const SDL_Rect *src,
+  const SDL_FRect *dst,
+  double angle,
+  SDL_RendererFlip flip,
+  SDL_Color color
+) {
+  if (src == NULL) src = &sprite->rect;
+  if (batch->raster != NULL) {
+    return raster_draw(batch->raster, sprite->surface, src, dst, angle, flip, color);
+  }
+
+  // switching texture ends the current batch
+  SDL_Texture *texture = sprite->texture;
+  if (texture != batch->texture) {
+    if (sprite_batch_flush(batch) != 0) return -1;
+
+    int width, height;
+    if (SDL_QueryTexture(texture, NULL, NULL, &width, &height) != 0) return -1;
+    batch->texture = texture;
+    batch->texture_width = width;
+    batch->texture_height = height;
+    batch->stats.texture_switches++;
+  }
+  if (batch->count == SPRITE_BATCH_CAPACITY && sprite_batch_flush(batch) != 0) {
+    return -1;
+  }
+
+  float u0 = src->x / batch->texture_width;
+  float v0 = src->y / batch->texture_height;
+  float u1 = (src->x + src->w) / batch->texture_width;
+  float v1 = (src->y + src->h) / batch->texture_height;
+
+  if (flip & SDL_FLIP_HORIZONTAL) {
+    float u = u0; u0 = u1; u1 = u;
+  }
+  if (flip & SDL_FLIP_VERTICAL) {
+    float v = v0; v0 = v1; v1 = v;
+  }
+
+  // corners relative to the center, rotated clockwise like SDL_RenderCopyEx
+  float half_w = dst->w / 2, half_h = dst->h / 2;
+  float center_x = dst->x + half_w, center_y = dst->y + half_h;
+  float corners[4][2] = {
+    { -half_w, -half_h }, { half_w, -half_h }, { -half_w, half_h }, { half_w, half_h }
+  };
+  float uvs[4][2] = { { u0, v0 }, { u1, v0 }, { u0, v1 }, { u1, v1 } };
+
+  float cos_a = 1, sin_a = 0;
+  if (angle != 0.0) {
+    // right angles are exact so that tiles stay pixel aligned
+    if (fmod(angle, 90.0) == 0.0) {
+      int quarter = ((int) (angle / 90.0) % 4 + 4) % 4;
+      static const float quarter_cos[] = { 1, 0, -1, 0 };
+      static const float quarter_sin[] = { 0, 1, 0, -1 };
+      cos_a = quarter_cos[quarter];
+      sin_a = quarter_sin[quarter];
+    } else {
+      double radians = angle * M_PI / 180.0;
+      cos_a = cos(radians);
+      sin_a = sin(radians);
+    }
+  }
+
+  SDL_Vertex *vertex = &batch->vertices[batch->count * 4];
+  for (int i = 0; i < 4; i++) {
+    float x = corners[i][0], y = corners[i][1];
+    vertex[i].position.x = center_x + x * cos_a - y * sin_a;
+    vertex[i].position.y = center_y + x * sin_a + y * cos_a;
+    vertex[i].color = color;
+    vertex[i].tex_coord.x = uvs[i][0];
+    vertex[i].tex_coord.y = uvs[i][1];
+  }
+  batch->count++;
+
+  return 0;
+}
+
+int sprite_batch_fill(
+  SpriteBatch *batch,
+  const SDL_Rect *rect,
+  SDL_Color color
+) {
+  if (batch->raster != NULL) {
+    raster_fill_rect(batch->raster, rect, color);
+    return 0;
+  }
+
+  // solid quads are a run without texture
+  if (batch->texture != NULL) {
+    if (sprite_batch_flush(batch) != 0) return -1;
+    batch->texture = NULL;
+    batch->stats.texture_switches++;
+  }
+  if (batch->count == SPRITE_BATCH_CAPACITY && sprite_batch_flush(batch) != 0) {
+    return -1;
+  }
+
+  float x1 = rect->x, y1 = rect->y, x2 = rect->x + rect->w, y2 = rect->y + rect->h;
+  float corners[4][2] = { { x1, y1 }, { x2, y1 }, { x1, y2 }, { x2, y2 } };
+
+  SDL_Vertex *vertex = &batch->vertices[batch->count * 4];
+  for (int i = 0; i < 4; i++) {
+    vertex[i].position.x = corners[i][0];
+    vertex[i].position.y = corners[i][1];
+    vertex[i].color = color;
+    vertex[i].tex_coord.x = 0;
+    vertex[i].tex_coord.y = 0;
+  }
+  batch->count++;
+
+  return 0;
+}
\ No newline at end of file
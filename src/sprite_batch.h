@@ -0,0 +1,89 @@
+# ifndef SPRITE_BATCH_H
+# define SPRITE_BATCH_H
+
+#include <SDL2/SDL.h>
+
+#include "raster.h"
+#include "sprite_atlas.h"
+
+#define SPRITE_BATCH_CAPACITY 2048
+
+typedef struct {
+  int draw_calls;
+  int texture_switches;
+} RenderStats;
+
+typedef struct {
+  SDL_Renderer *renderer;
+  // software target, quads are drawn right away instead of being queued
+  Raster *raster;
+  SDL_Texture *texture;
+  float texture_width, texture_height;
+  SDL_Vertex vertices[SPRITE_BATCH_CAPACITY * 4];
+  int indices[SPRITE_BATCH_CAPACITY * 6];
+  int count;
+  RenderStats stats;
+} SpriteBatch;
+
+/**
+ * @brief Create a SpriteBatch object
+ * @param renderer SDL_Renderer, NULL when drawing into raster
+ * @param raster Raster, NULL when drawing with renderer
+ * @return SpriteBatch*
+ */
+SpriteBatch *sprite_batch_create(SDL_Renderer *renderer, Raster *raster);
+
+/**
+ * @brief Destroy the SpriteBatch object
+ * @param batch SpriteBatch
+ */
+void sprite_batch_destroy(SpriteBatch *batch);
+
+/**
+ * @brief Start a new frame, resetting the stats
+ * @param batch SpriteBatch
+ */
+void sprite_batch_begin(SpriteBatch *batch);
+
+/**
+ * @brief Queue a textured quad, quads sharing a texture are drawn together
+ * @param batch SpriteBatch
+ * @param sprite Sprite holding the texture, or the surface for a raster
+ * @param src Source rect in the texture, NULL for the sprite region
+ * @param dst Destination rect
+ * @param angle Angle to rotate around the center of dst, in degrees
+ * @param flip Flip image
+ * @param color Color the texture is modulated with
+ * @return 0 on success, a negative value on error
+ */
+int sprite_batch_draw(
+  SpriteBatch *batch,
+  const Sprite *sprite,
+  const SDL_Rect *src,
+  const SDL_FRect *dst,
+  double angle,
+  SDL_RendererFlip flip,
+  SDL_Color color
+);
+
+/**
+ * @brief Queue a quad of a solid color, solid quads are drawn together
+ * @param batch SpriteBatch
+ * @param rect Rectangle
+ * @param color SDL_Color
+ * @return 0 on success, a negative value on error
+ */
+int sprite_batch_fill(
+  SpriteBatch *batch,
+  const SDL_Rect *rect,
+  SDL_Color color
+);
+
+/**
+ * @brief Draw the queued quads in a single SDL_RenderGeometry call
+ * @param batch SpriteBatch
+ * @return 0 on success, a negative value on error
+ */
+int sprite_batch_flush(SpriteBatch *batch);
+
+# endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "string_builder.h"
+
+void string_builder_init(StringBuilder *builder, char *buffer, int capacity)
+{
+  builder->data = buffer;
+  builder->capacity = capacity;
+  string_builder_clear(builder);
+}
+
+void string_builder_clear(StringBuilder *builder)
+{
+  builder->length = 0;
+  builder->data[0] = '\0';
+}
+
+bool string_builder_append(StringBuilder *builder, const char *text)
+{
+  int room = builder->capacity - 1 - builder->length;
+  int length = strlen(text);
+  int copied = length < room ? length : room;
+
+  memcpy(builder->data + builder->length, text, copied);
+  builder->length += copied;
+  builder->data[builder->length] = '\0';
+  return copied == length;
+}
+
+bool string_builder_appendf(StringBuilder *builder, const char *format, ...)
+{
+  int room = builder->capacity - builder->length;
+
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(builder->data + builder->length, room, format, args);
+  va_end(args);
+
+  if (length < 0) {
+    builder->data[builder->length] = '\0';
+    return false;
+  }
+  builder->length += length < room ? length : room - 1;
+  return length < room;
+}
+
+bool string_builder_pop(StringBuilder *builder)
+{
+  if (builder->length == 0) return false;
+
+  builder->data[--builder->length] = '\0';
+  return true;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+# ifndef STRING_BUILDER_H
+# define STRING_BUILDER_H
+
+#include <stdbool.h>
+
+/**
+ * String in a buffer of fixed capacity, never allocating, always
+ * terminated, and cut rather than overflowing
+ */
+typedef struct {
+  char *data;
+  int length;
+  // bytes in data, the terminator included
+  int capacity;
+} StringBuilder;
+
+/**
+ * @brief Start an empty string in a buffer
+ * @param builder StringBuilder
+ * @param buffer Buffer, owned by the caller
+ * @param capacity Size of the buffer, the terminator included
+ */
+void string_builder_init(StringBuilder *builder, char *buffer, int capacity);
+
+/**
+ * @brief Empty the string
+ * @param builder StringBuilder
+ */
+void string_builder_clear(StringBuilder *builder);
+
+/**
+ * @brief Append a text, cut to the capacity
+ * @param builder StringBuilder
+ * @param text Text
+ * @return true if the whole text fit
+ */
+bool string_builder_append(StringBuilder *builder, const char *text);
+
+/**
+ * @brief Append a formatted text, cut to the capacity
+ * @param builder StringBuilder
+ * @param format printf format
+ * @return true if the whole text fit
+ */
+bool string_builder_appendf(StringBuilder *builder, const char *format, ...);
+
+/**
+ * @brief Remove the last character
+ * @param builder StringBuilder
+ * @return false if the string was already empty
+ */
+bool string_builder_pop(StringBuilder *builder);
+
+# endif
\ No newline at end of file
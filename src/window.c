@@ -2,13 +2,17 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "window.h"
+#include "bundle.h"
+#include "counters.h"
 
 void cleanup(SDL_Window* window, SDL_Renderer* renderer, SDL_Texture* texture)
 {
   if (texture != NULL) {
     SDL_DestroyTexture(texture);
+    COUNTER_INC(COUNTER_TEXTURES_DESTROYED);
   }
   if (renderer != NULL) {
     SDL_DestroyRenderer(renderer);
@@ -21,25 +25,109 @@ void cleanup(SDL_Window* window, SDL_Renderer* renderer, SDL_Texture* texture)
   TTF_Quit();
 }
 
-Window *window_create(char *title, int width, int height)
+static Sprite window_texture_sprite(SDL_Texture *texture)
+{
+  Sprite sprite = { texture, NULL, { 0, 0, 0, 0 } };
+  SDL_QueryTexture(texture, NULL, NULL, &sprite.rect.w, &sprite.rect.h);
+  return sprite;
+}
+
+static bool window_create_renderer(Window *window, int scale)
+{
+  switch (window->backend)
+  {
+    case RENDER_GPU:
+      window->window = SDL_CreateWindow(
+        window->title,
+        SDL_WINDOWPOS_UNDEFINED,
+        SDL_WINDOWPOS_UNDEFINED,
+        window->width * scale,
+        window->height * scale,
+        SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+      );
+      if (window->window == NULL) {
+          fprintf(stderr, "Erreur lors de la création de la fenêtre : %s\n", SDL_GetError());
+          return false;
+      }
+      window->renderer = SDL_CreateRenderer(window->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+      if (window->renderer == NULL) break;
+
+      // the game is drawn at its logical size, then upscaled in one copy
+      window->texture = SDL_CreateTexture(
+        window->renderer,
+        SDL_PIXELFORMAT_RGBA32,
+        SDL_TEXTUREACCESS_TARGET,
+        window->width,
+        window->height
+      );
+      if (window->texture == NULL) {
+          fprintf(stderr, "Erreur lors de la création de la texture : %s\n", SDL_GetError());
+          return false;
+      }
+      COUNTER_INC(COUNTER_TEXTURES_CREATED);
+      SDL_SetTextureScaleMode(window->texture, SDL_ScaleModeNearest);
+      break;
+    case RENDER_SDL_SOFTWARE:
+      window->surface = SDL_CreateRGBSurfaceWithFormat(0, window->width, window->height, 32, SDL_PIXELFORMAT_RGBA32);
+      if (window->surface == NULL) {
+          fprintf(stderr, "Erreur lors de la création de la surface : %s\n", SDL_GetError());
+          return false;
+      }
+      window->renderer = SDL_CreateSoftwareRenderer(window->surface);
+      break;
+    case RENDER_SOFTWARE:
+      // no renderer at all, textures stay surfaces drawn by the raster
+      window->raster = raster_create(window->width, window->height);
+      return window->raster != NULL;
+  }
+
+  if (window->renderer == NULL) {
+      fprintf(stderr, "Erreur lors de la création du renderer : %s\n", SDL_GetError());
+      return false;
+  }
+  // solid quads have no texture, they blend with the draw blend mode
+  SDL_SetRenderDrawBlendMode(window->renderer, SDL_BLENDMODE_BLEND);
+  return true;
+}
+
+Window *window_create(char *title, int width, int height, int scale, RenderBackend backend)
 {
   Window *window = malloc(sizeof(Window));
   window->width = width;
   window->height = height;
   window->title = title;
-  window->font = NULL;
+  window->fonts = NULL;
+  window->font_path = NULL;
+  window->batch = NULL;
+  window->assets = NULL;
+  window->primitives = NULL;
+  window->queue = NULL;
+  window->layer = RENDER_LAYER_HUD;
+  window->raster = NULL;
+  window->backend = backend;
+  window->window = NULL;
+  window->renderer = NULL;
+  window->texture = NULL;
+  window->surface = NULL;
+  window->integer_scale = true;
+  window->stats = (RenderStats) { 0, 0 };
 
-  window->window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_SHOWN);
-  if (window->window == NULL) {
-      fprintf(stderr, "Erreur lors de la création de la fenêtre : %s\n", SDL_GetError());
-      cleanup(NULL, NULL, NULL);
+  if (scale < 1) scale = 1;
+  if (!window_create_renderer(window, scale)) {
+      cleanup(window->window, window->renderer, window->texture);
       return NULL;
   }
 
-  window->renderer = SDL_CreateRenderer(window->window, -1, SDL_RENDERER_ACCELERATED);
-  if (window->renderer == NULL) {
-      fprintf(stderr, "Erreur lors de la création du renderer : %s\n", SDL_GetError());
-      cleanup(window->window, NULL, NULL);
+  window->fonts = font_cache_create(window->renderer);
+  window->assets = asset_manager_create(window->renderer);
+  window->batch = sprite_batch_create(window->renderer, window->raster);
+  window->primitives = primitives_create();
+  if (window->batch != NULL) window->queue = render_queue_create(window->batch);
+  if (
+    window->assets == NULL || window->batch == NULL ||
+    window->primitives == NULL || window->queue == NULL
+  ) {
+      cleanup(window->window, window->renderer, NULL);
       return NULL;
   }
 
@@ -48,13 +136,32 @@ Window *window_create(char *title, int width, int height)
 
 void window_destroy(Window *window)
 {
-  TTF_CloseFont(window->font);
-  cleanup(window->window, window->renderer, NULL);
+  font_cache_destroy(window->fonts);
+  asset_manager_destroy(window->assets);
+  render_queue_destroy(window->queue);
+  sprite_batch_destroy(window->batch);
+  primitives_destroy(window->primitives);
+  raster_destroy(window->raster);
+  cleanup(window->window, window->renderer, window->texture);
+  SDL_FreeSurface(window->surface);
   free(window);
 }
 
 void window_clear(Window *window)
 {
+  sprite_batch_begin(window->batch);
+  render_queue_reset(window->queue);
+  font_cache_release(window->fonts);
+  window->layer = RENDER_LAYER_HUD;
+  if (window->raster != NULL) {
+    raster_clear(window->raster, BLACK_COLOR);
+    return;
+  }
+  if (window->texture != NULL && SDL_SetRenderTarget(window->renderer, window->texture) != 0) {
+    fprintf(stderr, "Erreur lors du choix de la cible de rendu : %s\n", SDL_GetError());
+    cleanup(window->window, window->renderer, NULL);
+    return;
+  }
   SDL_SetRenderDrawColor(window->renderer, 0, 0, 0, 255);
   if (SDL_RenderClear(window->renderer) != 0) {
     fprintf(stderr, "Erreur lors du nettoyage de la fenêtre : %s\n", SDL_GetError());
@@ -63,55 +170,134 @@ void window_clear(Window *window)
   }
 }
 
+static void window_upscale(Window *window)
+{
+  // the output size is read every frame, so resizing needs no event
+  int output_width, output_height;
+  if (SDL_GetRendererOutputSize(window->renderer, &output_width, &output_height) != 0) return;
+
+  int scale = SDL_min(output_width / window->width, output_height / window->height);
+  SDL_Rect dst = { 0, 0, window->width * scale, window->height * scale };
+  if (!window->integer_scale || scale < 1) {
+    // largest size keeping the aspect ratio
+    if (output_width * window->height < output_height * window->width) {
+      dst.w = output_width;
+      dst.h = output_width * window->height / window->width;
+    } else {
+      dst.w = output_height * window->width / window->height;
+      dst.h = output_height;
+    }
+  }
+  dst.x = (output_width - dst.w) / 2;
+  dst.y = (output_height - dst.h) / 2;
+
+  SDL_SetRenderTarget(window->renderer, NULL);
+  SDL_SetRenderDrawColor(window->renderer, 0, 0, 0, 255);
+  SDL_RenderClear(window->renderer);
+  if (SDL_RenderCopy(window->renderer, window->texture, NULL, &dst) != 0) {
+    fprintf(stderr, "Erreur lors de la mise à l'échelle : %s\n", SDL_GetError());
+    return;
+  }
+  window->stats.draw_calls++;
+}
+
 void window_update(Window *window)
 {
-  if (window->renderer == NULL) {
+  if (window->raster == NULL && window->renderer == NULL) {
     fprintf(stderr, "Erreur lors de la mise à jour de la fenêtre : %s\n", SDL_GetError());
     cleanup(window->window, window->renderer, NULL);
     return;
   }
+  window_flush(window);
+  window->stats = window->batch->stats;
+  if (window->raster != NULL) return;
+
+  if (window->texture != NULL) window_upscale(window);
   SDL_RenderPresent(window->renderer);
 }
 
-void window_draw(Window *window, SDL_Texture *texture, SDL_Rect *rect)
+void window_toggle_fullscreen(Window *window)
 {
-  if (SDL_RenderCopy(window->renderer, texture, NULL, rect) != 0) {
-    fprintf(stderr, "Erreur lors du rendu de la texture : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, texture);
-    return;
+  if (window->window == NULL) return;
+
+  bool is_fullscreen = SDL_GetWindowFlags(window->window) & SDL_WINDOW_FULLSCREEN_DESKTOP;
+  if (SDL_SetWindowFullscreen(window->window, is_fullscreen ? 0 : SDL_WINDOW_FULLSCREEN_DESKTOP) != 0) {
+    fprintf(stderr, "Erreur lors du passage en plein écran : %s\n", SDL_GetError());
   }
 }
 
-void window_draw_rect(Window *window, SDL_Rect *rect, SDL_Color color)
+void window_toggle_integer_scale(Window *window)
+{
+  window->integer_scale = !window->integer_scale;
+}
+
+void window_set_layer(Window *window, RenderLayer layer)
+{
+  window->layer = layer;
+}
+
+void window_flush(Window *window)
 {
-  if (SDL_SetRenderDrawColor(window->renderer, color.r, color.g, color.b, color.a) != 0) {
-    fprintf(stderr, "Erreur lors du rendu du rectangle : %s\n", SDL_GetError());
+  // sorted by layer and texture, then drawn in as few batches as possible
+  int result = render_queue_submit(window->queue);
+  if (result == 0) result = sprite_batch_flush(window->batch);
+  // no queued text uses an evicted font past this point
+  font_cache_release(window->fonts);
+  if (result != 0) {
+    fprintf(stderr, "Erreur lors du rendu des sprites : %s\n", SDL_GetError());
     cleanup(window->window, window->renderer, NULL);
     return;
   }
-  if (SDL_RenderDrawRect(window->renderer, rect) != 0) {
-    fprintf(stderr, "Erreur lors du rendu du rectangle : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, NULL);
+}
+
+void window_draw(Window *window, SDL_Texture *texture, SDL_Rect *rect)
+{
+  Sprite sprite = window_texture_sprite(texture);
+  SDL_FRect dst = { rect->x, rect->y, rect->w, rect->h };
+  if (render_queue_sprite(window->queue, window->layer, &sprite, NULL, &dst, 0.0, SDL_FLIP_NONE, WHITE_COLOR) != 0) {
+    fprintf(stderr, "Erreur lors du rendu de la texture : %s\n", SDL_GetError());
+    cleanup(window->window, window->renderer, texture);
     return;
   }
 }
 
+static void window_fill_spans(Window *window, SDL_Color color)
+{
+  // spans of the shape go out with the other solid quads of the layer
+  Primitives *primitives = window->primitives;
+  for (int i = 0; i < primitives->count; i++) {
+    Span *span = &primitives->spans[i];
+    SDL_Rect rect = { span->x1, span->y, span->x2 - span->x1, 1 };
+    if (render_queue_fill(window->queue, window->layer, &rect, color) != 0) {
+      fprintf(stderr, "Erreur lors du rendu de la forme : %s\n", SDL_GetError());
+      cleanup(window->window, window->renderer, NULL);
+      return;
+    }
+  }
+}
+
+void window_draw_rect(Window *window, SDL_Rect *rect, SDL_Color color)
+{
+  if (primitives_rounded_rect(window->primitives, rect, 0, false)) window_fill_spans(window, color);
+}
+
 void window_draw_line(
   Window *window, 
   int x1, int y1, 
   int x2, int y2, 
   SDL_Color color
 ) {
-  if (SDL_SetRenderDrawColor(window->renderer, color.r, color.g, color.b, color.a) != 0) {
-    fprintf(stderr, "Erreur lors du rendu de la ligne : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, NULL);
-    return;
-  }
-  if (SDL_RenderDrawLine(window->renderer, x1, y1, x2, y2) != 0) {
-    fprintf(stderr, "Erreur lors du rendu de la ligne : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, NULL);
-    return;
-  }
+  window_draw_thick_line(window, x1, y1, x2, y2, 1, color);
+}
+
+void window_draw_thick_line(
+  Window *window, 
+  int x1, int y1, 
+  int x2, int y2, 
+  int thickness, 
+  SDL_Color color
+) {
+  if (primitives_line(window->primitives, x1, y1, x2, y2, thickness)) window_fill_spans(window, color);
 }
 
 void window_draw_circle(
@@ -120,24 +306,34 @@ void window_draw_circle(
   int radius, 
   SDL_Color color
 ) {
-  if (SDL_SetRenderDrawColor(window->renderer, color.r, color.g, color.b, color.a) != 0) {
-    fprintf(stderr, "Erreur lors du rendu du cercle : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, NULL);
-    return;
-  }
-  for (int w = 0; w < radius * 2; w++) {
-    for (int h = 0; h < radius * 2; h++) {
-      int dx = radius - w; // horizontal offset
-      int dy = radius - h; // vertical offset
-      if ((dx*dx + dy*dy) <= (radius * radius)) {
-        if (SDL_RenderDrawPoint(window->renderer, x + dx, y + dy) != 0) {
-          fprintf(stderr, "Erreur lors du rendu du cercle : %s\n", SDL_GetError());
-          cleanup(window->window, window->renderer, NULL);
-          return;
-        }
-      }
-    }
-  }
+  if (primitives_circle(window->primitives, x, y, radius, true)) window_fill_spans(window, color);
+}
+
+void window_draw_circle_outline(
+  Window *window, 
+  int x, int y, 
+  int radius, 
+  SDL_Color color
+) {
+  if (primitives_circle(window->primitives, x, y, radius, false)) window_fill_spans(window, color);
+}
+
+void window_fill_rounded_rect(
+  Window *window, 
+  SDL_Rect *rect, 
+  int radius, 
+  SDL_Color color
+) {
+  if (primitives_rounded_rect(window->primitives, rect, radius, true)) window_fill_spans(window, color);
+}
+
+void window_draw_rounded_rect(
+  Window *window, 
+  SDL_Rect *rect, 
+  int radius, 
+  SDL_Color color
+) {
+  if (primitives_rounded_rect(window->primitives, rect, radius, false)) window_fill_spans(window, color);
 }
 
 void window_draw_text(
@@ -148,48 +344,30 @@ void window_draw_text(
   SDL_Color color, 
   TextAlign align
 ) {
-  SDL_Surface* surface = TTF_RenderText_Solid(window->font, text, color);
-  if (surface == NULL) {
-    fprintf(stderr, "Erreur lors du chargement de l'image : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, NULL);
-    return;
-  }
-
-  SDL_Texture *texture = SDL_CreateTextureFromSurface(window->renderer, surface);
-  if (texture == NULL) {
-    fprintf(stderr, "[window_draw_text] Erreur lors de la création de la texture : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, NULL);
+  GlyphAtlas *atlas = font_cache_get(window->fonts, window->font_path, font_size);
+  if (atlas == NULL) {
+    fprintf(stderr, "[window_draw_text] Police non chargée\n");
     return;
   }
 
+  int width = glyph_atlas_measure(atlas, text);
   switch (align)
   {
     case ALIGN_LEFT:
-      x = x;
       break;
     case ALIGN_CENTER:
-      x = x - (strlen(text) * 8) / 2;
+      x = x - width / 2;
       break;
     case ALIGN_RIGHT:
-      x = x - (strlen(text) * 8);
+      x = x - width;
       break;
   }
 
-  SDL_Rect rect = {x, y - (font_size/2), strlen(text) * 8, font_size};
-  if (SDL_QueryTexture(texture, NULL, NULL, &rect.w, &rect.h) != 0) {
-    fprintf(stderr, "Erreur lors de la récupération des dimensions de la texture : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, texture);
-    return;
-  }
-  if (SDL_RenderCopy(window->renderer, texture, NULL, &rect) != 0) {
-    fprintf(stderr, "[window_draw_text] Erreur lors du rendu de la texture : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, texture);
+  if (render_queue_text(window->queue, window->layer, atlas, x, y - (font_size/2), text, color) != 0) {
+    fprintf(stderr, "[window_draw_text] Erreur lors du rendu du texte : %s\n", SDL_GetError());
+    cleanup(window->window, window->renderer, NULL);
     return;
   }
-
-  // free resources
-  SDL_FreeSurface(surface);
-  SDL_DestroyTexture(texture);
 }
 
 void window_draw_texture(
@@ -198,7 +376,9 @@ void window_draw_texture(
   SDL_Rect *src, 
   SDL_Rect *dst
 ) {
-  if (SDL_RenderCopy(window->renderer, texture, src, dst) != 0) {
+  Sprite sprite = window_texture_sprite(texture);
+  SDL_FRect rect = { dst->x, dst->y, dst->w, dst->h };
+  if (render_queue_sprite(window->queue, window->layer, &sprite, src, &rect, 0.0, SDL_FLIP_NONE, WHITE_COLOR) != 0) {
     fprintf(stderr, "[window_draw_texture] Erreur lors du rendu de la texture : %s\n", SDL_GetError());
     cleanup(window->window, window->renderer, texture);
     return;
@@ -210,7 +390,7 @@ void window_load_texture(
   const char *path, 
   SDL_Texture **texture
 ) {
-  SDL_Surface* surface = IMG_Load(path);
+  SDL_Surface* surface = bundle_load_image(path);
   if (surface == NULL) {
       fprintf(stderr, "[window_load_texture]\n Erreur lors du chargement de l'image : %s\n", SDL_GetError());
       cleanup(window->window, window->renderer, NULL);
@@ -218,6 +398,7 @@ void window_load_texture(
   }
 
   *texture = SDL_CreateTextureFromSurface(window->renderer, surface);
+  COUNTER_INC(COUNTER_TEXTURES_CREATED);
   if (*texture == NULL) {
       fprintf(stderr, "[window_load_texture] Erreur lors de la création de la texture : %s\n", SDL_GetError());
       cleanup(window->window, window->renderer, NULL);
@@ -230,12 +411,16 @@ void window_load_texture(
 
 void window_load_font(Window *window, const char *path, int size)
 {
-  window->font = TTF_OpenFont(path, size);
-  if (window->font == NULL) {
-      fprintf(stderr, "Erreur lors du chargement de la police : %s\n", TTF_GetError());
+  if (font_cache_get(window->fonts, path, size) == NULL) {
       cleanup(window->window, window->renderer, NULL);
       return;
   }
+  window->font_path = path;
+}
+
+int window_measure_text(Window *window, const char *text, int font_size)
+{
+  return font_cache_measure(window->fonts, window->font_path, font_size, text);
 }
 
 void window_rotate_texture(
@@ -245,10 +430,9 @@ void window_rotate_texture(
   double angle, 
   SDL_RendererFlip flip
 ) {
-  int w, h;
-  SDL_QueryTexture(texture, NULL, NULL, &w, &h);
-  SDL_Point center = { w/2, h/2 };
-  if (SDL_RenderCopyEx(window->renderer, texture, NULL, rect, angle, &center, flip) != 0) {
+  Sprite sprite = window_texture_sprite(texture);
+  SDL_FRect dst = { rect->x, rect->y, rect->w, rect->h };
+  if (render_queue_sprite(window->queue, window->layer, &sprite, NULL, &dst, angle, flip, WHITE_COLOR) != 0) {
     fprintf(stderr, "Erreur lors du rendu de la texture : %s\n", SDL_GetError());
     cleanup(window->window, window->renderer, texture);
     return;
@@ -258,16 +442,78 @@ void window_rotate_texture(
 
 void window_draw_sprite(
   Window *window, 
-  SDL_Texture *texture, 
+  Sprite *sprite, 
   SDL_Rect *src, 
   SDL_Rect *dst, 
   double angle, 
   SDL_RendererFlip flip
 ) {
-  SDL_Point center = { src->w/2, src->h/2 };
-  if (SDL_RenderCopyEx(window->renderer, texture, src, dst, angle, &center, flip) != 0) {
+  // src is relative to the sprite region of the atlas
+  SDL_Rect region = sprite->rect;
+  if (src != NULL) {
+    region = (SDL_Rect) { sprite->rect.x + src->x, sprite->rect.y + src->y, src->w, src->h };
+  }
+  SDL_FRect rect = { dst->x, dst->y, dst->w, dst->h };
+
+  if (render_queue_sprite(window->queue, window->layer, sprite, &region, &rect, angle, flip, WHITE_COLOR) != 0) {
     fprintf(stderr, "Erreur lors du rendu de la texture : %s\n", SDL_GetError());
-    cleanup(window->window, window->renderer, texture);
+    cleanup(window->window, window->renderer, NULL);
     return;
   }
+}
+
+void window_load_sprite_atlas(
+  Window *window, 
+  AssetLoader *loader
+) {
+  if (!asset_manager_pack(window->assets, loader)) {
+      cleanup(window->window, window->renderer, NULL);
+      return;
+  }
+}
+
+Sprite *window_load_sprite(
+  Window *window, 
+  const char *path
+) {
+  Sprite *sprite = asset_manager_acquire(window->assets, path);
+  if (sprite == NULL) {
+      fprintf(stderr, "[window_load_sprite] Erreur lors du chargement du sprite : %s\n", path);
+  }
+  return sprite;
+}
+
+const Uint8 *window_get_pixels(
+  Window *window, 
+  int *pitch
+) {
+  switch (window->backend)
+  {
+    case RENDER_SOFTWARE:
+      *pitch = window->raster->pitch;
+      return window->raster->pixels;
+    case RENDER_SDL_SOFTWARE:
+      *pitch = window->surface->pitch;
+      return window->surface->pixels;
+    default:
+      return NULL;
+  }
+}
+
+int window_read_pixels(
+  Window *window, 
+  Uint8 *pixels, 
+  int pitch
+) {
+  // recorded commands have to be drawn first
+  window_flush(window);
+
+  if (window->raster != NULL) {
+    for (int y = 0; y < window->height; y++) {
+      memcpy(pixels + y * pitch, window->raster->pixels + y * window->raster->pitch, window->width * 4);
+    }
+    return 0;
+  }
+
+  return SDL_RenderReadPixels(window->renderer, NULL, SDL_PIXELFORMAT_RGBA32, pixels, pitch);
 }
\ No newline at end of file
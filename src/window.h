@@ -6,6 +6,13 @@
 #include <SDL2/SDL_ttf.h>
 #include <stdbool.h>
 
+#include "font_cache.h"
+#include "asset_manager.h"
+#include "primitives.h"
+#include "raster.h"
+#include "render_queue.h"
+#include "sprite_batch.h"
+
 #define FPS 30.0f
 #define UPDATE_CAP 1.0f / FPS
 
@@ -21,14 +28,38 @@ typedef enum {
     ALIGN_RIGHT
 } TextAlign;
 
+typedef enum {
+    // SDL window with an accelerated renderer
+    RENDER_GPU,
+    // memory framebuffer drawn by raster.c, no GPU nor display needed
+    RENDER_SOFTWARE,
+    // SDL software renderer into a memory surface, to compare with
+    RENDER_SDL_SOFTWARE
+} RenderBackend;
+
 typedef struct {
     SDL_Window *window;
     SDL_Renderer *renderer;
+    // offscreen target at the logical size, upscaled to the window
     SDL_Texture *texture;
     SDL_Surface *surface;
-    TTF_Font *font;
+    FontCache *fonts;
+    const char *font_path;
+    SpriteBatch *batch;
+    AssetManager *assets;
+    Primitives *primitives;
+    // every draw is recorded here, then sorted and replayed in batch
+    RenderQueue *queue;
+    // layer of the draws to come, back to RENDER_LAYER_HUD on clear
+    RenderLayer layer;
+    Raster *raster;
+    RenderBackend backend;
+    RenderStats stats;
+    // logical size the game is drawn at, whatever the window size is
     int width;
     int height;
+    // integer upscaling, or nearest neighbor scaling to fill the window
+    bool integer_scale;
     char *title;
 } Window;
 
@@ -49,9 +80,11 @@ void cleanup(
  * @param title Window title
  * @param width Window width
  * @param height Window height
+ * @param scale Initial size of the window, in multiples of the logical size
+ * @param backend Render backend
  * @return Window*
  */
-Window *window_create(char *title, int width, int height);
+Window *window_create(char *title, int width, int height, int scale, RenderBackend backend);
 
 /**
  * @brief Destroy the Window object
@@ -66,11 +99,40 @@ void window_destroy(Window *window);
 void window_clear(Window *window);
 
 /**
- * @brief Update the window
+ * @brief Update the window, the stats of the frame are kept in window->stats
  * @param window Window
  */
 void window_update(Window *window);
 
+/**
+ * @brief Switch between fullscreen and windowed mode
+ * @param window Window
+ */
+void window_toggle_fullscreen(Window *window);
+
+/**
+ * @brief Switch between integer upscaling and filling the window
+ * @param window Window
+ */
+void window_toggle_integer_scale(Window *window);
+
+/**
+ * @brief Choose the layer of the next draws
+ *
+ * Draws are recorded and only drawn on window_flush, sorted by layer then
+ * by texture. The layer goes back to RENDER_LAYER_HUD on window_clear.
+ *
+ * @param window Window
+ * @param layer RenderLayer
+ */
+void window_set_layer(Window *window, RenderLayer layer);
+
+/**
+ * @brief Draw the commands recorded so far
+ * @param window Window
+ */
+void window_flush(Window *window);
+
 /**
  * @brief Draw a texture on the window
  * @param window Window
@@ -112,7 +174,25 @@ void window_draw_line(
 );
 
 /**
- * @brief Draw a circle on the window
+ * @brief Draw a line of any thickness on the window
+ * @param window Window
+ * @param x1 X1
+ * @param y1 Y1
+ * @param x2 X2
+ * @param y2 Y2
+ * @param thickness Thickness in pixels
+ * @param color SDL_Color
+ */
+void window_draw_thick_line(
+    Window *window, 
+    int x1, int y1, 
+    int x2, int y2, 
+    int thickness, 
+    SDL_Color color
+);
+
+/**
+ * @brief Draw a filled circle on the window
  * @param window Window
  * @param x X
  * @param y Y
@@ -126,12 +206,56 @@ void window_draw_circle(
     SDL_Color color
 );
 
+/**
+ * @brief Draw the outline of a circle on the window
+ * @param window Window
+ * @param x X
+ * @param y Y
+ * @param radius Radius
+ * @param color SDL_Color
+ */
+void window_draw_circle_outline(
+    Window *window, 
+    int x, int y, 
+    int radius, 
+    SDL_Color color
+);
+
+/**
+ * @brief Draw a filled rectangle with rounded corners on the window
+ * @param window Window
+ * @param rect SDL_Rect
+ * @param radius Corner radius
+ * @param color SDL_Color
+ */
+void window_fill_rounded_rect(
+    Window *window, 
+    SDL_Rect *rect, 
+    int radius, 
+    SDL_Color color
+);
+
+/**
+ * @brief Draw the outline of a rectangle with rounded corners on the window
+ * @param window Window
+ * @param rect SDL_Rect
+ * @param radius Corner radius
+ * @param color SDL_Color
+ */
+void window_draw_rounded_rect(
+    Window *window, 
+    SDL_Rect *rect, 
+    int radius, 
+    SDL_Color color
+);
+
 /**
  * @brief Draw a text on the window
  * @param window Window
  * @param x X
  * @param y Y
  * @param text Text
+ * @param font_size Font size
  * @param color SDL_Color
  * @param align TextAlign
  */
@@ -171,10 +295,10 @@ void window_load_texture(
 );
 
 /**
- * @brief Load a font from a path
+ * @brief Load a font from a path, it becomes the font used to draw text
  * @param window Window
  * @param path Path
- * @param size Font size
+ * @param size Font size to open up front, other sizes open on first use
  */
 void window_load_font(
     Window *window, 
@@ -182,6 +306,19 @@ void window_load_font(
     int size
 );
 
+/**
+ * @brief Measure the width of a text
+ * @param window Window
+ * @param text Text
+ * @param font_size Font size
+ * @return int
+ */
+int window_measure_text(
+    Window *window, 
+    const char *text, 
+    int font_size
+);
+
 /**
  * @brief Rotate texture 
  * @param window Window
@@ -200,19 +337,73 @@ void window_rotate_texture(
 /**
  * @brief Draw a sprite on the window
  * @param window Window
- * @param texture SDL_Texture
- * @param src SDL_Rect
+ * @param sprite Sprite
+ * @param src SDL_Rect relative to the sprite, NULL for the whole sprite
  * @param dst SDL_Rect
  * @param angle Angle to rotate
  * @param flip Flip image verticaly
  */
 void window_draw_sprite(
     Window *window, 
-    SDL_Texture *texture, 
+    Sprite *sprite, 
     SDL_Rect *src, 
     SDL_Rect *dst, 
     double angle, 
     SDL_RendererFlip flip
 );
 
+/**
+ * @brief Pack images decoded by a loader into the sprite atlas of the window
+ * @param window Window
+ * @param loader AssetLoader, its images are taken
+ */
+void window_load_sprite_atlas(
+    Window *window, 
+    AssetLoader *loader
+);
+
+/**
+ * @brief Load a sprite shared with every other user of the same image
+ * @param window Window
+ * @param path Image path
+ * @return Sprite*, to give back with asset_manager_release
+ */
+Sprite *window_load_sprite(
+    Window *window, 
+    const char *path
+);
+
+/**
+ * @brief Copy the frame drawn so far, before window_update presents it
+ *
+ * With RENDER_GPU this is a read back from the GPU, the other backends
+ * copy from memory.
+ *
+ * @param window Window
+ * @param pixels RGBA32 destination
+ * @param pitch Bytes per row of the destination
+ * @return 0 on success, a negative value on error
+ */
+int window_read_pixels(
+    Window *window, 
+    Uint8 *pixels, 
+    int pitch
+);
+
+/**
+ * @brief Pixels of the last frame, for the backends drawing in memory
+ *
+ * The pointer is to the framebuffer itself, no copy is made. It stays
+ * valid until the window is destroyed, and the next window_clear starts
+ * drawing over it.
+ *
+ * @param window Window
+ * @param pitch Bytes per row
+ * @return RGBA32 pixels, NULL with RENDER_GPU
+ */
+const Uint8 *window_get_pixels(
+    Window *window, 
+    int *pitch
+);
+
 # endif
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net_protocol.h"
+
+/**
+ * Decode snapshots as a client gets them off a bad network: cut at every
+ * length, with random bytes changed, and made of random bytes only. A cut
+ * snapshot must be rejected, and any snapshot read must stay within the
+ * tiles and the roles of the game. Exits with a failure on the first one
+ * read wrong.
+ *
+ * Usage: net_protocol_check [-r ROUNDS]
+ *   -r ROUNDS   snapshots corrupted and random snapshots, 100000 by default
+ */
+
+// the tiles of the default level, 28 x 31
+#define CHECK_TILE_COUNT 868
+// past the tiles of the level, a snapshot read must leave it as is
+#define CHECK_SENTINEL 0xa5
+#define CHECK_MAX_CHANGES 4
+
+static uint32_t next_random(uint32_t *state)
+{
+  // xorshift32
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static void check_state_init(NetState *state, Uint32 tick)
+{
+  memset(state, 0, sizeof(NetState));
+  state->tick = tick;
+  state->tile_count = CHECK_TILE_COUNT;
+  for (int i = 0; i < CHECK_TILE_COUNT; i++) state->tiles[i] = 1 + i % 3;
+  memset(state->tiles + CHECK_TILE_COUNT, CHECK_SENTINEL, NET_MAX_TILES - CHECK_TILE_COUNT);
+}
+
+// every field changed from the baseline, the biggest snapshot of a tick
+static void check_state_change(NetState *state, const NetState *baseline)
+{
+  *state = *baseline;
+  state->tick = baseline->tick + 3;
+  state->state = baseline->state + 1;
+  state->is_paused = !baseline->is_paused;
+  state->score = baseline->score + 1250;
+  state->level = baseline->level + 1;
+  state->lives = baseline->lives + 1;
+  for (int i = 0; i < NET_ENTITY_COUNT; i++) {
+    NetEntity *entity = &state->entities[i];
+    entity->x += 3 * i - 7;
+    entity->y += 700 * i - 350;
+    entity->look ^= NET_ENTITY_SCARED | (i % 4);
+  }
+  for (int i = state->tick % 17; i < CHECK_TILE_COUNT; i += 17) state->tiles[i] = 0;
+  state->tiles[CHECK_TILE_COUNT - 1] = 0;
+}
+
+static bool check_states_equal(const NetState *a, const NetState *b)
+{
+  if (
+    a->tick != b->tick ||
+    a->state != b->state ||
+    a->is_paused != b->is_paused ||
+    a->score != b->score ||
+    a->level != b->level ||
+    a->lives != b->lives ||
+    a->tile_count != b->tile_count
+  ) return false;
+  for (int i = 0; i < NET_ENTITY_COUNT; i++) {
+    const NetEntity *x = &a->entities[i], *y = &b->entities[i];
+    if (x->x != y->x || x->y != y->y || x->look != y->look) return false;
+  }
+  return memcmp(a->tiles, b->tiles, NET_MAX_TILES) == 0;
+}
+
+// a snapshot read, valid or not, that wrote past the tiles or took a bad role
+static bool check_read_in_bounds(const NetState *baseline, const Uint8 *data, int size)
+{
+  NetState state;
+  NetRole role;
+  if (!net_snapshot_read(&state, baseline, &role, data, size)) return true;
+
+  if (role > NET_ROLE_SPECTATOR || state.tile_count != baseline->tile_count) return false;
+  for (int i = CHECK_TILE_COUNT; i < NET_MAX_TILES; i++) {
+    if (state.tiles[i] != CHECK_SENTINEL) return false;
+  }
+  return true;
+}
+
+static bool check_round_trip(const NetState *state, const NetState *baseline, Uint8 *data, int *size)
+{
+  *size = net_snapshot_write(state, baseline, NET_ROLE_GHOST, data);
+  if (*size < 0) return false;
+
+  Uint32 tick, baseline_tick;
+  if (!net_snapshot_peek(data, *size, &tick, &baseline_tick)) return false;
+  if (tick != state->tick || baseline_tick != baseline->tick) return false;
+
+  NetState read;
+  NetRole role;
+  return
+    net_snapshot_read(&read, baseline, &role, data, *size) &&
+    role == NET_ROLE_GHOST &&
+    check_states_equal(&read, state);
+}
+
+// every length short of the whole snapshot, and one byte too many
+static bool check_truncated(const NetState *baseline, const Uint8 *data, int size)
+{
+  NetState state;
+  NetRole role;
+  for (int length = 0; length < size; length++) {
+    if (net_snapshot_read(&state, baseline, &role, data, length)) {
+      fprintf(stderr, "[net_protocol_check] Snapshot coupé à %d octets sur %d accepté\n", length, size);
+      return false;
+    }
+  }
+
+  Uint8 longer[NET_PACKET_SIZE];
+  memcpy(longer, data, size);
+  longer[size] = 0;
+  if (net_snapshot_read(&state, baseline, &role, longer, size + 1)) {
+    fprintf(stderr, "[net_protocol_check] Snapshot suivi d'un octet de trop accepté\n");
+    return false;
+  }
+  return true;
+}
+
+static bool check_corrupted(const NetState *baseline, const Uint8 *data, int size, int rounds, uint32_t *random)
+{
+  Uint8 corrupted[NET_PACKET_SIZE];
+  for (int round = 0; round < rounds; round++) {
+    memcpy(corrupted, data, size);
+    int changes = 1 + next_random(random) % CHECK_MAX_CHANGES;
+    for (int i = 0; i < changes; i++) corrupted[next_random(random) % size] ^= 1 + next_random(random) % 255;
+    // cut as well, one time in four
+    int length = next_random(random) % 4 == 0 ? (int) (next_random(random) % size) : size;
+
+    if (!check_read_in_bounds(baseline, corrupted, length)) {
+      fprintf(stderr, "[net_protocol_check] Snapshot corrompu lu hors des limites, tour %d\n", round);
+      return false;
+    }
+  }
+  return true;
+}
+
+// random bytes behind a valid header, for the paths a corrupted byte rarely reaches
+static bool check_random(const NetState *baseline, int rounds, uint32_t *random)
+{
+  Uint8 data[NET_PACKET_SIZE];
+  for (int round = 0; round < rounds; round++) {
+    int size = 1 + next_random(random) % 64;
+    for (int i = 0; i < size; i++) data[i] = next_random(random);
+    data[0] = NET_MESSAGE_SNAPSHOT;
+
+    if (!check_read_in_bounds(baseline, data, size)) {
+      fprintf(stderr, "[net_protocol_check] Snapshot aléatoire lu hors des limites, tour %d\n", round);
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int rounds = 100000;
+
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "-r") == 0) rounds = atoi(argv[++i]);
+  }
+  if (rounds < 1) {
+    fprintf(stderr, "Usage : net_protocol_check [-r ROUNDS]\n");
+    return EXIT_FAILURE;
+  }
+
+  NetState initial, baseline, state, unchanged;
+  check_state_init(&initial, 0);
+  check_state_change(&baseline, &initial);
+  check_state_change(&state, &baseline);
+  state.score = -state.score;
+  unchanged = state;
+  unchanged.tick--;
+
+  // from the initial state, from a recent baseline, and from the same state
+  const NetState *baselines[] = { &initial, &baseline, &unchanged };
+  uint32_t random = 1;
+  int checked = 0;
+
+  for (int i = 0; i < 3; i++) {
+    Uint8 data[NET_PACKET_SIZE];
+    int size;
+    if (!check_round_trip(&state, baselines[i], data, &size)) {
+      fprintf(stderr, "[net_protocol_check] Erreur lors de la relecture du snapshot %d\n", i);
+      return EXIT_FAILURE;
+    }
+    if (!check_truncated(baselines[i], data, size)) return EXIT_FAILURE;
+    if (!check_corrupted(baselines[i], data, size, rounds, &random)) return EXIT_FAILURE;
+    checked += size + 1 + rounds;
+  }
+  if (!check_random(&initial, rounds, &random)) return EXIT_FAILURE;
+  checked += rounds;
+
+  printf("%d snapshots decoded, none read wrong\n", checked);
+  return EXIT_SUCCESS;
+}
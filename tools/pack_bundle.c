@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "bundle.h"
+
+/**
+ * Pack the assets of the game in one file that the game maps in memory,
+ * images are decoded here once instead of at every launch
+ *
+ * Usage: pack_bundle OUTPUT FILE...
+ * with the files given relative to the root of the repository
+ */
+
+static bool is_image(const char *path)
+{
+  size_t length = strlen(path);
+  return length > 4 && strcmp(path + length - 4, ".png") == 0;
+}
+
+// bytes of the entry in the bundle, NULL on error
+static void *pack_entry(const char *path, BundleEntry *entry)
+{
+  memset(entry, 0, sizeof(BundleEntry));
+  if (strlen(path) >= BUNDLE_NAME_MAX) {
+    fprintf(stderr, "[pack_entry] Chemin trop long : %s\n", path);
+    return NULL;
+  }
+  strcpy(entry->name, path);
+
+  if (!is_image(path)) {
+    size_t size;
+    void *data = SDL_LoadFile(path, &size);
+    if (data == NULL) {
+      fprintf(stderr, "[pack_entry] Erreur lors de la lecture de %s : %s\n", path, SDL_GetError());
+      return NULL;
+    }
+    entry->type = BUNDLE_RAW;
+    entry->size = size;
+    return data;
+  }
+
+  SDL_Surface *image = IMG_Load(path);
+  SDL_Surface *rgba = image != NULL ? SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0) : NULL;
+  SDL_FreeSurface(image);
+  if (rgba == NULL) {
+    fprintf(stderr, "[pack_entry] Erreur lors du décodage de %s : %s\n", path, IMG_GetError());
+    return NULL;
+  }
+
+  entry->type = BUNDLE_RGBA;
+  entry->width = rgba->w;
+  entry->height = rgba->h;
+  entry->size = rgba->w * rgba->h * 4;
+
+  // rows without padding, whatever the pitch of the surface
+  Uint8 *pixels = malloc(entry->size);
+  if (pixels == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    SDL_FreeSurface(rgba);
+    return NULL;
+  }
+  for (int y = 0; y < rgba->h; y++) {
+    memcpy(pixels + y * rgba->w * 4, (Uint8 *) rgba->pixels + y * rgba->pitch, rgba->w * 4);
+  }
+  SDL_FreeSurface(rgba);
+
+  return pixels;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3) {
+    fprintf(stderr, "Usage : %s OUTPUT FILE...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+    fprintf(stderr, "Erreur d'initialisation de SDL_image : %s\n", IMG_GetError());
+    return EXIT_FAILURE;
+  }
+
+  int count = argc - 2;
+  BundleHeader header = { BUNDLE_MAGIC, count, 0 };
+  BundleEntry *entries = calloc(count, sizeof(BundleEntry));
+  void **data = calloc(count, sizeof(void *));
+  if (entries == NULL || data == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return EXIT_FAILURE;
+  }
+
+  Uint64 offset = sizeof(BundleHeader) + count * sizeof(BundleEntry);
+  for (int i = 0; i < count; i++) {
+    data[i] = pack_entry(argv[i + 2], &entries[i]);
+    if (data[i] == NULL) return EXIT_FAILURE;
+
+    offset = (offset + BUNDLE_ALIGN - 1) / BUNDLE_ALIGN * BUNDLE_ALIGN;
+    entries[i].offset = offset;
+    offset += entries[i].size;
+  }
+
+  FILE *output = fopen(argv[1], "wb");
+  if (output == NULL) {
+    fprintf(stderr, "Erreur d'ouverture du fichier %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  static const Uint8 padding[BUNDLE_ALIGN] = { 0 };
+  fwrite(&header, sizeof(header), 1, output);
+  fwrite(entries, sizeof(BundleEntry), count, output);
+  for (int i = 0; i < count; i++) {
+    long position = ftell(output);
+    fwrite(padding, 1, entries[i].offset - position, output);
+    fwrite(data[i], 1, entries[i].size, output);
+    printf("%-40s %s %u bytes\n", entries[i].name, entries[i].type == BUNDLE_RGBA ? "rgba" : "raw ", entries[i].size);
+  }
+
+  if (fclose(output) != 0) {
+    fprintf(stderr, "Erreur lors de l'écriture du fichier %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  printf("%d files packed in %s, %llu bytes\n", count, argv[1], (unsigned long long) offset);
+
+  for (int i = 0; i < count; i++) {
+    if (entries[i].type == BUNDLE_RAW) SDL_free(data[i]);
+    else free(data[i]);
+  }
+  free(entries);
+  free(data);
+  IMG_Quit();
+
+  return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pacman.h"
+
+/**
+ * Step a batch of games through libpacman with random actions, as a
+ * training program would, and print the game steps per second. Links
+ * against libpacman alone, run from the directory of the game.
+ *
+ * Usage: pacman_bench [-n GAMES] [-s STEPS] [-r SEED]
+ *   -n GAMES   games in the batch, 64 by default
+ *   -s STEPS   steps of the whole batch, 10000 by default
+ *   -r SEED    seed of the games and of the actions, 1 by default
+ */
+
+// actions are held that many steps, as a player would
+#define ACTION_STEPS 8
+
+static double now(void)
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static uint32_t next_random(uint32_t *state)
+{
+  // xorshift32
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+int main(int argc, char *argv[])
+{
+  int count = 64;
+  int steps = 10000;
+  uint32_t seed = 1;
+
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0) count = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-s") == 0) steps = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-r") == 0) seed = strtoul(argv[++i], NULL, 10);
+  }
+  if (count < 1 || steps < 1) {
+    fprintf(stderr, "Usage : pacman_bench [-n GAMES] [-s STEPS] [-r SEED]\n");
+    return EXIT_FAILURE;
+  }
+
+  // everything the loop touches is allocated here, once
+  PacmanObservation *observations = malloc(sizeof(PacmanObservation) * count);
+  uint8_t *actions = malloc(count);
+  float *rewards = malloc(sizeof(float) * count);
+  uint8_t *dones = malloc(count);
+  if (observations == NULL || actions == NULL || rewards == NULL || dones == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return EXIT_FAILURE;
+  }
+
+  Pacman *pacman = pacman_create(count, observations);
+  if (pacman == NULL) return EXIT_FAILURE;
+  pacman_reset(pacman, seed);
+
+  uint32_t random = seed != 0 ? seed : 1;
+  double points = 0;
+  int episodes = 0;
+
+  double start = now();
+  for (int step = 0; step < steps; step++) {
+    if (step % ACTION_STEPS == 0) {
+      for (int i = 0; i < count; i++) actions[i] = 1 + next_random(&random) % (PACMAN_ACTION_COUNT - 1);
+    }
+
+    pacman_step(pacman, actions, rewards, dones);
+
+    for (int i = 0; i < count; i++) {
+      points += rewards[i];
+      episodes += dones[i];
+    }
+  }
+  double seconds = now() - start;
+
+  double game_steps = (double) count * steps;
+  printf(
+    "%d games, %d steps: %.2f s, %.0f game steps/s, %.2f us per game step\n",
+    count,
+    steps,
+    seconds,
+    game_steps / seconds,
+    seconds * 1e6 / game_steps
+  );
+  printf(
+    "%d episodes ended, %.2f points per game step, first game at tick %u with %d points\n",
+    episodes,
+    points / game_steps,
+    observations[0].tick,
+    observations[0].score
+  );
+
+  pacman_destroy(pacman);
+  free(observations);
+  free(actions);
+  free(rewards);
+  free(dones);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,304 @@
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pacman_ipc.h"
+
+/**
+ * Serve a batch of games from a child process and step it from the parent,
+ * through the shared memory of pacman_ipc.h then through a pair of pipes
+ * carrying the same bytes, and print the round trip latency of a step and
+ * the throughput of both. Run from the directory of the game.
+ *
+ * Usage: pacman_ipc_bench [-n GAMES] [-s STEPS]
+ *   -n GAMES   games in the batch, 1 by default
+ *   -s STEPS   steps of the whole batch per measure, 20000 by default
+ */
+
+// actions are held that many steps, as a player would
+#define ACTION_STEPS 8
+// a few steps are not measured, while both sides get scheduled
+#define WARMUP_STEPS 1000
+#define ATTACH_TRIES 500
+
+typedef struct {
+  double mean, p50, p99;
+  double steps_per_second;
+} Measure;
+
+static double now(void)
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static uint32_t next_random(uint32_t *state)
+{
+  // xorshift32
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static void random_actions(uint8_t *actions, int count, int step, uint32_t *random)
+{
+  if (step % ACTION_STEPS != 0) return;
+  for (int i = 0; i < count; i++) actions[i] = 1 + next_random(random) % (PACMAN_ACTION_COUNT - 1);
+}
+
+static int compare_double(const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+static void measure_latencies(Measure *measure, double *latencies, int steps, double seconds)
+{
+  double total = 0;
+  for (int i = 0; i < steps; i++) total += latencies[i];
+  qsort(latencies, steps, sizeof(double), compare_double);
+  measure->mean = total / steps;
+  measure->p50 = latencies[steps / 2];
+  measure->p99 = latencies[steps * 99 / 100];
+  measure->steps_per_second = steps / seconds;
+}
+
+static bool read_all(int fd, void *buffer, size_t size)
+{
+  uint8_t *bytes = buffer;
+  while (size > 0) {
+    ssize_t n = read(fd, bytes, size);
+    if (n <= 0) return false;
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+static bool write_all(int fd, const void *buffer, size_t size)
+{
+  const uint8_t *bytes = buffer;
+  while (size > 0) {
+    ssize_t n = write(fd, bytes, size);
+    if (n <= 0) return false;
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+static bool print_measure(const char *name, Measure *measure, int count)
+{
+  printf("%-14s", name);
+  // no round trip to time with several requests in flight
+  if (measure->mean > 0) {
+    printf(
+      " %8.2f us mean, %8.2f us p50, %8.2f us p99,",
+      measure->mean * 1e6,
+      measure->p50 * 1e6,
+      measure->p99 * 1e6
+    );
+  } else {
+    printf(" %47s", "");
+  }
+  printf(" %9.0f steps/s, %10.0f game steps/s\n", measure->steps_per_second, measure->steps_per_second * count);
+  return true;
+}
+
+// one request in flight, the agent waits for each step before the next
+static bool bench_shm_lockstep(PacmanIpc *ipc, int steps, double *latencies, Measure *measure)
+{
+  int count = pacman_ipc_count(ipc);
+  uint32_t random = 1;
+
+  pacman_ipc_wait(ipc, pacman_ipc_submit(ipc, PACMAN_IPC_RESET, 1));
+  double start = 0;
+  for (int step = -WARMUP_STEPS; step < steps; step++) {
+    if (step == 0) start = now();
+    double sent = now();
+
+    uint8_t *actions = pacman_ipc_actions(ipc);
+    if (actions == NULL) return false;
+    random_actions(actions, count, step, &random);
+    if (!pacman_ipc_wait(ipc, pacman_ipc_submit(ipc, PACMAN_IPC_STEP, 0))) return false;
+
+    if (step >= 0) latencies[step] = now() - sent;
+  }
+  measure_latencies(measure, latencies, steps, now() - start);
+  return true;
+}
+
+// every slot in flight, the agent only waits for the oldest one
+static bool bench_shm_pipelined(PacmanIpc *ipc, int steps, Measure *measure)
+{
+  int count = pacman_ipc_count(ipc);
+  uint32_t random = 1;
+  uint32_t sequence = 0;
+
+  pacman_ipc_wait(ipc, pacman_ipc_submit(ipc, PACMAN_IPC_RESET, 1));
+  double start = now();
+  for (int step = 0; step < steps; step++) {
+    uint8_t *actions = pacman_ipc_actions(ipc);
+    if (actions == NULL) return false;
+    random_actions(actions, count, step, &random);
+    sequence = pacman_ipc_submit(ipc, PACMAN_IPC_STEP, 0);
+  }
+  if (!pacman_ipc_wait(ipc, sequence)) return false;
+
+  memset(measure, 0, sizeof(Measure));
+  measure->steps_per_second = steps / (now() - start);
+  return true;
+}
+
+static void serve_pipe(int requests, int replies, int count)
+{
+  PacmanObservation *observations = malloc(sizeof(PacmanObservation) * count);
+  uint8_t *actions = malloc(count);
+  float *rewards = malloc(sizeof(float) * count);
+  uint8_t *dones = malloc(count);
+  Pacman *pacman = observations != NULL ? pacman_create(count, observations) : NULL;
+  if (pacman == NULL || actions == NULL || rewards == NULL || dones == NULL) exit(EXIT_FAILURE);
+
+  PacmanIpcRequest request;
+  while (read_all(requests, &request, sizeof(request)) && request.command != PACMAN_IPC_CLOSE) {
+    if (request.command == PACMAN_IPC_RESET) {
+      pacman_reset(pacman, request.seed);
+    } else {
+      if (!read_all(requests, actions, count)) break;
+      pacman_step(pacman, actions, rewards, dones);
+    }
+    // the same bytes as the shared memory, all the observations on every step
+    if (!write_all(replies, rewards, sizeof(float) * count)) break;
+    if (!write_all(replies, dones, count)) break;
+    if (!write_all(replies, observations, sizeof(PacmanObservation) * count)) break;
+  }
+
+  pacman_destroy(pacman);
+  exit(EXIT_SUCCESS);
+}
+
+// the baseline, a request and the actions down a pipe, the replies up another
+static bool bench_pipe(int count, int steps, double *latencies, Measure *measure)
+{
+  int requests[2], replies[2];
+  if (pipe(requests) < 0 || pipe(replies) < 0) return false;
+
+  // or the child prints it again on exit
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    close(requests[1]);
+    close(replies[0]);
+    serve_pipe(requests[0], replies[1], count);
+  }
+  close(requests[0]);
+  close(replies[1]);
+
+  uint8_t *actions = malloc(count);
+  size_t reply_size = (sizeof(float) + 1 + sizeof(PacmanObservation)) * count;
+  uint8_t *reply = malloc(reply_size);
+  if (actions == NULL || reply == NULL) return false;
+
+  uint32_t random = 1;
+  PacmanIpcRequest request = { PACMAN_IPC_RESET, 1 };
+  bool is_ok = write_all(requests[1], &request, sizeof(request)) && read_all(replies[0], reply, reply_size);
+
+  double start = 0;
+  request.command = PACMAN_IPC_STEP;
+  for (int step = -WARMUP_STEPS; is_ok && step < steps; step++) {
+    if (step == 0) start = now();
+    double sent = now();
+
+    random_actions(actions, count, step, &random);
+    is_ok =
+      write_all(requests[1], &request, sizeof(request)) &&
+      write_all(requests[1], actions, count) &&
+      read_all(replies[0], reply, reply_size);
+
+    if (step >= 0) latencies[step] = now() - sent;
+  }
+  if (is_ok) measure_latencies(measure, latencies, steps, now() - start);
+
+  request.command = PACMAN_IPC_CLOSE;
+  write_all(requests[1], &request, sizeof(request));
+  close(requests[1]);
+  close(replies[0]);
+  waitpid(pid, NULL, 0);
+  free(actions);
+  free(reply);
+  return is_ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int count = 1;
+  int steps = 20000;
+
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0) count = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-s") == 0) steps = atoi(argv[++i]);
+  }
+  if (count < 1 || steps < 1) {
+    fprintf(stderr, "Usage : pacman_ipc_bench [-n GAMES] [-s STEPS]\n");
+    return EXIT_FAILURE;
+  }
+
+  double *latencies = malloc(sizeof(double) * steps);
+  if (latencies == NULL) {
+    fprintf(stderr, "Erreur d'allocation mémoire\n");
+    return EXIT_FAILURE;
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "%s-%d", PACMAN_IPC_NAME, (int) getpid());
+
+  pid_t server = fork();
+  if (server < 0) return EXIT_FAILURE;
+  if (server == 0) {
+    PacmanIpc *ipc = pacman_ipc_create(name, count);
+    bool is_closed = ipc != NULL && pacman_ipc_serve(ipc);
+    pacman_ipc_destroy(ipc);
+    exit(is_closed ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  // until the server has loaded the games
+  PacmanIpc *ipc = NULL;
+  for (int i = 0; i < ATTACH_TRIES && ipc == NULL; i++) {
+    ipc = pacman_ipc_attach(name);
+    if (ipc == NULL) usleep(10000);
+  }
+  if (ipc == NULL) {
+    fprintf(stderr, "[pacman_ipc_bench] Erreur lors de la connexion à %s\n", name);
+    kill(server, SIGKILL);
+    waitpid(server, NULL, 0);
+    return EXIT_FAILURE;
+  }
+
+  printf("%d games, %d steps, %ld cores\n", count, steps, sysconf(_SC_NPROCESSORS_ONLN));
+
+  Measure measure;
+  bool is_ok = bench_shm_lockstep(ipc, steps, latencies, &measure) && print_measure("shm", &measure, count);
+  is_ok = is_ok && bench_shm_pipelined(ipc, steps, &measure) && print_measure("shm pipelined", &measure, count);
+
+  pacman_ipc_wait(ipc, pacman_ipc_submit(ipc, PACMAN_IPC_CLOSE, 0));
+  int status = 0;
+  waitpid(server, &status, 0);
+  pacman_ipc_destroy(ipc);
+
+  is_ok = is_ok && bench_pipe(count, steps, latencies, &measure) && print_measure("pipe", &measure, count);
+
+  free(latencies);
+  if (!is_ok) {
+    fprintf(stderr, "[pacman_ipc_bench] Erreur lors de la mesure\n");
+    return EXIT_FAILURE;
+  }
+  return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,107 @@
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <SDL2/SDL.h>
+
+#include "counters.h"
+#include "metrics.h"
+
+/**
+ * Print the live metrics of a running game, read from its shared memory
+ * segment. The game never waits for this process.
+ *
+ * Usage: pacman_monitor [-f] [-i MS] [NAME]
+ *   -f      stream one line per interval instead of printing once
+ *   -i MS   interval of -f, 1000 by default
+ *   NAME    name of the segment, METRICS_NAME by default
+ */
+
+static void print_snapshot(const MetricsSnapshot *snapshot)
+{
+  printf("frame        %llu\n", (unsigned long long) snapshot->frame);
+  printf("time         %u ms\n", snapshot->time_ms);
+  printf("state        %s\n", metrics_state_name(snapshot->state));
+  printf("score        %d\n", snapshot->score);
+  printf("level        %d\n", snapshot->level);
+  printf("lives        %d\n", snapshot->lives);
+  printf("fps          %d\n", snapshot->fps);
+  printf("tick rate    %.1f /s\n", snapshot->tick_rate);
+  printf("frame time   %.2f ms\n", snapshot->frame_time_ms);
+
+  printf("frame times\n");
+  for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+    if (i < METRICS_HISTOGRAM_BUCKETS - 1) printf("  < %4d ms   %u\n", 1 << i, snapshot->frame_times[i]);
+    else printf("  >= %3d ms   %u\n", 1 << (i - 1), snapshot->frame_times[i]);
+  }
+
+  printf("counters     last frame / total\n");
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    printf(
+      "  %-20s %u / %llu\n",
+      counter_name(i),
+      snapshot->counters[i],
+      (unsigned long long) snapshot->counter_totals[i]
+    );
+  }
+}
+
+static void print_line(const MetricsSnapshot *snapshot)
+{
+  printf(
+    "frame %llu  %s  score %d  level %d  fps %d  ticks %.1f/s  frame %.2f ms",
+    (unsigned long long) snapshot->frame,
+    metrics_state_name(snapshot->state),
+    snapshot->score,
+    snapshot->level,
+    snapshot->fps,
+    snapshot->tick_rate,
+    snapshot->frame_time_ms
+  );
+  for (int i = 0; i < COUNTER_COUNT; i++) printf("  %s %u", counter_name(i), snapshot->counters[i]);
+  printf("\n");
+  fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+  bool is_streaming = false;
+  int interval = 1000;
+  const char *name = METRICS_NAME;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-f") == 0) is_streaming = true;
+    else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) interval = atoi(argv[++i]);
+    else name = argv[i];
+  }
+
+  Metrics *metrics = metrics_attach(name);
+  if (metrics == NULL) {
+    fprintf(stderr, "Aucune partie ne publie sous %s\n", name);
+    return EXIT_FAILURE;
+  }
+
+  MetricsSnapshot snapshot;
+  do {
+    // the segment stays mapped here once the game is gone, its values frozen
+    if (kill(metrics->segment->pid, 0) < 0 && errno == ESRCH) {
+      fprintf(stderr, "La partie %u est terminée\n", metrics->segment->pid);
+      break;
+    }
+    // the game is writing right now every time, it gets another chance next interval
+    if (!metrics_read(metrics, &snapshot)) {
+      fprintf(stderr, "Lecture de %s impossible, nouvel essai\n", name);
+    } else if (is_streaming) {
+      print_line(&snapshot);
+    } else {
+      printf("pid          %u\n", metrics->segment->pid);
+      print_snapshot(&snapshot);
+    }
+    if (is_streaming) usleep(interval * 1000);
+  } while (is_streaming);
+
+  metrics_destroy(metrics);
+  return EXIT_SUCCESS;
+}
\ No newline at end of file